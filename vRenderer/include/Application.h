@@ -8,6 +8,7 @@
 #include <list>
 
 #include "RenderSettings.h"
+#include "ImportSettings.h"
 #include "OpenGLRenderer.h"
 #include "VulkanRenderer.h"
 
@@ -19,9 +20,12 @@
 
 #include "AssetImporter.h"
 #include "AssimpModelImporter.h"
-#include "StbImageImporter.h"
+#include "ImageImporter.h"
 
 #include "SceneGraph.h"
+#include "SceneBvh.h"
+#include "SceneFile.h"
+#include "SceneGenerator.h"
 
 #include "SceneGraphWindow.h"
 #include "AssetBrowser.h"
@@ -41,13 +45,16 @@ class Application
 public:
 	Application() = default;
 
-	int run();
+	int run(int argc, char* argv[]);
 
 private:
 
 	GLFWwindow* window;
 	IRenderer* renderer;
 	std::shared_ptr<RenderSettings> renderSettings;
+	std::unique_ptr<ImportSettings> importSettings;
+	// Thread layout as stored in prefs, command line overrides are applied only for the current run
+	ThreadTopology threadTopology;
 	AppContext* context;
 	std::unique_ptr<ThreadDispatcher> threadDispatcher;
 
@@ -67,14 +74,27 @@ private:
 
 	std::unique_ptr<AssetImporter> assetImporter;
 	std::unique_ptr<SceneGraph> sceneGraph;
+	// Reused between frames to avoid allocating on every transform update
+	std::vector<InstanceHandle> updatedInstances;
+	// Instance bounds for viewport picking, rebuilt on the next transform sync after instances are added or deleted
+	std::unique_ptr<SceneBvh> sceneBvh;
+	bool sceneBvhStale = true;
 
 	std::unique_ptr<AssetBrowser> assetBrowser;
 	std::unique_ptr<SceneGraphWindow> sceneGraphWindow;
 
 	std::shared_ptr<Cubemap> skyboxCubemap;
+	std::string skyboxName;
+
+	// Loaded scene is instanced in batches of this size, main thread budget decides how many of them fit into a frame
+	static constexpr size_t c_sceneInstancesPerBatch = 2048;
+	char scenePath[256] = SCENE_FILE;
+	// Scene save, load or generation is in flight, only one is allowed at a time
+	bool sceneIoPending = false;
+	SceneGenerator::Settings sceneGeneratorSettings;
 
 	void initWindow(std::string title, const int width, const int height);
-	int initApplication();
+	int initApplication(const ThreadTopology& topology);
 	void loadUserPrefs();
 	void saveUserPrefs();
 	void processInput();
@@ -85,17 +105,29 @@ private:
 	void imguiMenu();
 
 	void createModelInstance();
-	void cloneSceneInstance(uint32_t instanceId);
-	void deleteSceneInstance(uint32_t instanceId);
-	void hideSceneInstance(uint32_t instanceId);
+	void cloneSceneInstance(InstanceHandle instance);
+	void deleteSceneInstance(InstanceHandle instance);
+	void hideSceneInstance(InstanceHandle instance);
 
 	void onCameraTypeChanged(CameraType cameraType);
 	void onCameraSettingsChanged();
 	void onLightSettingsChanged(imgui_helper::LightTabAction action, uint32_t lightId);
 	void onAssetBrowserAction(AssetBrowserOp action, std::string modelName);
-	void onSceneGraphAction(SceneGraphOp action, uint32_t instanceId);
-	void onInstanceTransformChanged(uint32_t id);
-	void addModelToRenderer(std::string modelName);
+	void onSceneGraphAction(SceneGraphOp action, InstanceHandle instance);
+	void onInstanceTransformChanged(InstanceHandle instance);
+	// Recomputes changed world matrices and refits instance bounds
+	void syncSceneTransforms();
+	// Selects the closest instance under a viewport point, normalized to 0..1
+	void pickSceneInstance(glm::vec2 viewportPoint);
+	AsyncTask<void> addModelToRenderer(std::string modelName);
+	AsyncTask<void> loadSkybox(std::string cubemapName);
+
+	// Removes all instances and light sources from the scene and the renderer
+	void clearScene();
+	AsyncTask<void> saveScene(std::string scenePath);
+	AsyncTask<void> loadScene(std::string scenePath);
+	AsyncTask<void> generateScene(SceneGenerator::Settings settings);
+	AsyncTask<void> replaceScene(SceneData scene);
 
 
 	void setSceneCamera(CameraType cameraType);
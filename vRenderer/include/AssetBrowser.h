@@ -63,13 +63,8 @@ namespace VRD::OVERL
 			modelNames.data();
 		}
 
-	private:
-
-		std::vector<std::string> modelNames = {};
-		std::string selectedModelName = {};
-		uint32_t selectedModelIndex = -1;
-
-		void ScanForModels(const std::string& directory, const std::vector<const char*>& extensions, std::vector<std::string>& outModelNames)
+		// Names of model folders in directory that contain a file with one of the extensions
+		static void ScanForModels(const std::string& directory, const std::vector<const char*>& extensions, std::vector<std::string>& outModelNames)
 		{
 			namespace fs = std::filesystem;
 
@@ -101,5 +96,11 @@ namespace VRD::OVERL
 				}
 			}
 		}
+
+	private:
+
+		std::vector<std::string> modelNames = {};
+		std::string selectedModelName = {};
+		uint32_t selectedModelIndex = -1;
 	};
 }
\ No newline at end of file
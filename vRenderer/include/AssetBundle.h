@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <filesystem>
+#include <unordered_map>
+
+#include "MappedFile.h"
+#include "BinaryStream.h"
+#include "Model.h"
+#include "Texture.h"
+
+/*
+	Single-file container of pre-processed assets.
+
+	Layout:
+	[Header][chunk 0][chunk 1]...[chunk N-1][Table of contents]
+
+	Each chunk holds one asset (model, texture or cubemap) in a ready-to-use form, i.e. meshes are already
+	triangulated and textures are decoded to RGBA8, and may be compressed on its own.
+	Model chunks reference their textures by content hash, so textures shared between models are stored once.
+	The file is memory mapped, so only chunks that are actually requested are read from disk.
+*/
+
+class AssetBundle
+{
+public:
+
+	static constexpr char MAGIC[4] = { 'V', 'R', 'D', 'B' };
+	static constexpr uint32_t VERSION = 1;
+
+	enum class EntryType : uint32_t
+	{
+		MODEL,
+		TEXTURE,
+		CUBEMAP
+	};
+
+	enum class Compression : uint32_t
+	{
+		NONE,
+		LZ4,
+		ZSTD		// requires VRD_WITH_ZSTD
+	};
+
+	struct Header
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t reserved;
+		uint64_t tocOffset;
+		uint64_t tocSize;
+	};
+
+	struct Entry
+	{
+		EntryType type;
+		Compression compression;
+		uint64_t offset;			// chunk offset from the beginning of the file
+		uint64_t storedSize;		// chunk size in file
+		uint64_t size;				// chunk size after decompression
+		std::string name;
+	};
+
+	AssetBundle(const std::filesystem::path& bundlePath);
+
+	bool contains(EntryType type, const std::string& name) const;
+
+	std::shared_ptr<Model> loadModel(const std::string& modelName);
+	std::shared_ptr<Cubemap> loadCubemap(const std::string& cubemapName);
+
+	static std::string getEntryKey(EntryType type, const std::string& name);
+
+	// Shared chunk compression used by both the bundle builder and the reader.
+	static std::vector<uint8_t> compressChunk(const std::vector<uint8_t>& data, Compression& inOutCompression);
+	static std::vector<uint8_t> decompressChunk(const uint8_t* data, const Entry& entry);
+	// Largest size storedSize bytes can decompress to, used to reject corrupted sizes before allocating
+	static uint64_t getMaxDecompressedSize(Compression compression, uint64_t storedSize);
+
+private:
+
+	std::unique_ptr<MappedFile> file;
+	std::unordered_map<std::string, Entry> entries;
+
+	// Already loaded assets. Every asset is created once and then shared, same as with loose file importers.
+	std::unordered_map<std::string, std::shared_ptr<Model>> loadedModels;
+	std::unordered_map<std::string, std::shared_ptr<Texture>> loadedTextures;
+	std::unordered_map<std::string, std::shared_ptr<Cubemap>> loadedCubemaps;
+	std::unordered_map<uint64_t, std::shared_ptr<Mesh>> loadedMeshes;
+	std::mutex cacheMutex;
+
+	// Texture chunks are named by content hash, so they are only reachable through model chunks
+	std::shared_ptr<Texture> loadTexture(const std::string& textureName);
+
+	const Entry& getEntry(EntryType type, const std::string& name) const;
+	std::vector<uint8_t> readChunk(const Entry& entry) const;
+
+	static void readTexture(BinaryReader& reader, Texture& outTexture);
+};
\ No newline at end of file
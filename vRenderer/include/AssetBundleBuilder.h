@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <filesystem>
+#include <unordered_set>
+
+#include "AssetBundle.h"
+#include "BinaryStream.h"
+
+/*
+	Produces asset bundles (see AssetBundle) out of imported assets.
+	Run the application with "--build-bundle [output path] [--compression none|lz4|zstd]"
+	to pack everything from the assets folder into a single bundle.
+*/
+
+class AssetBundleBuilder
+{
+public:
+
+	AssetBundleBuilder(AssetBundle::Compression compression);
+
+	void addModel(const std::string& modelName, const Model& model);
+	void addCubemap(const std::string& cubemapName, const Cubemap& cubemap);
+
+	void write(const std::filesystem::path& bundlePath);
+
+	static int runFromCommandLine(int argc, char* argv[]);
+
+private:
+
+	struct Chunk
+	{
+		AssetBundle::Entry entry;
+		std::vector<uint8_t> data;
+	};
+
+	AssetBundle::Compression compression;
+	std::vector<Chunk> chunks;
+
+	// Content hashes of textures that are already added. Textures are stored once no matter how many materials use them.
+	std::unordered_set<uint64_t> addedTextures;
+
+	std::string addTexture(const Texture& texture);
+	void addChunk(AssetBundle::EntryType type, const std::string& name, std::vector<uint8_t>&& data);
+
+	static void writeTexture(BinaryWriter& writer, const Texture& texture);
+};
\ No newline at end of file
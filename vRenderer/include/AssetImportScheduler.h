@@ -0,0 +1,103 @@
+#pragma once
+
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <functional>
+#include <unordered_map>
+
+#include "ThreadDispatcher.h"
+
+enum class ImportPriority : uint8_t
+{
+	VISIBLE = 0,		// content that is needed right now
+	PREFETCH = 1,		// content likely to be needed soon
+	BACKGROUND = 2		// everything else
+};
+
+/// <summary>
+/// Shared cancellation flag. Copies of a token refer to the same flag,
+/// so the requester may keep one copy and cancel work that holds another.
+/// </summary>
+class CancellationToken
+{
+public:
+
+	CancellationToken() : cancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+	void cancel() { cancelled->store(true, std::memory_order_relaxed); }
+	bool isCancelled() const { return cancelled->load(std::memory_order_relaxed); }
+
+private:
+
+	std::shared_ptr<std::atomic<bool>> cancelled;
+};
+
+using ImportRequestId = uint64_t;
+
+/// <summary>
+/// Orders import work by priority before it reaches worker threads.
+/// Requests wait in the scheduler's own queue, and worker only picks the most important one at the moment it becomes free.
+/// This way queued requests can be re-prioritized or cancelled up until they start.
+/// Requests of equal priority are served in FIFO order.
+/// </summary>
+class AssetImportScheduler
+{
+public:
+
+	using Work = std::function<void(const CancellationToken&)>;
+	// Marks a request started with scheduleDeferred() as finished. May be called from any thread.
+	using Completion = std::function<void()>;
+	using DeferredWork = std::function<void(const CancellationToken&, Completion)>;
+
+	// Calls the completion it holds when destroyed, so deferred work finishes its request on any exit path
+	class Slot
+	{
+	public:
+		Slot() = default;
+		explicit Slot(Completion complete) : complete(std::move(complete)) {}
+		Slot(Slot&& other) noexcept : complete(std::exchange(other.complete, nullptr)) {}
+		Slot(const Slot&) = delete;
+		Slot& operator=(const Slot&) = delete;
+		Slot& operator=(Slot&&) = delete;
+		~Slot() { if (complete) complete(); }
+
+	private:
+		Completion complete;
+	};
+
+	// onDropped is called instead of work if request gets cancelled before it starts
+	ImportRequestId schedule(ImportPriority priority, CancellationToken token, Work work, std::function<void()> onDropped = nullptr);
+	// Request keeps running after work returns, until work's continuation calls the completion,
+	// so work can hand the rest over to other tasks instead of blocking its worker
+	ImportRequestId scheduleDeferred(ImportPriority priority, CancellationToken token, DeferredWork work, std::function<void()> onDropped = nullptr);
+
+	bool setPriority(ImportRequestId requestId, ImportPriority priority);
+	bool cancel(ImportRequestId requestId);
+
+	size_t getQueuedCount() const;
+
+private:
+
+	struct Request
+	{
+		ImportPriority priority;
+		CancellationToken token;
+		DeferredWork work;
+		std::function<void()> onDropped;
+		bool started = false;
+	};
+
+	mutable std::mutex mutex;
+	std::atomic<ImportRequestId> nextRequestId = 0;
+
+	// Queued request ids ordered by (priority, id), which gives FIFO order within a priority class
+	std::set<std::pair<ImportPriority, ImportRequestId>> queue;
+	// Both queued and running requests
+	std::unordered_map<ImportRequestId, Request> requests;
+
+	void runNext();
+	void complete(ImportRequestId requestId);
+};
\ No newline at end of file
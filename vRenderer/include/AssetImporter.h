@@ -7,43 +7,123 @@
 #include "IModelAssetImporter.h"
 #include "IImageAssetImporter.h"
 #include "ThreadDispatcher.h"
+#include "AssetBundle.h"
+#include "AssetImportScheduler.h"
+#include "AsyncTask.h"
 
 #define ASSETS_FOLDER "vRenderer\\assets\\"
 #define MODEL_ASSETS_FOLDER "vRenderer\\assets\\models\\"
 #define MODEL_ASSETS(asset) concat(MODEL_ASSETS_FOLDER, asset)
 #define CUBEMAP_ASSETS_FOLDER "vRenderer\\assets\\cubemaps\\"
 #define CUBEMAP_ASSETS(asset) concat(CUBEMAP_ASSETS_FOLDER, asset)
+#define ASSET_BUNDLE_FILE "vRenderer\\assets.vrdb"
 
 using Model_future = std::future<std::shared_ptr<Model>>;
 
+/// <summary>
+/// Single asset of a batched import request.
+/// </summary>
+struct AssetRequest
+{
+	enum class Type
+	{
+		MODEL,
+		TEXTURE,
+		CUBEMAP
+	};
+
+	Type type;
+	std::string name;
+};
+
+/// <summary>
+/// Result of a single asset import of a batched request. Only the member matching the request type is set.
+/// </summary>
+struct ImportedAsset
+{
+	AssetRequest request;
+	std::shared_ptr<Model> model;
+	std::shared_ptr<Texture> texture;
+	std::shared_ptr<Cubemap> cubemap;
+};
+
 class AssetImporter
 {
 public:
 
 	AssetImporter(IModelAssetImporter* modelImporter, IImageAssetImporter* imageImporter);
 
-	std::shared_ptr<Model> importModel(std::string modelName);
-	std::shared_ptr<Texture> importTexture(std::string textureName);
-	std::shared_ptr<Cubemap> importCubemap(std::string cubemapName);
+	void mountBundle(std::filesystem::path bundlePath);
+
+	// Async imports are scheduled by priority and can be cancelled through provided token or returned request id.
+	// Cancelled imports never reach their onFinish callback.
 
 	template<typename Callback>
-	void importModel_async(std::string modelName, Callback onFinish);
+	ImportRequestId importModel_async(std::string modelName, Callback onFinish,
+		ImportPriority priority = ImportPriority::VISIBLE, CancellationToken token = {});
 
 	template<typename Callback>
-	void importTexture_async(std::string textureName, Callback onFinish);
+	ImportRequestId importTexture_async(std::string textureName, Callback onFinish,
+		ImportPriority priority = ImportPriority::VISIBLE, CancellationToken token = {});
 
 	template<typename Callback>
-	void importTextures_async(const std::vector<std::string>& textureNames, Callback onFinish);
+	ImportRequestId importTextures_async(const std::vector<std::string>& textureNames, Callback onFinish,
+		ImportPriority priority = ImportPriority::VISIBLE, CancellationToken token = {});
 
 	template<typename Callback>
-	void importCubemap_async(std::string cubemapName, Callback onFinish);
+	ImportRequestId importCubemap_async(std::string cubemapName, Callback onFinish,
+		ImportPriority priority = ImportPriority::VISIBLE, CancellationToken token = {});
+
+	template<typename ProgressCallback, typename Callback>
+	ImportRequestId importBatch_async(const std::vector<AssetRequest>& assets, ProgressCallback onProgress, Callback onFinish,
+		ImportPriority priority = ImportPriority::VISIBLE, CancellationToken token = {});
+
+	// Coroutine counterparts of the async imports. Import waits for its turn in the scheduler and awaiting coroutine
+	// is resumed on the worker that finished it. Cancellation throws OperationCancelled into the awaiting coroutine.
+
+	AsyncTask<std::shared_ptr<Model>> importModelTask(std::string modelName,
+		ImportPriority priority = ImportPriority::VISIBLE, CancellationToken token = {});
+	AsyncTask<std::shared_ptr<Texture>> importTextureTask(std::string textureName, TextureRole role = TextureRole::OTHER,
+		ImportPriority priority = ImportPriority::VISIBLE, CancellationToken token = {});
+	AsyncTask<std::shared_ptr<Cubemap>> importCubemapTask(std::string cubemapName,
+		ImportPriority priority = ImportPriority::VISIBLE, CancellationToken token = {});
+
+	bool setImportPriority(ImportRequestId requestId, ImportPriority priority);
+	bool cancelImport(ImportRequestId requestId);
+
+	void setImportSettings(const ImportSettings& settings);
 
 private:
 
-	std::unique_ptr<ThreadPool> pool;
 	std::unique_ptr<IModelAssetImporter> modelImporter;
 	std::unique_ptr<IImageAssetImporter> imageImporter;
 
+	// Mounted asset bundle. Assets found in it are served ahead of loose files.
+	std::unique_ptr<AssetBundle> bundle;
+
+	std::unique_ptr<AssetImportScheduler> scheduler;
+
+	class ImportSlotAwaiter;
+	ImportSlotAwaiter waitForImportSlot(ImportPriority priority, CancellationToken token);
+
+	// Imports themselves. They run on workers, but suspend instead of blocking while files are read.
+	AsyncTask<std::shared_ptr<Model>> loadModel(std::string modelName);
+	AsyncTask<std::shared_ptr<Texture>> loadTexture(std::string textureName, TextureRole role);
+	AsyncTask<std::vector<std::shared_ptr<Texture>>> loadTextures(std::vector<std::string> textureNames, TextureRole role);
+	AsyncTask<std::shared_ptr<Cubemap>> loadCubemap(std::string cubemapName);
+	AsyncTask<void> importAsset(ImportedAsset& asset, CancellationToken token, std::function<void()> onImported);
+
+	template<typename Callback, typename Result>
+	static void finish(ImportPriority priority, const CancellationToken& token, Callback onFinish, Result result);
+	template<typename Callback, typename Result>
+	static AsyncTask<void> deliver(AsyncTask<Result> import, AssetImportScheduler::Slot slot, ImportPriority priority, CancellationToken token, Callback onFinish);
+	template<typename ProgressCallback, typename Callback>
+	AsyncTask<void> importBatch(std::vector<AssetRequest> assets, ProgressCallback onProgress, Callback onFinish,
+		ImportPriority priority, CancellationToken token, AssetImportScheduler::Slot slot);
+
+	// Completions of imports that aren't needed right away give way to other main thread work
+	static DispatchPriority getDispatchPriority(ImportPriority priority);
+
 };
 
 // Helper function for runtime concatenation
@@ -53,46 +133,110 @@ static inline const char* concat(const char* a, const char* b) {
 	return buffer;
 }
 
+/// <summary>
+/// Delivers import result to the main thread unless import got cancelled.
+/// Token is checked once more right before the callback, since it may be cancelled while the result is waiting in the main thread queue.
+/// </summary>
+template<typename Callback, typename Result>
+inline void AssetImporter::finish(ImportPriority priority, const CancellationToken& token, Callback onFinish, Result result)
+{
+	if (token.isCancelled()) return;
+
+	ThreadDispatcher::instance().main(getDispatchPriority(priority), [token, onFinish](Result result) {
+		if (!token.isCancelled())
+		{
+			onFinish(result);
+		}
+		}, result);
+}
+
+/// <summary>
+/// Awaits an import and delivers its result. Slot keeps the request running until the import is done.
+/// </summary>
+template<typename Callback, typename Result>
+inline AsyncTask<void> AssetImporter::deliver(AsyncTask<Result> import, AssetImportScheduler::Slot slot, ImportPriority priority, CancellationToken token, Callback onFinish)
+{
+	Result result = co_await std::move(import);
+	finish(priority, token, onFinish, result);
+}
+
 template<typename Callback>
-inline void AssetImporter::importModel_async(std::string modelName, Callback onFinish)
+inline ImportRequestId AssetImporter::importModel_async(std::string modelName, Callback onFinish, ImportPriority priority, CancellationToken token)
 {
-	auto* dispatcher = &ThreadDispatcher::instance();
-	dispatcher->worker([this, modelName, onFinish, dispatcher]() {
-		auto model = importModel(modelName);
-		dispatcher->main(onFinish, model);
+	return scheduler->scheduleDeferred(priority, token, [this, modelName, onFinish, priority](const CancellationToken& token, AssetImportScheduler::Completion complete) {
+		deliver(loadModel(modelName), AssetImportScheduler::Slot(std::move(complete)), priority, token, onFinish).detach();
 		});
 }
 
 template<typename Callback>
-inline void AssetImporter::importTexture_async(std::string textureName, Callback onFinish)
+inline ImportRequestId AssetImporter::importTexture_async(std::string textureName, Callback onFinish, ImportPriority priority, CancellationToken token)
 {
-	auto* dispatcher = &ThreadDispatcher::instance();
-	dispatcher->worker([this, textureName, onFinish, dispatcher]() {
-		auto texture = importTexture(textureName);
-		dispatcher->main(onFinish, texture);
+	return scheduler->scheduleDeferred(priority, token, [this, textureName, onFinish, priority](const CancellationToken& token, AssetImportScheduler::Completion complete) {
+		deliver(loadTexture(textureName, TextureRole::OTHER), AssetImportScheduler::Slot(std::move(complete)), priority, token, onFinish).detach();
 		});
 }
 
 template<typename Callback>
-inline void AssetImporter::importTextures_async(const std::vector<std::string>& textureNames, Callback onFinish)
+inline ImportRequestId AssetImporter::importTextures_async(const std::vector<std::string>& textureNames, Callback onFinish, ImportPriority priority, CancellationToken token)
 {
-	auto* dispatcher = &ThreadDispatcher::instance();
-	dispatcher->worker([this, textureNames, onFinish, dispatcher]() {
-		std::vector<std::shared_ptr<Texture>> importedTextures(textureNames.size());
-		for (int i = 0; i < textureNames.size(); ++i)
-		{
-			importedTextures[i] = importTexture(textureNames[i]);
-		}
-		dispatcher->main(onFinish, importedTextures);
+	return scheduler->scheduleDeferred(priority, token, [this, textureNames, onFinish, priority](const CancellationToken& token, AssetImportScheduler::Completion complete) {
+		deliver(loadTextures(textureNames, TextureRole::OTHER), AssetImportScheduler::Slot(std::move(complete)), priority, token, onFinish).detach();
 		});
 }
 
 template<typename Callback>
-inline void AssetImporter::importCubemap_async(std::string cubemapName, Callback onFinish)
+inline ImportRequestId AssetImporter::importCubemap_async(std::string cubemapName, Callback onFinish, ImportPriority priority, CancellationToken token)
+{
+	return scheduler->scheduleDeferred(priority, token, [this, cubemapName, onFinish, priority](const CancellationToken& token, AssetImportScheduler::Completion complete) {
+		deliver(loadCubemap(cubemapName), AssetImportScheduler::Slot(std::move(complete)), priority, token, onFinish).detach();
+		});
+}
+
+/// <summary>
+/// Imports several assets of any type as a single request. Assets are imported in parallel.
+/// onProgress(completedCount, totalCount) is called on main thread after each imported asset,
+/// onFinish receives all imported assets in the order of the request, unless any of them failed.
+/// Cancellation is checked before each asset.
+/// </summary>
+template<typename ProgressCallback, typename Callback>
+inline ImportRequestId AssetImporter::importBatch_async(const std::vector<AssetRequest>& assets, ProgressCallback onProgress, Callback onFinish,
+	ImportPriority priority, CancellationToken token)
 {
-	auto* dispatcher = &ThreadDispatcher::instance();
-	dispatcher->worker([this, cubemapName, onFinish, dispatcher]() {
-		std::shared_ptr<Cubemap> cubemap = importCubemap(cubemapName);
-		dispatcher->main(onFinish, cubemap);
+	return scheduler->scheduleDeferred(priority, token, [this, assets, onProgress, onFinish, priority](const CancellationToken& token,
+		AssetImportScheduler::Completion complete) {
+		importBatch(assets, onProgress, onFinish, priority, token, AssetImportScheduler::Slot(std::move(complete))).detach();
 		});
 }
+
+/// <summary>
+/// Runs imports of a batch, each on its own worker. Request stays running until the whole batch is done,
+/// so it can still be cancelled by id, but no worker waits for the batch meanwhile.
+/// </summary>
+template<typename ProgressCallback, typename Callback>
+inline AsyncTask<void> AssetImporter::importBatch(std::vector<AssetRequest> assets, ProgressCallback onProgress, Callback onFinish,
+	ImportPriority priority, CancellationToken token, AssetImportScheduler::Slot slot)
+{
+	std::vector<ImportedAsset> importedAssets(assets.size());
+	std::atomic<size_t> completedCount = 0;
+	size_t total = assets.size();
+
+	std::vector<AsyncTask<void>> imports;
+	for (size_t i = 0; i < assets.size(); i++)
+	{
+		importedAssets[i].request = assets[i];
+		imports.push_back(importAsset(importedAssets[i], token, [&completedCount, &onProgress, &token, total]() {
+			ThreadDispatcher::instance().main(DispatchPriority::HIGH, [token, onProgress](size_t completed, size_t total) {
+				if (!token.isCancelled())
+				{
+					onProgress(completed, total);
+				}
+				}, ++completedCount, total);
+			}));
+	}
+
+	// First failure is rethrown once all imports are done, which skips onFinish
+	co_await whenAll(std::move(imports));
+
+	co_await switchToMain(getDispatchPriority(priority), token);
+	onFinish(importedAssets);
+}
\ No newline at end of file
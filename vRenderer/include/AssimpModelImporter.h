@@ -1,9 +1,11 @@
 #pragma once
 
 #include <unordered_map>
+#include <mutex>
 
 #include "IModelAssetImporter.h"
 #include "geometry_settings.h"
+#include "AsyncFileReader.h"
 
 #include "assimp/Importer.hpp"
 #include "assimp/scene.h"
@@ -12,8 +14,13 @@
 class AssimpModelImporter : public IModelAssetImporter
 {
 public:
-	std::shared_ptr<Model> importModel(std::filesystem::path modelFilePath, IImageAssetImporter& imageImporter, bool printImportData = false) override;
+	AsyncTask<std::shared_ptr<Model>> importModel(std::filesystem::path modelFilePath, IImageAssetImporter& imageImporter, bool printImportData = false) override;
 
 private:
 	std::unordered_map<std::string, std::shared_ptr<Model>> importedModelsMap;
+	// Imported meshes keyed by their content hash. Used to share identical geometry across models.
+	std::unordered_map<uint64_t, std::shared_ptr<Mesh>> importedMeshesMap;
+	std::mutex cacheMutex;
+
+	std::shared_ptr<Mesh> getSharedMesh(std::unique_ptr<Mesh> mesh);
 };
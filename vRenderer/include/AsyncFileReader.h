@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <future>
+#include <memory>
+#include <functional>
+#include <filesystem>
+
+#include "Singleton.h"
+
+/*
+	Asynchronous whole-file reads for the asset pipeline.
+
+	On Linux builds with VRD_ENABLE_IO_URING defined, reads are batched through io_uring:
+	all pending requests are submitted with a single syscall and served by the kernel in parallel.
+	Otherwise (or if io_uring is not available at runtime, or the ring fails later on) reads are served by
+	ThreadDispatcher's I/O pool, which has to be initialized first.
+
+	Failed reads are reported by the returned future throwing std::runtime_error on get().
+	Compute workers must not wait on these futures. They should pass a continuation to readBatch instead,
+	which receives futures that are already ready.
+*/
+
+using FileData = std::vector<uint8_t>;
+using FileData_future = std::future<FileData>;
+
+class AsyncFileReader : public Singleton<AsyncFileReader>
+{
+	friend class Singleton<AsyncFileReader>;
+
+public:
+
+	FileData_future read(const std::filesystem::path& filePath);
+	std::vector<FileData_future> readBatch(const std::vector<std::filesystem::path>& filePaths);
+	void readBatch(const std::vector<std::filesystem::path>& filePaths, std::function<void(std::vector<FileData_future>)> onRead);
+
+	bool isIoUringEnabled() const;
+
+	// Blocking read of a whole file on the calling thread.
+	static FileData readFileSync(const std::filesystem::path& filePath);
+
+protected:
+
+	AsyncFileReader();
+	~AsyncFileReader();
+
+private:
+
+	class IoUringBackend;
+	struct BatchContinuation;
+
+	std::unique_ptr<IoUringBackend> ioUring;
+
+	std::vector<FileData_future> startReads(const std::vector<std::filesystem::path>& filePaths, const std::shared_ptr<BatchContinuation>& continuation);
+	static void readOnIoPool(std::promise<FileData>&& promise, const std::filesystem::path& filePath, const std::shared_ptr<BatchContinuation>& continuation);
+};
\ No newline at end of file
@@ -0,0 +1,464 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <future>
+#include <variant>
+#include <optional>
+#include <cstdio>
+#include <utility>
+#include <exception>
+#include <stdexcept>
+#include <coroutine>
+
+#include "ThreadDispatcher.h"
+#include "AssetImportScheduler.h"
+#include "AsyncFileReader.h"
+
+/*
+	Coroutine based asynchronous operations on top of ThreadDispatcher.
+
+	AsyncTask<T> starts when it is first awaited (or detached) and resumes its awaiter on the thread it finished on.
+	Switching threads is explicit:
+
+		AsyncTask<void> load(std::string name)
+		{
+			std::shared_ptr<Model> model = co_await importer.importModelTask(name);	// resumes on a worker
+			co_await switchToMain();												// resumes in ThreadDispatcher::process()
+			...
+		}
+
+		load("sponza").detach();
+
+	File reads are awaited with readFiles(), which resumes on a worker once the data is there instead of
+	blocking a worker on the read.
+
+	Cancellation is cooperative: awaiters that take a CancellationToken throw OperationCancelled on resume
+	if the token got cancelled, which unwinds the coroutine chain. Detached tasks end silently on cancellation.
+*/
+
+class OperationCancelled : public std::runtime_error
+{
+public:
+	OperationCancelled() : std::runtime_error("Operation was cancelled.") {}
+};
+
+inline void throwIfCancelled(const CancellationToken& token)
+{
+	if (token.isCancelled())
+	{
+		throw OperationCancelled();
+	}
+}
+
+template<typename T = void>
+class AsyncTask;
+
+namespace async_detail
+{
+	/// <summary>
+	/// Part of the promise that doesn't depend on the result type.
+	/// Continuation is resumed once the task completes. When a task is awaited as a part of whenAll,
+	/// pendingCount is shared by all tasks of the group and only the last one to finish resumes the continuation.
+	/// </summary>
+	struct PromiseBase
+	{
+		std::coroutine_handle<> continuation;
+		std::atomic<size_t>* pendingCount = nullptr;
+		std::exception_ptr exception;
+		bool detached = false;
+
+		struct FinalAwaiter
+		{
+			bool await_ready() const noexcept { return false; }
+
+			template<typename Promise>
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+			{
+				PromiseBase& promise = handle.promise();
+				if (promise.detached)
+				{
+					promise.reportDetachedException();
+					handle.destroy();
+					return std::noop_coroutine();
+				}
+				if (promise.pendingCount != nullptr && promise.pendingCount->fetch_sub(1, std::memory_order_acq_rel) != 1)
+				{
+					return std::noop_coroutine();
+				}
+				return promise.continuation ? promise.continuation : std::noop_coroutine();
+			}
+
+			void await_resume() const noexcept {}
+		};
+
+		std::suspend_always initial_suspend() const noexcept { return {}; }
+		FinalAwaiter final_suspend() const noexcept { return {}; }
+
+		void unhandled_exception() noexcept
+		{
+			exception = std::current_exception();
+		}
+
+		void reportDetachedException() const noexcept
+		{
+			if (exception == nullptr) return;
+
+			try
+			{
+				std::rethrow_exception(exception);
+			}
+			catch (const OperationCancelled&)
+			{
+			}
+			catch (const std::exception& e)
+			{
+				printf("ERROR: Async task failed. %s\n", e.what());
+			}
+			catch (...)
+			{
+				printf("ERROR: Async task failed.\n");
+			}
+		}
+	};
+
+	template<typename T>
+	struct Promise : PromiseBase
+	{
+		std::variant<std::monostate, T> result;
+
+		AsyncTask<T> get_return_object() noexcept;
+
+		template<typename Value>
+		void return_value(Value&& value)
+		{
+			result.template emplace<1>(std::forward<Value>(value));
+		}
+
+		T takeResult()
+		{
+			if (exception != nullptr)
+			{
+				std::rethrow_exception(exception);
+			}
+			return std::move(std::get<1>(result));
+		}
+	};
+
+	template<>
+	struct Promise<void> : PromiseBase
+	{
+		AsyncTask<void> get_return_object() noexcept;
+
+		void return_void() noexcept {}
+
+		void takeResult()
+		{
+			if (exception != nullptr)
+			{
+				std::rethrow_exception(exception);
+			}
+		}
+	};
+}
+
+/// <summary>
+/// Lazily started coroutine producing a value of type T. Owns the coroutine frame unless detached.
+/// </summary>
+template<typename T>
+class [[nodiscard]] AsyncTask
+{
+public:
+
+	using promise_type = async_detail::Promise<T>;
+	using Handle = std::coroutine_handle<promise_type>;
+
+	AsyncTask() = default;
+	explicit AsyncTask(Handle handle) : handle(handle) {}
+
+	AsyncTask(AsyncTask&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+	AsyncTask& operator=(AsyncTask&& other) noexcept
+	{
+		if (this != &other)
+		{
+			reset();
+			handle = std::exchange(other.handle, nullptr);
+		}
+		return *this;
+	}
+
+	AsyncTask(const AsyncTask&) = delete;
+	AsyncTask& operator=(const AsyncTask&) = delete;
+
+	~AsyncTask()
+	{
+		reset();
+	}
+
+	// Starts the task without waiting for it. Frame is destroyed once task completes, failures are logged.
+	void detach() &&
+	{
+		Handle started = std::exchange(handle, nullptr);
+		started.promise().detached = true;
+		started.resume();
+	}
+
+	auto operator co_await() && noexcept
+	{
+		struct Awaiter
+		{
+			Handle handle;
+
+			// Task awaited after whenAll has already completed it
+			bool await_ready() const noexcept { return handle.done(); }
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+			{
+				handle.promise().continuation = awaiting;
+				return handle;
+			}
+
+			T await_resume()
+			{
+				return handle.promise().takeResult();
+			}
+		};
+		return Awaiter{ handle };
+	}
+
+private:
+
+	template<typename U>
+	friend class WhenAllAwaiter;
+
+	Handle handle = nullptr;
+
+	void reset()
+	{
+		if (handle)
+		{
+			handle.destroy();
+			handle = nullptr;
+		}
+	}
+};
+
+namespace async_detail
+{
+	template<typename T>
+	inline AsyncTask<T> Promise<T>::get_return_object() noexcept
+	{
+		return AsyncTask<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+	}
+
+	inline AsyncTask<void> Promise<void>::get_return_object() noexcept
+	{
+		return AsyncTask<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+	}
+}
+
+/// <summary>
+/// Starts all tasks at once and resumes the awaiting coroutine on the thread that finished the last of them.
+/// </summary>
+template<typename T>
+class WhenAllAwaiter
+{
+public:
+
+	explicit WhenAllAwaiter(std::vector<AsyncTask<T>>& tasks) : tasks(tasks) {}
+
+	bool await_ready() const noexcept { return tasks.empty(); }
+
+	bool await_suspend(std::coroutine_handle<> awaiting) noexcept
+	{
+		// Extra count keeps tasks that finish synchronously from resuming the caller before all of them are started
+		pendingCount.store(tasks.size() + 1, std::memory_order_relaxed);
+		for (AsyncTask<T>& task : tasks)
+		{
+			task.handle.promise().continuation = awaiting;
+			task.handle.promise().pendingCount = &pendingCount;
+			task.handle.resume();
+		}
+		return pendingCount.fetch_sub(1, std::memory_order_acq_rel) != 1;
+	}
+
+	void await_resume() const noexcept {}
+
+private:
+
+	std::vector<AsyncTask<T>>& tasks;
+	std::atomic<size_t> pendingCount = 0;
+};
+
+/// <summary>
+/// Runs tasks concurrently and returns their results in the order of tasks.
+/// If any of the tasks fails, the first failure in task order is rethrown once all of them are done.
+/// </summary>
+template<typename T>
+AsyncTask<std::vector<T>> whenAll(std::vector<AsyncTask<T>> tasks)
+{
+	co_await WhenAllAwaiter<T>(tasks);
+
+	std::vector<T> results;
+	results.reserve(tasks.size());
+	for (AsyncTask<T>& task : tasks)
+	{
+		results.push_back(co_await std::move(task));
+	}
+	co_return results;
+}
+
+inline AsyncTask<void> whenAll(std::vector<AsyncTask<void>> tasks)
+{
+	co_await WhenAllAwaiter<void>(tasks);
+
+	for (AsyncTask<void>& task : tasks)
+	{
+		co_await std::move(task);
+	}
+}
+
+/// <summary>
+/// Suspends the coroutine and resumes it through one of ThreadDispatcher queues.
+/// Token, if provided, is checked on resume. Nothing is allocated besides the queued task node.
+/// </summary>
+class DispatchAwaiter
+{
+public:
+
+	enum class Target
+	{
+		WORKER,
+		IO,
+		MAIN
+	};
+
+	DispatchAwaiter(Target target, DispatchPriority priority, std::optional<CancellationToken> token = std::nullopt) :
+		target(target), priority(priority), token(std::move(token)) {}
+
+	bool await_ready() const noexcept { return false; }
+
+	void await_suspend(std::coroutine_handle<> handle) const
+	{
+		ThreadDispatcher& dispatcher = ThreadDispatcher::instance();
+		switch (target)
+		{
+		case Target::WORKER:
+			dispatcher.worker([handle]() { handle.resume(); });
+			break;
+		case Target::IO:
+			dispatcher.io([handle]() { handle.resume(); });
+			break;
+		case Target::MAIN:
+			dispatcher.main(priority, [handle]() { handle.resume(); });
+			break;
+		}
+	}
+
+	void await_resume() const
+	{
+		if (token.has_value())
+		{
+			throwIfCancelled(*token);
+		}
+	}
+
+private:
+
+	Target target;
+	DispatchPriority priority;
+	std::optional<CancellationToken> token;
+};
+
+inline DispatchAwaiter switchToWorker()
+{
+	return DispatchAwaiter(DispatchAwaiter::Target::WORKER, DispatchPriority::NORMAL);
+}
+
+inline DispatchAwaiter switchToWorker(CancellationToken token)
+{
+	return DispatchAwaiter(DispatchAwaiter::Target::WORKER, DispatchPriority::NORMAL, std::move(token));
+}
+
+inline DispatchAwaiter switchToIo()
+{
+	return DispatchAwaiter(DispatchAwaiter::Target::IO, DispatchPriority::NORMAL);
+}
+
+inline DispatchAwaiter switchToIo(CancellationToken token)
+{
+	return DispatchAwaiter(DispatchAwaiter::Target::IO, DispatchPriority::NORMAL, std::move(token));
+}
+
+inline DispatchAwaiter switchToMain(DispatchPriority priority = DispatchPriority::NORMAL)
+{
+	return DispatchAwaiter(DispatchAwaiter::Target::MAIN, priority);
+}
+
+inline DispatchAwaiter switchToMain(DispatchPriority priority, CancellationToken token)
+{
+	return DispatchAwaiter(DispatchAwaiter::Target::MAIN, priority, std::move(token));
+}
+
+/// <summary>
+/// Reads files without blocking the awaiting thread. Coroutine is resumed on a worker once all of them are read,
+/// with futures in the order of paths. Futures are ready, so get() either returns data or rethrows the read error.
+/// </summary>
+class ReadFilesAwaiter
+{
+public:
+
+	explicit ReadFilesAwaiter(std::vector<std::filesystem::path> filePaths) : filePaths(std::move(filePaths)) {}
+
+	bool await_ready() const noexcept { return false; }
+
+	void await_suspend(std::coroutine_handle<> handle)
+	{
+		// Coroutine may be resumed and finished before readBatch returns, so nothing of the frame is used past the call
+		std::vector<std::filesystem::path> paths = std::move(filePaths);
+		AsyncFileReader::instance().readBatch(paths, [this, handle](std::vector<FileData_future> futures) {
+			reads = std::move(futures);
+			handle.resume();
+			});
+	}
+
+	std::vector<FileData_future> await_resume()
+	{
+		return std::move(reads);
+	}
+
+private:
+
+	std::vector<std::filesystem::path> filePaths;
+	std::vector<FileData_future> reads;
+};
+
+inline ReadFilesAwaiter readFiles(std::vector<std::filesystem::path> filePaths)
+{
+	return ReadFilesAwaiter(std::move(filePaths));
+}
+
+/// <summary>
+/// Runs a task to completion and returns its result, blocking the calling thread meanwhile.
+/// Only meant for threads outside of ThreadDispatcher pools (i.e. command line tools), never call it from a worker.
+/// </summary>
+template<typename T>
+T blockingWait(AsyncTask<T> task)
+{
+	std::promise<T> promise;
+	std::future<T> result = promise.get_future();
+
+	auto run = [](AsyncTask<T> task, std::promise<T>& promise) -> AsyncTask<void> {
+		try
+		{
+			promise.set_value(co_await std::move(task));
+		}
+		catch (...)
+		{
+			promise.set_exception(std::current_exception());
+		}
+	};
+	run(std::move(task), promise).detach();
+
+	return result.get();
+}
\ No newline at end of file
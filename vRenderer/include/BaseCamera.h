@@ -5,6 +5,7 @@
 #include <glm/vec3.hpp>
 
 #include "AppContext.h"
+#include "Bounds.h"
 
 #include "editor_settings.h"
 #include "input_handler.h"
@@ -30,9 +31,14 @@ public:
 	glm::vec3 getRight() const;
 	glm::vec3 getUp() const;
 	glm::vec3 getPosition() const;
+	glm::vec3 getTarget() const;
 
 	glm::mat4 getProjectionMatrix() const;
 	glm::mat4 getViewMatrix() const;
+	// World space frustum of the current view and projection
+	Frustum getFrustum() const;
+	// World space ray from the camera through a viewport point, normalized to 0..1 from the top left corner
+	Ray getViewRay(glm::vec2 viewportPoint) const;
 
 	virtual void update() = 0;
 	virtual void onMouseScroll(float amount, InputState input) = 0;
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+
+/*
+	Helpers for (de)serialization of plain data into flat byte buffers.
+	Values are stored in native (little-endian) byte order, containers are prefixed with their element count.
+*/
+
+class BinaryWriter
+{
+public:
+
+	template<typename T>
+	void write(const T& value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be written directly");
+		writeBytes(&value, sizeof(T));
+	}
+
+	template<typename T>
+	void writeVector(const std::vector<T>& values)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be written directly");
+		write(static_cast<uint64_t>(values.size()));
+		writeBytes(values.data(), values.size() * sizeof(T));
+	}
+
+	void writeString(const std::string& value)
+	{
+		write(static_cast<uint32_t>(value.size()));
+		writeBytes(value.data(), value.size());
+	}
+
+	void writeBytes(const void* data, size_t size)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		buffer.insert(buffer.end(), bytes, bytes + size);
+	}
+
+	size_t size() const { return buffer.size(); }
+	const std::vector<uint8_t>& data() const { return buffer; }
+	std::vector<uint8_t> release() { return std::move(buffer); }
+
+private:
+
+	std::vector<uint8_t> buffer;
+};
+
+class BinaryReader
+{
+public:
+
+	BinaryReader(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+	template<typename T>
+	T read()
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be read directly");
+		T value;
+		readBytes(&value, sizeof(T));
+		return value;
+	}
+
+	template<typename T>
+	std::vector<T> readVector()
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be read directly");
+		uint64_t count = read<uint64_t>();
+		if (count > remaining() / sizeof(T))
+		{
+			throw std::runtime_error("Binary data is truncated or corrupted.");
+		}
+		std::vector<T> values(count);
+		readBytes(values.data(), count * sizeof(T));
+		return values;
+	}
+
+	std::string readString()
+	{
+		uint32_t length = read<uint32_t>();
+		std::string value(reinterpret_cast<const char*>(skip(length)), length);
+		return value;
+	}
+
+	void readBytes(void* dst, size_t count)
+	{
+		const uint8_t* src = skip(count);
+		if (count > 0)
+		{
+			memcpy(dst, src, count);
+		}
+	}
+
+	/// <summary>
+	/// Advances reading position returning pointer to the skipped bytes.
+	/// </summary>
+	const uint8_t* skip(size_t count)
+	{
+		if (count > remaining())
+		{
+			throw std::runtime_error("Binary data is truncated or corrupted.");
+		}
+		const uint8_t* ptr = data + offset;
+		offset += count;
+		return ptr;
+	}
+
+	size_t remaining() const { return size - offset; }
+
+private:
+
+	const uint8_t* data;
+	size_t size;
+	size_t offset = 0;
+};
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cfloat>
+#include <cmath>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+/// <summary>
+/// Axis aligned bounding box. Empty box has min > max.
+/// </summary>
+struct BoundingBox
+{
+	glm::vec3 min = glm::vec3(FLT_MAX);
+	glm::vec3 max = glm::vec3(-FLT_MAX);
+
+	bool isEmpty() const { return min.x > max.x; }
+	glm::vec3 getCenter() const { return (min + max) * 0.5f; }
+
+	void expand(const glm::vec3& point)
+	{
+		min = glm::min(min, point);
+		max = glm::max(max, point);
+	}
+
+	void expand(const BoundingBox& box)
+	{
+		min = glm::min(min, box.min);
+		max = glm::max(max, box.max);
+	}
+};
+
+struct BoundingSphere
+{
+	glm::vec3 center = glm::vec3(0.0f);
+	float radius = 0.0f;
+
+	// Packed as (center, radius), the layout culling works with
+	glm::vec4 pack() const { return glm::vec4(center, radius); }
+
+	// Sphere containing the sphere transformed by an affine matrix. Radius is scaled by the largest axis scale.
+	BoundingSphere transform(const glm::mat4& matrix) const
+	{
+		float scale = std::max({ glm::dot(glm::vec3(matrix[0]), glm::vec3(matrix[0])),
+			glm::dot(glm::vec3(matrix[1]), glm::vec3(matrix[1])),
+			glm::dot(glm::vec3(matrix[2]), glm::vec3(matrix[2])) });
+		return { glm::vec3(matrix * glm::vec4(center, 1.0f)), radius * std::sqrt(scale) };
+	}
+};
+
+struct Ray
+{
+	glm::vec3 origin = glm::vec3(0.0f);
+	glm::vec3 direction = glm::vec3(0.0f, 0.0f, -1.0f);
+};
+
+/// <summary>
+/// Six planes (left, right, bottom, top, near, far) with normals pointing inside, as (normal, distance).
+/// Point p is inside a plane if dot(normal, p) + distance >= 0.
+/// </summary>
+struct Frustum
+{
+	glm::vec4 planes[6];
+
+	// Extracts planes from a projection * view matrix with OpenGL clip space depth (-w..w)
+	static Frustum fromViewProjection(const glm::mat4& viewProjection)
+	{
+		glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+		glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+		glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+		glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+		Frustum frustum;
+		frustum.planes[0] = row3 + row0;
+		frustum.planes[1] = row3 - row0;
+		frustum.planes[2] = row3 + row1;
+		frustum.planes[3] = row3 - row1;
+		frustum.planes[4] = row3 + row2;
+		frustum.planes[5] = row3 - row2;
+		for (glm::vec4& plane : frustum.planes)
+		{
+			plane /= glm::length(glm::vec3(plane));
+		}
+		return frustum;
+	}
+
+	bool intersects(const glm::vec4& sphere) const
+	{
+		for (const glm::vec4& plane : planes)
+		{
+			if (glm::dot(glm::vec3(plane), glm::vec3(sphere)) + plane.w < -sphere.w) return false;
+		}
+		return true;
+	}
+};
\ No newline at end of file
@@ -1,118 +1,264 @@
 #pragma once
 
-#include <GLFW/glfw3.h>
-#include <string>
 #include <vector>
-#include <map>
-#include <unordered_map>
-#include <functional>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
 
-#include <iostream>
-
-struct CallData
+/// <summary>
+/// Non-owning callable reference of fixed size: object pointer, call stub and an inline copy of member function pointer.
+/// Never allocates. Call costs one indirect call, plus a member function pointer call when method is provided at runtime.
+/// </summary>
+template <typename... Params>
+class Delegate
 {
-    void* classType;
-    void* event;
+public:
+
+    Delegate() = default;
 
-    bool operator==(const CallData& other) const {
-        return classType == other.classType &&
-            event == other.event;
+    // Method known at compile time, call is resolved inside the stub
+    template <auto Method, typename ClassType>
+    static Delegate fromMethod(ClassType* object)
+    {
+        Delegate delegate;
+        delegate.object = object;
+        delegate.stub = [](const Delegate& self, Params... args) {
+            (static_cast<ClassType*>(self.object)->*Method)(args...);
+        };
+        return delegate;
     }
-};
 
-struct CallDataHash {
-    size_t operator()(const CallData& cd) const {
-        return (std::hash<void*>()(cd.classType)) ^
-            (std::hash<void*>()(cd.event) << 1);
+    template <typename ClassType, typename Method>
+    static Delegate fromMethod(ClassType* object, Method method)
+    {
+        static_assert(std::is_member_function_pointer_v<Method>, "Delegate::fromMethod expects a member function pointer.");
+        static_assert(sizeof(Method) <= c_methodStorageSize, "Member function pointer doesn't fit into Delegate.");
+
+        Delegate delegate;
+        delegate.object = object;
+        std::memcpy(delegate.methodStorage, &method, sizeof(Method));
+        delegate.stub = [](const Delegate& self, Params... args) {
+            Method method;
+            std::memcpy(&method, self.methodStorage, sizeof(Method));
+            (static_cast<ClassType*>(self.object)->*method)(args...);
+        };
+        return delegate;
+    }
+
+    template <void (*Function)(Params...)>
+    static Delegate fromFunction()
+    {
+        Delegate delegate;
+        delegate.stub = [](const Delegate&, Params... args) {
+            Function(args...);
+        };
+        return delegate;
     }
+
+    void operator()(Params... args) const
+    {
+        stub(*this, args...);
+    }
+
+    explicit operator bool() const { return stub != nullptr; }
+
+    void* getObject() const { return object; }
+
+private:
+
+    // Fits member function pointers of classes with virtual inheritance on MSVC
+    static constexpr size_t c_methodStorageSize = 3 * sizeof(void*);
+
+    using Stub = void (*)(const Delegate&, Params...);
+
+    void* object = nullptr;
+    Stub stub = nullptr;
+    alignas(void*) unsigned char methodStorage[c_methodStorageSize] = {};
+};
+
+/// <summary>
+/// Identifies a single subscription of an Event. Stays invalid once subscription is removed, even if its slot is reused.
+/// </summary>
+struct EventHandle
+{
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool isValid() const { return index != UINT32_MAX; }
 };
 
 /// <summary>
-/// Simple Event template class. Use EventBinder::Bind to add any function/method call to event callbacks.
-/// Example: EventBinder::Bind(&Class::method, obj, event)
+/// Simple Event template class. Use EventBinder::Bind to add any method call to event callbacks.
+/// Example: EventBinder::Bind(&Class::method, obj, event) or EventBinder::Bind<&Class::method>(obj, event)
+/// Callbacks are stored contiguously and invoked in the order they were added.
+/// Removal leaves a tombstone, which is compacted away when event isn't being invoked, so callbacks may unbind themselves.
+/// Callbacks added during invoke are first called by the next invoke.
 /// </summary>
 /// <typeparam name="...Params"></typeparam>
 template <typename... Params>
 class Event
 {
-    using callback_t = std::function<void(Params...)>;
-
 public:
-     
+
+    using delegate_t = Delegate<Params...>;
+
     Event() = default;
     ~Event() = default;
 
     void invoke(Params... args)
     {
-        for (auto& pair : callbacks)
+        invokeDepth++;
+        size_t count = subscribers.size();
+        for (size_t i = 0; i < count; i++)
+        {
+            // Subscriber list may grow during the call, so it is addressed by index
+            if (subscribers[i].delegate)
+            {
+                subscribers[i].delegate(args...);
+            }
+        }
+        invokeDepth--;
+
+        if (invokeDepth == 0 && removedCount > 0)
         {
-            pair.second(args...);
+            compact();
         }
     }
 
-    void add(callback_t callback, CallData callData)
+    EventHandle add(delegate_t delegate)
     {
-        callbacks.emplace(callData, callback);
+        uint32_t slotIndex;
+        if (!freeSlots.empty())
+        {
+            slotIndex = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else
+        {
+            slotIndex = static_cast<uint32_t>(slots.size());
+            slots.push_back({});
+        }
+
+        slots[slotIndex].subscriberIndex = static_cast<uint32_t>(subscribers.size());
+        subscribers.push_back({ delegate, slotIndex });
+        return { slotIndex, slots[slotIndex].generation };
     }
 
-    void remove(CallData callData)
-    {      
-        auto it = callbacks.find(callData);
-        if (it != callbacks.end())
+    // Returns false if subscription has already been removed
+    bool remove(EventHandle handle)
+    {
+        if (!handle.isValid() || handle.index >= slots.size() || slots[handle.index].generation != handle.generation)
+        {
+            return false;
+        }
+
+        Slot& slot = slots[handle.index];
+        subscribers[slot.subscriberIndex].delegate = {};
+        slot.generation++;
+        freeSlots.push_back(handle.index);
+        removedCount++;
+
+        // Otherwise tombstones are dropped by the next invoke, which walks over all subscribers anyway
+        if (invokeDepth == 0 && removedCount * 2 > subscribers.size())
         {
-            callbacks.erase(it);
-        }     
+            compact();
+        }
+        return true;
     }
 
+    // Handle of the first subscription made for the object, invalid handle if there is none
+    EventHandle find(const void* object) const
+    {
+        for (const Subscriber& subscriber : subscribers)
+        {
+            if (subscriber.delegate && subscriber.delegate.getObject() == object)
+            {
+                uint32_t slotIndex = subscriber.slotIndex;
+                return { slotIndex, slots[slotIndex].generation };
+            }
+        }
+        return {};
+    }
+
+    size_t size() const { return subscribers.size() - removedCount; }
+
 private:
-    std::unordered_map<CallData, callback_t, CallDataHash> callbacks;
-};
 
+    struct Subscriber
+    {
+        delegate_t delegate;
+        uint32_t slotIndex;
+    };
+
+    struct Slot
+    {
+        uint32_t subscriberIndex = 0;
+        uint32_t generation = 0;
+    };
+
+    std::vector<Subscriber> subscribers;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    uint32_t removedCount = 0;
+    uint32_t invokeDepth = 0;
+
+    // Drops tombstones keeping the order of remaining subscribers
+    void compact()
+    {
+        size_t last = 0;
+        for (size_t i = 0; i < subscribers.size(); i++)
+        {
+            if (!subscribers[i].delegate) continue;
 
-static class EventBinder
+            slots[subscribers[i].slotIndex].subscriberIndex = static_cast<uint32_t>(last);
+            subscribers[last++] = subscribers[i];
+        }
+        subscribers.resize(last);
+        removedCount = 0;
+    }
+};
+
+/// <summary>
+/// Binds object methods to events. An object is bound to an event at most once, binding it again returns existing subscription.
+/// Unbind by object is linear in the number of subscribers, unbinding by returned handle is constant time.
+/// </summary>
+class EventBinder
 {
 
 public:
 
     template <typename Callable, typename ClassType, typename... Params>
-    static void Bind(Callable callable, ClassType* classType, Event<Params...>& event)
+    static EventHandle Bind(Callable callable, ClassType* classType, Event<Params...>& event)
     {
-        CallData callData = { 
-            static_cast<void*>(classType),
-            static_cast<void*>(&event)
-        };
-
-        // If an event with more parameters is used add a new conditional here.
-        if constexpr (sizeof...(Params) == 0)
-        {
-            event.add(std::bind(callable, classType), callData);
-        }
-        else if constexpr (sizeof...(Params) == 1)
+        EventHandle handle = event.find(classType);
+        if (handle.isValid())
         {
-            event.add(std::bind(callable, classType, std::placeholders::_1), callData);
+            return handle;
         }
-        else if constexpr (sizeof...(Params) == 2)
-        {
-            event.add(std::bind(callable, classType, std::placeholders::_1, std::placeholders::_2), callData);
-        }
-        else if constexpr (sizeof...(Params) == 3)
-        {
-            event.add(std::bind(callable, classType, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3), callData);
-        }
-        else if constexpr (sizeof...(Params) == 4)
+        return event.add(Delegate<Params...>::fromMethod(classType, callable));
+    }
+
+    // Method known at compile time is called without going through member function pointer
+    template <auto Method, typename ClassType, typename... Params>
+    static EventHandle Bind(ClassType* classType, Event<Params...>& event)
+    {
+        EventHandle handle = event.find(classType);
+        if (handle.isValid())
         {
-            event.add(std::bind(callable, classType, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4), callData);
+            return handle;
         }
+        return event.add(Delegate<Params...>::template fromMethod<Method>(classType));
     }
 
     template <typename Callable, typename ClassType, typename... Params>
     static void Unbind(Callable callable, ClassType* classType, Event<Params...>& event)
     {
-        CallData callData = {
-            static_cast<void*>(classType),
-            static_cast<void*>(&event)
-        };
+        event.remove(event.find(classType));
+    }
 
-        event.remove(callData);
+    template <typename... Params>
+    static void Unbind(EventHandle handle, Event<Params...>& event)
+    {
+        event.remove(handle);
     }
 };
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "Bounds.h"
+
+/*
+	Visibility of bounding spheres against the camera frustum.
+	Spheres are tested 4 at a time with SSE2 where available, large sets are split between worker tasks.
+	Renderers keep world space spheres of their models in a contiguous array and draw only the indices returned.
+*/
+
+class FrustumCuller
+{
+public:
+
+	// Indices of spheres (packed as center, radius) intersecting the frustum, in ascending order
+	static void cull(const glm::vec4* spheres, size_t count, const Frustum& frustum, std::vector<uint32_t>& visible);
+
+private:
+
+	static void cullRange(const glm::vec4* spheres, size_t first, size_t last, const Frustum& frustum, std::vector<uint32_t>& visible);
+};
\ No newline at end of file
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <optional>
+
+namespace VRD::Scene
+{
+	/// <summary>
+	/// Generational reference to a scene instance. Handle of a deleted instance stays invalid even after its slot is reused.
+	/// </summary>
+	struct InstanceHandle
+	{
+		uint32_t index = UINT32_MAX;
+		uint32_t generation = 0;
+
+		bool isValid() const { return index != UINT32_MAX; }
+
+		bool operator==(const InstanceHandle& other) const
+		{
+			return index == other.index && generation == other.generation;
+		}
+		bool operator!=(const InstanceHandle& other) const { return !(*this == other); }
+	};
+
+	/*
+		Values keyed by instance handles issued by the scene graph, used by renderers to mirror scene instances.
+		Slots are indexed by handle index, so lookup, insertion and removal are O(1) without hashing,
+		and the table never holds more slots than the scene had instances at once.
+		Values are kept dense for iteration, removal moves the last value into the freed place,
+		so dense indices are only valid until the next removal.
+
+		Stored generation tells stale handles apart: a value is found only by the exact handle it was inserted with.
+	*/
+	template<typename T>
+	class HandleTable
+	{
+	public:
+
+		/// <summary>
+		/// Stores value for a handle that isn't in the table yet.
+		/// Slot is reused by the scene only after its previous instance was deleted, so a value stored for an older
+		/// generation of the same slot is removed and returned for the caller to release.
+		/// </summary>
+		std::optional<T> insert(InstanceHandle handle, T value)
+		{
+			if (handle.index >= slots.size())
+			{
+				slots.resize(handle.index + 1);
+			}
+
+			std::optional<T> displaced;
+			Slot& slot = slots[handle.index];
+			if (slot.denseIndex != c_emptySlot)
+			{
+				displaced = eraseDense(slot.denseIndex);
+			}
+
+			slot.denseIndex = static_cast<uint32_t>(values.size());
+			slot.generation = handle.generation;
+			values.push_back(std::move(value));
+			handles.push_back(handle);
+			return displaced;
+		}
+
+		/// <summary>
+		/// Removes value of the handle and returns it, nothing if handle isn't in the table.
+		/// </summary>
+		std::optional<T> erase(InstanceHandle handle)
+		{
+			if (!contains(handle)) return std::nullopt;
+			return eraseDense(slots[handle.index].denseIndex);
+		}
+
+		T* find(InstanceHandle handle)
+		{
+			return contains(handle) ? &values[slots[handle.index].denseIndex] : nullptr;
+		}
+
+		const T* find(InstanceHandle handle) const
+		{
+			return contains(handle) ? &values[slots[handle.index].denseIndex] : nullptr;
+		}
+
+		bool contains(InstanceHandle handle) const
+		{
+			return handle.index < slots.size() && slots[handle.index].denseIndex != c_emptySlot &&
+				slots[handle.index].generation == handle.generation;
+		}
+
+		// Preallocates dense storage before inserting many values at once.
+		// Capacity grows at least geometrically, so it can be called before every batch, however small.
+		void reserve(size_t count)
+		{
+			if (count <= values.capacity()) return;
+			count = std::max(count, values.capacity() * 2);
+			values.reserve(count);
+			handles.reserve(count);
+		}
+
+		void clear()
+		{
+			slots.clear();
+			values.clear();
+			handles.clear();
+		}
+
+		size_t size() const { return values.size(); }
+		bool empty() const { return values.empty(); }
+
+		// Dense access, indices are in [0, size())
+		T& operator[](size_t denseIndex) { return values[denseIndex]; }
+		const T& operator[](size_t denseIndex) const { return values[denseIndex]; }
+		InstanceHandle getHandle(size_t denseIndex) const { return handles[denseIndex]; }
+
+		typename std::vector<T>::iterator begin() { return values.begin(); }
+		typename std::vector<T>::iterator end() { return values.end(); }
+		typename std::vector<T>::const_iterator begin() const { return values.begin(); }
+		typename std::vector<T>::const_iterator end() const { return values.end(); }
+
+	private:
+
+		static constexpr uint32_t c_emptySlot = UINT32_MAX;
+
+		struct Slot
+		{
+			uint32_t denseIndex = c_emptySlot;
+			uint32_t generation = 0;
+		};
+
+		std::vector<Slot> slots;
+		// Dense arrays
+		std::vector<T> values;
+		std::vector<InstanceHandle> handles;
+
+		T eraseDense(uint32_t removed)
+		{
+			T value = std::move(values[removed]);
+			slots[handles[removed].index].denseIndex = c_emptySlot;
+
+			uint32_t last = static_cast<uint32_t>(values.size() - 1);
+			if (removed != last)
+			{
+				values[removed] = std::move(values[last]);
+				handles[removed] = handles[last];
+				slots[handles[removed].index].denseIndex = removed;
+			}
+			values.pop_back();
+			handles.pop_back();
+			return value;
+		}
+	};
+}
\ No newline at end of file
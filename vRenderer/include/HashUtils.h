@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/*
+	Fast non-cryptographic hashing used for asset content identification.
+	Implements the XXH64 algorithm (https://github.com/Cyan4973/xxHash).
+*/
+
+namespace HashUtils
+{
+	using Hash64 = uint64_t;
+
+	static constexpr uint64_t XXH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+	static constexpr uint64_t XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+	static constexpr uint64_t XXH_PRIME64_3 = 0x165667B19E3779F9ULL;
+	static constexpr uint64_t XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+	static constexpr uint64_t XXH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+	static inline uint64_t rotl64(uint64_t x, int r)
+	{
+		return (x << r) | (x >> (64 - r));
+	}
+
+	static inline uint64_t read64(const uint8_t* p)
+	{
+		uint64_t v;
+		memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	static inline uint32_t read32(const uint8_t* p)
+	{
+		uint32_t v;
+		memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	static inline uint64_t xxh64Round(uint64_t acc, uint64_t input)
+	{
+		acc += input * XXH_PRIME64_2;
+		acc = rotl64(acc, 31);
+		acc *= XXH_PRIME64_1;
+		return acc;
+	}
+
+	static inline uint64_t xxh64MergeRound(uint64_t acc, uint64_t val)
+	{
+		val = xxh64Round(0, val);
+		acc ^= val;
+		acc = acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+		return acc;
+	}
+
+	/// <summary>
+	/// Computes XXH64 hash of a memory block.
+	/// </summary>
+	static Hash64 xxh64(const void* data, size_t size, uint64_t seed = 0)
+	{
+		const uint8_t* p = static_cast<const uint8_t*>(data);
+		const uint8_t* const end = p + size;
+		uint64_t h;
+
+		if (size >= 32)
+		{
+			const uint8_t* const limit = end - 32;
+			uint64_t v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+			uint64_t v2 = seed + XXH_PRIME64_2;
+			uint64_t v3 = seed;
+			uint64_t v4 = seed - XXH_PRIME64_1;
+
+			do
+			{
+				v1 = xxh64Round(v1, read64(p));		p += 8;
+				v2 = xxh64Round(v2, read64(p));		p += 8;
+				v3 = xxh64Round(v3, read64(p));		p += 8;
+				v4 = xxh64Round(v4, read64(p));		p += 8;
+			} while (p <= limit);
+
+			h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+			h = xxh64MergeRound(h, v1);
+			h = xxh64MergeRound(h, v2);
+			h = xxh64MergeRound(h, v3);
+			h = xxh64MergeRound(h, v4);
+		}
+		else
+		{
+			h = seed + XXH_PRIME64_5;
+		}
+
+		h += static_cast<uint64_t>(size);
+
+		while (p + 8 <= end)
+		{
+			h ^= xxh64Round(0, read64(p));
+			h = rotl64(h, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+			p += 8;
+		}
+		if (p + 4 <= end)
+		{
+			h ^= static_cast<uint64_t>(read32(p)) * XXH_PRIME64_1;
+			h = rotl64(h, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+			p += 4;
+		}
+		while (p < end)
+		{
+			h ^= (*p) * XXH_PRIME64_5;
+			h = rotl64(h, 11) * XXH_PRIME64_1;
+			p++;
+		}
+
+		// Final avalanche
+		h ^= h >> 33;
+		h *= XXH_PRIME64_2;
+		h ^= h >> 29;
+		h *= XXH_PRIME64_3;
+		h ^= h >> 32;
+
+		return h;
+	}
+
+	/// <summary>
+	/// Hashes contiguous data of a vector and chains it with provided seed.
+	/// </summary>
+	template<typename T>
+	static Hash64 xxh64(const std::vector<T>& data, uint64_t seed = 0)
+	{
+		return xxh64(data.data(), data.size() * sizeof(T), seed);
+	}
+}
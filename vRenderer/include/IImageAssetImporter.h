@@ -1,16 +1,30 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <filesystem>
 
 #include "Texture.h"
+#include "ImportSettings.h"
+#include "AsyncTask.h"
 
 const std::vector<std::string> c_supportedExtensions = { ".jpg", ".png" };
 const std::vector<std::string> c_cubemapFaces = { "back", "front", "top", "bottom", "left", "right"};
 
+struct TextureImportRequest
+{
+	std::filesystem::path path;
+	TextureRole role = TextureRole::OTHER;
+};
+
+// Imports await their file reads and resume on a worker, where decoding is done
 class IImageAssetImporter
 {
 public:
-	virtual std::shared_ptr<Texture> importTexture(std::filesystem::path textureFilePath, bool printImportData) = 0;
-	virtual std::shared_ptr<Cubemap> importCubemap(std::filesystem::path cubemapFolderPath, bool printImportData) = 0;
+	virtual AsyncTask<std::shared_ptr<Texture>> importTexture(std::filesystem::path textureFilePath, TextureRole role, bool printImportData) = 0;
+	virtual AsyncTask<std::vector<std::shared_ptr<Texture>>> importTextures(std::vector<TextureImportRequest> requests, bool printImportData) = 0;
+	virtual AsyncTask<std::shared_ptr<Cubemap>> importCubemap(std::filesystem::path cubemapFolderPath, bool printImportData) = 0;
+
+	// Resolution budget applied to textures imported after the call.
+	virtual void setImportSettings(const ImportSettings& settings) = 0;
 };
\ No newline at end of file
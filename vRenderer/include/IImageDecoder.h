@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "Texture.h"
+
+/*
+	Decoder of a single encoded image (file contents in memory) into RGBA8 pixels.
+	Decoders are used concurrently from several threads, so decode() must be thread safe.
+*/
+
+class IImageDecoder
+{
+public:
+	virtual ~IImageDecoder() = default;
+
+	virtual const char* getName() const = 0;
+
+	// Fills outTexture's ptr (allocated with malloc, as Texture releases it with free), width, height and size.
+	// Returns false if data can't be decoded by this decoder.
+	virtual bool decode(const uint8_t* data, size_t size, Texture& outTexture) const = 0;
+};
\ No newline at end of file
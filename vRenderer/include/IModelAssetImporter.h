@@ -9,5 +9,6 @@
 class IModelAssetImporter
 {
 public:
-	virtual std::shared_ptr<Model> importModel(std::filesystem::path modelFilePath, IImageAssetImporter& imageImporter, bool printImportData) = 0;
+	// Image importer has to outlive the import
+	virtual AsyncTask<std::shared_ptr<Model>> importModel(std::filesystem::path modelFilePath, IImageAssetImporter& imageImporter, bool printImportData) = 0;
 };
\ No newline at end of file
@@ -3,10 +3,12 @@
 #include <GLFW/glfw3.h>
 #include <functional>
 #include <memory>
+#include <span>
 
 #include "RenderSettings.h"
 #include "Lighting.h"
 #include "ModelInstance.h"
+#include "SceneChangeJournal.h"
 #include "BaseCamera.h"
 
 using namespace VRD::Scene;
@@ -23,12 +25,33 @@ public:
 	virtual void setImguiCallback(std::function<void()> callback) = 0;
 
 	virtual void draw() = 0;
-	virtual bool updateModelTransform(int modelId, glm::mat4 newTransform) = 0;
+
+	// Models are keyed by the handle of their scene instance, see ModelInstance.
+	// Batch operations let backends allocate and upload once per batch, they return the number of affected models.
+	virtual size_t addModelsToRenderer(std::span<const ModelInstance> models) = 0;
+	// Normal matrices are inverse transposes of the transforms, computed by the caller in batch with them.
+	// Matrices are parallel to handles.
+	virtual size_t updateModelTransforms(std::span<const InstanceHandle> handles,
+		std::span<const glm::mat4> transforms, std::span<const glm::mat4> normalMatrices) = 0;
+	virtual size_t removeModelsFromRenderer(std::span<const InstanceHandle> handles) = 0;
+
+	bool addToRendererTextured(const ModelInstance& model)
+	{
+		return addModelsToRenderer({ &model, 1 }) == 1;
+	}
+	bool updateModelTransform(InstanceHandle handle, const glm::mat4& newTransform, const glm::mat4& normalMatrix)
+	{
+		return updateModelTransforms({ &handle, 1 }, { &newTransform, 1 }, { &normalMatrix, 1 }) == 1;
+	}
+	bool removeFromRenderer(InstanceHandle handle)
+	{
+		return removeModelsFromRenderer({ &handle, 1 }) == 1;
+	}
 
 	virtual bool addToRenderer(const Model& model, glm::vec3 color) = 0;
-	virtual bool addToRendererTextured(const ModelInstance& model) = 0;
-	virtual bool removeFromRenderer(int modelId) = 0;
-	virtual bool isModelInRenderer(uint32_t id) = 0;
+	virtual bool isModelInRenderer(InstanceHandle handle) = 0;
+	// Applies scene changes recorded since the previous frame in bulk, see SceneChangeJournal for the order
+	virtual void applySceneChanges(const SceneChangeJournal& changes) = 0;
 
 	virtual void bindRenderSettings(const std::shared_ptr<RenderSettings> renderSettings) = 0;
 	virtual void setCamera(const std::shared_ptr<BaseCamera> camera) = 0;
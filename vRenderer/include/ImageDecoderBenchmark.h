@@ -0,0 +1,14 @@
+#pragma once
+
+#include "ImageDecoderRegistry.h"
+
+/*
+	Measures decode throughput of every available image decoder per image format on a folder of images.
+	Run the application with "--bench-decoders [folder] [--iterations N]". Assets folder is used by default.
+*/
+
+class ImageDecoderBenchmark
+{
+public:
+	static int runFromCommandLine(int argc, char* argv[]);
+};
\ No newline at end of file
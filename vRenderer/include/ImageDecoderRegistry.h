@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <memory>
+
+#include "IImageDecoder.h"
+
+enum class ImageFormat
+{
+	JPEG,
+	PNG,
+	OTHER,
+	COUNT
+};
+
+/// <summary>
+/// Picks an image decoder for encoded data by its format.
+/// Decoders registered for a format are tried in order of registration and stb_image is used if none of them succeeds.
+/// Fastest available backends are registered by default.
+/// </summary>
+class ImageDecoderRegistry
+{
+public:
+
+	ImageDecoderRegistry();
+
+	void registerDecoder(ImageFormat format, std::shared_ptr<IImageDecoder> decoder);
+
+	bool decode(const uint8_t* data, size_t size, Texture& outTexture) const;
+
+	const std::vector<std::shared_ptr<IImageDecoder>>& getDecoders(ImageFormat format) const;
+	const IImageDecoder& getFallbackDecoder() const;
+
+	static ImageFormat detectFormat(const uint8_t* data, size_t size);
+	static const char* getFormatName(ImageFormat format);
+
+private:
+
+	std::array<std::vector<std::shared_ptr<IImageDecoder>>, static_cast<size_t>(ImageFormat::COUNT)> decoders;
+	std::shared_ptr<IImageDecoder> fallbackDecoder;
+};
\ No newline at end of file
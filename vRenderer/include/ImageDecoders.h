@@ -0,0 +1,59 @@
+#pragma once
+
+#include "IImageDecoder.h"
+
+/*
+	Available image decoder backends.
+	stb_image is always available and serves as the fallback for every format.
+	Faster backends are compiled in when the build provides the corresponding library:
+	- VRD_WITH_TURBOJPEG - libjpeg-turbo (SIMD accelerated JPEG)
+	- VRD_WITH_SPNG - libspng (fast PNG)
+	Both are enabled through ImageDecoders.props next to the project file.
+*/
+
+struct OptionalImageDecoder
+{
+	const char* name;
+	const char* define;
+	bool compiledIn;
+};
+
+// Optional backends and whether this build includes them
+inline constexpr OptionalImageDecoder c_optionalImageDecoders[] =
+{
+#ifdef VRD_WITH_TURBOJPEG
+	{ "libjpeg-turbo", "VRD_WITH_TURBOJPEG", true },
+#else
+	{ "libjpeg-turbo", "VRD_WITH_TURBOJPEG", false },
+#endif
+#ifdef VRD_WITH_SPNG
+	{ "libspng", "VRD_WITH_SPNG", true },
+#else
+	{ "libspng", "VRD_WITH_SPNG", false },
+#endif
+};
+
+class StbImageDecoder : public IImageDecoder
+{
+public:
+	const char* getName() const override { return "stb_image"; }
+	bool decode(const uint8_t* data, size_t size, Texture& outTexture) const override;
+};
+
+#ifdef VRD_WITH_TURBOJPEG
+class TurboJpegDecoder : public IImageDecoder
+{
+public:
+	const char* getName() const override { return "libjpeg-turbo"; }
+	bool decode(const uint8_t* data, size_t size, Texture& outTexture) const override;
+};
+#endif
+
+#ifdef VRD_WITH_SPNG
+class SpngDecoder : public IImageDecoder
+{
+public:
+	const char* getName() const override { return "libspng"; }
+	bool decode(const uint8_t* data, size_t size, Texture& outTexture) const override;
+};
+#endif
\ No newline at end of file
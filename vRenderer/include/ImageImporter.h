@@ -0,0 +1,39 @@
+#pragma once
+
+#include <unordered_map>
+#include <mutex>
+#include <iostream>
+
+#include "IImageAssetImporter.h"
+#include "AsyncFileReader.h"
+#include "ImageDecoderRegistry.h"
+
+class ImageImporter : public IImageAssetImporter
+{
+public:
+	AsyncTask<std::shared_ptr<Texture>> importTexture(std::filesystem::path textureFilePath, TextureRole role, bool printImportData) override;
+	AsyncTask<std::vector<std::shared_ptr<Texture>>> importTextures(std::vector<TextureImportRequest> requests, bool printImportData) override;
+	AsyncTask<std::shared_ptr<Cubemap>> importCubemap(std::filesystem::path cubemapFolderPath, bool printImportData) override;
+
+	void setImportSettings(const ImportSettings& settings) override;
+
+private:
+	// Imported textures and cubemaps are keyed by path and the size limit they were imported with,
+	// so the same image used in roles with different budgets is imported once per budget.
+	std::unordered_map<std::string, std::shared_ptr<Texture>> importedTexturesMap;
+	std::unordered_map<std::string, std::shared_ptr<Cubemap>> importedCubemapsMap;
+	// Imported textures keyed by content hash. Used to share identical images stored under different paths.
+	std::unordered_map<uint64_t, std::shared_ptr<Texture>> importedTexturesByHash;
+	std::mutex cacheMutex;
+
+	ImportSettings importSettings;
+
+	ImageDecoderRegistry decoderRegistry;
+
+	uint32_t getMaxTextureSize(TextureRole role);
+	static std::string getCacheKey(const std::filesystem::path& filePath, uint32_t maxSize);
+
+	std::shared_ptr<Texture> getImportedTexture(const std::filesystem::path& textureFilePath, uint32_t maxSize);
+	std::shared_ptr<Texture> registerTexture(const std::filesystem::path& textureFilePath, uint32_t maxSize, std::shared_ptr<Texture> texture, bool printImportData);
+	void decodeTexture(const FileData& fileData, const std::filesystem::path& textureFilePath, uint32_t maxSize, Texture& outTexture);
+};
\ No newline at end of file
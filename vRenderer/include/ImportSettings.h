@@ -0,0 +1,49 @@
+#pragma once
+
+#include "json.hpp"
+#include <cstdint>
+
+// Role of a texture in material. Determines which resolution budget applies to it on import.
+enum class TextureRole
+{
+    DIFFUSE,
+    SPECULAR,
+    AMBIENT,
+    OPACITY,
+    EMISSION,
+    NORMAL,
+    CUBEMAP,
+    OTHER
+};
+
+struct ImportSettings
+{
+    // Maximum width and height of imported textures per role.
+    // Larger textures are downscaled on import to fit. 0 means no limit.
+    uint32_t maxDiffuseSize = 4096;
+    uint32_t maxSpecularSize = 2048;
+    uint32_t maxAmbientSize = 2048;
+    uint32_t maxOpacitySize = 2048;
+    uint32_t maxEmissionSize = 2048;
+    uint32_t maxNormalSize = 4096;
+    uint32_t maxCubemapFaceSize = 4096;
+    uint32_t maxOtherSize = 4096;
+
+    uint32_t getMaxTextureSize(TextureRole role) const
+    {
+        switch (role)
+        {
+        case TextureRole::DIFFUSE: return maxDiffuseSize;
+        case TextureRole::SPECULAR: return maxSpecularSize;
+        case TextureRole::AMBIENT: return maxAmbientSize;
+        case TextureRole::OPACITY: return maxOpacitySize;
+        case TextureRole::EMISSION: return maxEmissionSize;
+        case TextureRole::NORMAL: return maxNormalSize;
+        case TextureRole::CUBEMAP: return maxCubemapFaceSize;
+        default: return maxOtherSize;
+        }
+    }
+
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE(ImportSettings, maxDiffuseSize, maxSpecularSize, maxAmbientSize, maxOpacitySize,
+        maxEmissionSize, maxNormalSize, maxCubemapFaceSize, maxOtherSize);
+};
\ No newline at end of file
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <new>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+/// <summary>
+/// Move-only void() callable stored in a fixed inline buffer.
+/// Unlike std::function it never allocates for callables that fit into Capacity bytes,
+/// larger ones are moved to the heap and only a pointer to them is stored inline.
+/// </summary>
+template<size_t Capacity>
+class InplaceFunction
+{
+	static_assert(Capacity >= sizeof(void*), "InplaceFunction capacity must fit at least a pointer.");
+
+public:
+
+	InplaceFunction() = default;
+
+	template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InplaceFunction>>>
+	InplaceFunction(F&& function)
+	{
+		using Callable = std::decay_t<F>;
+		if constexpr (fitsInline<Callable>())
+		{
+			new (storage) Callable(std::forward<F>(function));
+			ops = &InlineOps<Callable>::ops;
+		}
+		else
+		{
+			new (storage) Callable*(new Callable(std::forward<F>(function)));
+			ops = &HeapOps<Callable>::ops;
+		}
+	}
+
+	InplaceFunction(InplaceFunction&& other) noexcept
+	{
+		moveFrom(other);
+	}
+
+	InplaceFunction& operator=(InplaceFunction&& other) noexcept
+	{
+		if (this != &other)
+		{
+			reset();
+			moveFrom(other);
+		}
+		return *this;
+	}
+
+	InplaceFunction(const InplaceFunction&) = delete;
+	InplaceFunction& operator=(const InplaceFunction&) = delete;
+
+	~InplaceFunction()
+	{
+		reset();
+	}
+
+	void operator()()
+	{
+		ops->invoke(storage);
+	}
+
+	explicit operator bool() const
+	{
+		return ops != nullptr;
+	}
+
+	void reset()
+	{
+		if (ops != nullptr)
+		{
+			ops->destroy(storage);
+			ops = nullptr;
+		}
+	}
+
+	// True if callable of type F is stored without a heap allocation
+	template<typename F>
+	static constexpr bool fitsInline()
+	{
+		return sizeof(F) <= Capacity && alignof(F) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<F>;
+	}
+
+private:
+
+	struct Ops
+	{
+		void (*invoke)(void* storage);
+		void (*move)(void* dst, void* src);
+		void (*destroy)(void* storage);
+	};
+
+	template<typename F>
+	struct InlineOps
+	{
+		static void invoke(void* storage) { (*static_cast<F*>(storage))(); }
+		static void move(void* dst, void* src)
+		{
+			new (dst) F(std::move(*static_cast<F*>(src)));
+			static_cast<F*>(src)->~F();
+		}
+		static void destroy(void* storage) { static_cast<F*>(storage)->~F(); }
+
+		static constexpr Ops ops = { &invoke, &move, &destroy };
+	};
+
+	template<typename F>
+	struct HeapOps
+	{
+		static void invoke(void* storage) { (**static_cast<F**>(storage))(); }
+		static void move(void* dst, void* src) { *static_cast<F**>(dst) = *static_cast<F**>(src); }
+		static void destroy(void* storage) { delete *static_cast<F**>(storage); }
+
+		static constexpr Ops ops = { &invoke, &move, &destroy };
+	};
+
+	alignas(std::max_align_t) unsigned char storage[Capacity];
+	const Ops* ops = nullptr;
+
+	void moveFrom(InplaceFunction& other)
+	{
+		if (other.ops != nullptr)
+		{
+			other.ops->move(storage, other.storage);
+			ops = other.ops;
+			other.ops = nullptr;
+		}
+	}
+};
\ No newline at end of file
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/*
+	Minimal implementation of the LZ4 block format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md).
+	Used for per-chunk compression of asset bundles. Output is compatible with the reference LZ4_decompress_safe.
+*/
+
+namespace Lz4
+{
+	static constexpr int MIN_MATCH = 4;
+	static constexpr int LAST_LITERALS = 5;		// last 5 bytes of a block are always literals
+	static constexpr int MF_LIMIT = 12;			// last match must start at least 12 bytes before the end of a block
+	static constexpr int MAX_DISTANCE = 65535;
+	static constexpr int HASH_LOG = 16;
+	static constexpr int SKIP_TRIGGER = 6;		// search step grows each 2^SKIP_TRIGGER misses on incompressible data
+
+	static inline uint32_t read32(const uint8_t* p)
+	{
+		uint32_t v;
+		memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	static inline uint32_t hash(uint32_t sequence)
+	{
+		return (sequence * 2654435761U) >> (32 - HASH_LOG);
+	}
+
+	/// <summary>
+	/// Maximum size compressed data may take for a given input size.
+	/// </summary>
+	static size_t compressBound(size_t srcSize)
+	{
+		return srcSize + srcSize / 255 + 16;
+	}
+
+	static inline uint8_t* writeLength(uint8_t* op, size_t length)
+	{
+		while (length >= 255)
+		{
+			*op++ = 255;
+			length -= 255;
+		}
+		*op++ = static_cast<uint8_t>(length);
+		return op;
+	}
+
+	/// <summary>
+	/// Compresses a block of data. Returns compressed size or 0 if output doesn't fit into dstCapacity.
+	/// </summary>
+	static size_t compress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity)
+	{
+		if (dstCapacity < compressBound(srcSize))
+		{
+			return 0;
+		}
+
+		const uint8_t* ip = src;
+		const uint8_t* anchor = src;
+		const uint8_t* const end = src + srcSize;
+		uint8_t* op = dst;
+
+		if (srcSize > MF_LIMIT)
+		{
+			const uint8_t* const matchLimit = end - LAST_LITERALS;
+			const uint8_t* const mfLimit = end - MF_LIMIT;
+
+			std::vector<uint32_t> table(1 << HASH_LOG, UINT32_MAX);
+			uint32_t searchCount = 1 << SKIP_TRIGGER;
+
+			while (ip < mfLimit)
+			{
+				uint32_t sequence = read32(ip);
+				uint32_t h = hash(sequence);
+				uint32_t refPos = table[h];
+				table[h] = static_cast<uint32_t>(ip - src);
+
+				const uint8_t* ref = src + refPos;
+				if (refPos == UINT32_MAX || ip - ref > MAX_DISTANCE || read32(ref) != sequence)
+				{
+					ip += searchCount++ >> SKIP_TRIGGER;
+					continue;
+				}
+				searchCount = 1 << SKIP_TRIGGER;
+
+				// Extend match backwards over pending literals
+				while (ip > anchor && ref > src && ip[-1] == ref[-1])
+				{
+					ip--;
+					ref--;
+				}
+
+				// Extend match forward
+				const uint8_t* matchEnd = ip + MIN_MATCH;
+				const uint8_t* refEnd = ref + MIN_MATCH;
+				while (matchEnd < matchLimit && *matchEnd == *refEnd)
+				{
+					matchEnd++;
+					refEnd++;
+				}
+
+				size_t literalLength = ip - anchor;
+				size_t matchLength = matchEnd - ip - MIN_MATCH;
+
+				uint8_t* token = op++;
+				*token = static_cast<uint8_t>((literalLength >= 15 ? 15 : literalLength) << 4);
+				if (literalLength >= 15)
+				{
+					op = writeLength(op, literalLength - 15);
+				}
+				memcpy(op, anchor, literalLength);
+				op += literalLength;
+
+				uint16_t offset = static_cast<uint16_t>(ip - ref);
+				*op++ = static_cast<uint8_t>(offset & 0xFF);
+				*op++ = static_cast<uint8_t>(offset >> 8);
+
+				*token |= static_cast<uint8_t>(matchLength >= 15 ? 15 : matchLength);
+				if (matchLength >= 15)
+				{
+					op = writeLength(op, matchLength - 15);
+				}
+
+				ip = matchEnd;
+				anchor = ip;
+			}
+		}
+
+		// Last literals
+		size_t literalLength = end - anchor;
+		uint8_t* token = op++;
+		*token = static_cast<uint8_t>((literalLength >= 15 ? 15 : literalLength) << 4);
+		if (literalLength >= 15)
+		{
+			op = writeLength(op, literalLength - 15);
+		}
+		if (literalLength > 0)
+		{
+			memcpy(op, anchor, literalLength);
+			op += literalLength;
+		}
+
+		return op - dst;
+	}
+
+	/// <summary>
+	/// Decompresses a block of data of known decompressed size.
+	/// Returns false if the input is malformed or doesn't decompress to exactly dstSize bytes.
+	/// </summary>
+	static bool decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize)
+	{
+		const uint8_t* ip = src;
+		const uint8_t* const iend = src + srcSize;
+		uint8_t* op = dst;
+		uint8_t* const oend = dst + dstSize;
+
+		auto readLength = [&](size_t& length) {
+			uint8_t s;
+			do
+			{
+				if (ip >= iend) return false;
+				s = *ip++;
+				length += s;
+			} while (s == 255);
+			return true;
+		};
+
+		while (ip < iend)
+		{
+			uint8_t token = *ip++;
+
+			size_t literalLength = token >> 4;
+			if (literalLength == 15 && !readLength(literalLength))
+			{
+				return false;
+			}
+			if (literalLength > static_cast<size_t>(iend - ip) || literalLength > static_cast<size_t>(oend - op))
+			{
+				return false;
+			}
+			if (literalLength > 0)	// empty blocks may come with null buffers
+			{
+				memcpy(op, ip, literalLength);
+				ip += literalLength;
+				op += literalLength;
+			}
+
+			// Last sequence has no match part
+			if (ip == iend)
+			{
+				break;
+			}
+
+			if (iend - ip < 2)
+			{
+				return false;
+			}
+			size_t offset = ip[0] | (ip[1] << 8);
+			ip += 2;
+			if (offset == 0 || offset > static_cast<size_t>(op - dst))
+			{
+				return false;
+			}
+
+			size_t matchLength = token & 15;
+			if (matchLength == 15 && !readLength(matchLength))
+			{
+				return false;
+			}
+			matchLength += MIN_MATCH;
+			if (matchLength > static_cast<size_t>(oend - op))
+			{
+				return false;
+			}
+
+			// Match may overlap with the output it's copied to, so copy byte by byte in that case
+			const uint8_t* match = op - offset;
+			if (offset >= matchLength)
+			{
+				memcpy(op, match, matchLength);
+				op += matchLength;
+			}
+			else
+			{
+				for (size_t i = 0; i < matchLength; i++)
+				{
+					*op++ = *match++;
+				}
+			}
+		}
+
+		return op == oend;
+	}
+}
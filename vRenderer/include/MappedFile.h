@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+/*
+	Read-only memory mapping of a file. Pages are loaded by the OS on first access,
+	so random access into large files doesn't require reading them as a whole.
+*/
+
+class MappedFile
+{
+public:
+
+	MappedFile(const std::filesystem::path& filePath);
+	~MappedFile();
+
+	MappedFile(const MappedFile& other) = delete;
+	MappedFile& operator=(const MappedFile& other) = delete;
+
+	const uint8_t* data() const { return mappedData; }
+	size_t size() const { return mappedSize; }
+
+private:
+
+	const uint8_t* mappedData = nullptr;
+	size_t mappedSize = 0;
+
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#else
+	int fileDescriptor = -1;
+#endif
+};
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <string>
 #include <glm/glm.hpp>
 
+#include "Bounds.h"
+
 /*
 	Generic class of a mesh from imported model
 */
@@ -23,9 +25,22 @@ public:
 	const std::vector<glm::vec3>& getNormals() const;
 	const std::vector<uint32_t>& getIndices() const;
 
+	// Hash of geometry data. Meshes with equal hashes are considered identical.
+	uint64_t getContentHash() const;
+
+	// Bounds in model space, computed from vertices on construction
+	const BoundingBox& getBoundingBox() const;
+	const BoundingSphere& getBoundingSphere() const;
+
 private:
 	std::vector<glm::vec3> vertices;
 	std::vector<glm::vec3> normals;
 	std::vector<glm::vec2> texCoords;
 	std::vector<uint32_t> indices;
+
+	uint64_t contentHash;
+	BoundingBox boundingBox;
+	BoundingSphere boundingSphere;
+
+	void computeBounds();
 };
\ No newline at end of file
@@ -18,25 +18,31 @@ class Model : public ISceneInstanceTemplate
 {
 public:
 	//const std::string folderPath;
-	const std::string name;
 
-	Model(uint32_t id, std::string name, std::vector<std::unique_ptr<Mesh>>&& meshes, std::vector<std::unique_ptr<Material>>&& materials, uint32_t materialCount);
+	Model(uint32_t id, std::string name, std::vector<std::shared_ptr<Mesh>>&& meshes, std::vector<std::unique_ptr<Material>>&& materials, uint32_t materialCount);
 	virtual ~Model() = default;
 
 	uint32_t getMeshCount() const;
 	uint32_t getMaterialCount() const;
 	std::string getName();
 
-	const std::vector<std::unique_ptr<Mesh>>& getMeshes() const;
+	const std::vector<std::shared_ptr<Mesh>>& getMeshes() const;
 	const std::vector<std::unique_ptr<Material>>& getMaterials() const;
 
+	// Bounds of all meshes in model space
+	const BoundingBox& getBoundingBox() const;
+	const BoundingSphere& getBoundingSphere() const;
+
 private:
 
 	uint32_t meshCount;
 	uint32_t materialCount;
 
-	// Meshes of this model
-	std::vector<std::unique_ptr<Mesh>> meshes;
+	// Meshes of this model. Shared since identical meshes are deduplicated across models on import.
+	std::vector<std::shared_ptr<Mesh>> meshes;
 	// Materials names applied to meshes of this model. Has a 1:1 relation to meshes std::vector.
 	std::vector<std::unique_ptr<Material>> materials;
+
+	BoundingBox boundingBox;
+	BoundingSphere boundingSphere;
 };
\ No newline at end of file
@@ -1,45 +1,34 @@
 #pragma once
 
 #include <memory>
+#include <cstdint>
 
 #include "Model.h"
-#include "SceneGraphInstance.h"
-#include "ITemplateInstance.h"
+#include "HandleTable.h"
 
 namespace VRD::Scene
 {
-	class ModelInstance : public SceneGraphInstance, public ITemplateInstance<Model>
+	/// <summary>
+	/// Model placed into the scene, as seen by renderers. Transform is passed separately.
+	/// </summary>
+	class ModelInstance
 	{
 	public:
 
-		ModelInstance(uint32_t id, std::string printName) : SceneGraphInstance(id, printName) {}
-		ModelInstance(uint32_t id, std::string printName, const ModelInstance& other) :
-			SceneGraphInstance(id, printName, dynamic_cast<const SceneGraphInstance&>(other))
-		{
-			modelTemplate = other.modelTemplate;
-		}
-		virtual ~ModelInstance() {}
+		const uint32_t id;
+		// Key of the instance in renderer tables
+		const InstanceHandle handle;
 
-		ModelInstance(const ModelInstance& other) = delete;
-		ModelInstance& operator=(const ModelInstance& other) = delete;
-
-		virtual ModelInstance* clone(uint32_t id, std::string printName) const
-		{
-			return new ModelInstance(id, printName, *this);
-		}
+		ModelInstance(uint32_t id, InstanceHandle handle, std::shared_ptr<const Model> modelTemplate)
+			: id(id), handle(handle), modelTemplate(std::move(modelTemplate)) {}
 
 		const Model& getTemplate() const
 		{
 			return *modelTemplate;
 		}
 
-		void createFromTemplate(const Model& templObj) override
-		{
-			modelTemplate.reset(&templObj);
-		}
-
 	private:
 
-		std::shared_ptr<const Model> modelTemplate = nullptr;
+		std::shared_ptr<const Model> modelTemplate;
 	};
 }
\ No newline at end of file
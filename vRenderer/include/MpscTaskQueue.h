@@ -0,0 +1,114 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+#include "InplaceFunction.h"
+
+/*
+	Task queue with many producer threads and a single consumer thread.
+
+	Tasks are stored in a bounded lock-free ring (Vyukov's bounded queue, with a single consumer), each slot holding
+	the callable inline, so pushing a small task neither locks nor allocates. If the ring is full, tasks go to
+	a mutex protected overflow list, whose storage is reused between flushes. Until overflow is flushed new tasks go
+	there as well, and it is only flushed once the ring is empty, which keeps tasks of each producer in submission order.
+	Overflow is only taken at the start of process(), so tasks overflowing meanwhile wait for the next call like any other.
+
+	Every task is stamped when pushed, so the consumer can track how long tasks wait in the queue.
+*/
+
+class MpscTaskQueue
+{
+public:
+
+	// Sized so that a ring slot fits into a single cache line
+	using Task = InplaceFunction<40>;
+	using Clock = std::chrono::steady_clock;
+
+	struct Stats
+	{
+		uint64_t processedCount = 0;
+		// Pushes that didn't fit into the ring since creation
+		uint64_t overflowPushCount = 0;
+		// Tasks waiting in the queue at the end of the last process() call
+		size_t pendingCount = 0;
+		// Calls that found tasks but were reached with the deadline already passed, so only the guaranteed minimum was run
+		uint64_t starvedCallCount = 0;
+		// Time spent in the queue by tasks run during the last process() call
+		float maxAgeMs = 0.0f;
+		// Exponential moving average of time spent in the queue by all run tasks
+		float averageAgeMs = 0.0f;
+	};
+
+	// Capacity of the ring is rounded up to a power of two
+	MpscTaskQueue(size_t capacity = 1024);
+
+	MpscTaskQueue(const MpscTaskQueue&) = delete;
+	MpscTaskQueue& operator=(const MpscTaskQueue&) = delete;
+
+	// May be called from any thread
+	template<typename Callable>
+	void push(Callable&& callable);
+
+	// Runs tasks pushed before the call in FIFO order until deadline is passed, but at least minTaskCount of them
+	// if there are that many. Tasks that are not run, as well as tasks pushed meanwhile (including by the tasks
+	// being run), are left for the next call. Must only be called from the consumer thread. Returns number of tasks run.
+	size_t process(Clock::time_point deadline = Clock::time_point::max(), size_t minTaskCount = 0);
+
+	// Must only be called from the consumer thread
+	const Stats& getStats() const;
+
+private:
+
+	struct alignas(64) Slot
+	{
+		std::atomic<size_t> sequence;
+		Clock::time_point pushTime;
+		Task task;
+	};
+
+	struct OverflowTask
+	{
+		Task task;
+		Clock::time_point pushTime;
+	};
+
+	std::unique_ptr<Slot[]> slots;
+	size_t mask;
+
+	alignas(64) std::atomic<size_t> enqueuePosition = 0;
+	// Only touched by the consumer
+	alignas(64) size_t dequeuePosition = 0;
+
+	std::mutex overflowMutex;
+	std::vector<OverflowTask> overflow;
+	// Overflow storage swapped with the one above on every flush, so its capacity is kept.
+	// If deadline is reached while running it, the rest is run on the next call before anything from the ring.
+	std::vector<OverflowTask> overflowSpare;
+	size_t overflowSpareIndex = 0;
+	std::atomic<bool> overflowActive = false;
+	std::atomic<uint64_t> overflowPushCount = 0;
+
+	Stats stats;
+
+	bool tryPushToRing(Task& task, Clock::time_point pushTime);
+	void pushToOverflow(Task& task, Clock::time_point pushTime);
+	bool tryPop(Task& outTask, Clock::time_point& outPushTime);
+	bool runOverflowSpare(Clock::time_point deadline, size_t minTaskCount, size_t& processedCount);
+	void runTask(Task& task, Clock::time_point pushTime);
+};
+
+template<typename Callable>
+inline void MpscTaskQueue::push(Callable&& callable)
+{
+	Task task(std::forward<Callable>(callable));
+	Clock::time_point pushTime = Clock::now();
+	if (overflowActive.load(std::memory_order_acquire) || !tryPushToRing(task, pushTime))
+	{
+		pushToOverflow(task, pushTime);
+	}
+}
\ No newline at end of file
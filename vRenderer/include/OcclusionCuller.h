@@ -0,0 +1,113 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
+#include "Bounds.h"
+#include "Mesh.h"
+
+/*
+	Occlusion of bounding spheres by large meshes in front of them, computed entirely on the CPU.
+	Meshes covering a large part of the screen are rasterized as occluders into a low resolution depth buffer,
+	4 pixels at a time with SSE2 where available and in parallel horizontal bands. Depth buffer is reduced to
+	the farthest depth of each 8x8 tile, spheres whose nearest point is behind all tiles they cover are occluded.
+
+	Depth is stored as 1/w, which is linear in screen space, so larger values are nearer and cleared buffer is 0.
+	Occluders are only ever under-estimated (triangles are clipped, meshes over the triangle budget are skipped),
+	and coverage is conservative: pixels are written at their farthest depth, and edges that may have empty space
+	behind them on screen (mesh borders, silhouettes, near plane cuts) are moved half a pixel inwards, so pixels
+	there are written only if fully covered. Anything seen through a gap, however narrow, stays visible.
+	Edges between adjacent triangles continuing the surface are sampled at pixel centers, which leaves no cracks.
+*/
+
+class OcclusionCuller
+{
+public:
+
+	static constexpr int c_tileSize = 8;
+
+	// Dimensions are rounded up to a multiple of the tile size
+	OcclusionCuller(int width = 256, int height = 128);
+
+	// Clears depth and occluders for a new frame seen through viewProjection
+	void begin(const glm::mat4& viewProjection);
+	// Queues mesh as an occluder candidate if its world space sphere is large enough on screen.
+	// Mesh has to stay alive until rasterize() returns.
+	void addOccluder(const Mesh& mesh, const glm::mat4& transform, const glm::vec4& worldSphere);
+	// Rasterizes the largest candidates that fit into the triangle budget and builds the tile depth
+	void rasterize();
+
+	// Removes indices of spheres (packed as center, radius) hidden behind occluders from visible, keeping order
+	void cull(const glm::vec4* spheres, std::vector<uint32_t>& visible) const;
+	bool isOccluded(const glm::vec4& sphere) const;
+
+	int getWidth() const { return width; }
+	int getHeight() const { return height; }
+	size_t getOccluderCount() const { return occluderCount; }
+	size_t getTriangleCount() const { return triangleCount; }
+	// Per pixel 1/w of the nearest occluder, 0 where there is none. Rows go from the bottom of the screen.
+	const std::vector<float>& getDepth() const { return depth; }
+
+private:
+
+	struct Occluder
+	{
+		const Mesh* mesh;
+		glm::mat4 transform;
+		float screenSize;
+		const std::vector<uint32_t>* edgeNeighbours;
+	};
+
+	// Screen space triangle set up for rasterization, with x and y in pixels and depth as 1/w
+	struct ScreenTriangle
+	{
+		// Edge functions a * x + b * y + c, non-negative inside
+		float edgeA[3];
+		float edgeB[3];
+		float edgeC[3];
+		// Depth plane depthX * x + depthY * y + depthC
+		float depthX;
+		float depthY;
+		float depthC;
+		// Inclusive pixel range clamped to the screen
+		int minX;
+		int maxX;
+		int minY;
+		int maxY;
+	};
+
+	int width;
+	int height;
+	int tilesX;
+	int tilesY;
+
+	glm::mat4 viewProjection;
+	// w row of viewProjection, distance of a point along the view direction
+	glm::vec4 depthRow;
+	// Sum of absolute x, y and z columns of viewProjection, clip space extent of a unit box
+	glm::vec4 clipExtent;
+
+	std::vector<Occluder> candidates;
+	// Per mesh content hash, for each triangle edge the edge of the other triangle sharing it (triangle * 3 + edge),
+	// or c_noNeighbour for border and non-manifold edges. Edge i goes from vertex i to vertex (i + 1) % 3.
+	std::unordered_map<uint64_t, std::vector<uint32_t>> edgeNeighbours;
+	// Triangles of each rasterized occluder, kept between frames to reuse allocations
+	std::vector<std::vector<ScreenTriangle>> occluderTriangles;
+	size_t occluderCount = 0;
+	size_t triangleCount = 0;
+
+	std::vector<float> depth;
+	// Farthest depth of each tile
+	std::vector<float> tileDepth;
+
+	static std::vector<uint32_t> findEdgeNeighbours(const Mesh& mesh);
+	void setupTriangles(const Occluder& occluder, std::vector<ScreenTriangle>& triangles) const;
+	glm::vec3 toScreen(const glm::vec4& clip) const;
+	// Bit i of conservativeEdges is set to move edge i (ab, bc, ca) half a pixel inwards
+	void addScreenTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, uint32_t conservativeEdges, std::vector<ScreenTriangle>& triangles) const;
+	void rasterizeBand(int firstRow, int lastRow);
+	void rasterizeTriangle(const ScreenTriangle& triangle, int firstRow, int lastRow);
+};
\ No newline at end of file
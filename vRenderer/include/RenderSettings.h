@@ -24,10 +24,20 @@ struct RenderSettings
     bool fpsLimit = true;
     int targetFps = 60;
     bool enableOutline;
+    // Skips models and meshes outside of camera frustum
+    bool enableFrustumCulling = true;
+    // Also skips models hidden behind large meshes, rasterized on the CPU. Applies only with frustum culling.
+    bool enableOcclusionCulling = true;
 
     // Standard gamma value fitting most of displays
     float gammaCorrectionFactor = 2.2f;
 
+    // Time per frame given to tasks dispatched to main thread (e.g. GPU uploads of imported assets). 0 means no limit.
+    float mainThreadBudgetMs = 4.0f;
+
+    // Draws worker pool and main thread queue metrics next to the FPS overlay
+    bool showThreadingMetrics = false;
+
     // Automatically generates to_json/from_json
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE(RenderSettings, api, backgroundColor, fpsLimit, targetFps);
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE(RenderSettings, api, backgroundColor, fpsLimit, targetFps, mainThreadBudgetMs, showThreadingMetrics, enableFrustumCulling, enableOcclusionCulling);
 };
\ No newline at end of file
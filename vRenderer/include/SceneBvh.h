@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+#include <cfloat>
+#include <cstdint>
+
+#include "Bounds.h"
+#include "SceneGraph.h"
+
+namespace VRD::Scene
+{
+	/// <summary>
+	/// Node of SceneBvh with boxes of its 4 children as structure of arrays.
+	/// </summary>
+	struct alignas(16) BvhNode
+	{
+		float minX[4], minY[4], minZ[4];
+		float maxX[4], maxY[4], maxZ[4];
+		// Inner child: index of the node, count is 0. Leaf: first instance, count is the number of instances.
+		// Unused slots have empty boxes and count 0.
+		uint32_t child[4];
+		uint32_t count[4];
+
+		bool isInner(int slot) const { return count[slot] == 0 && child[slot] != UINT32_MAX; }
+		void setBox(int slot, const BoundingBox& box);
+		BoundingBox getBox(int slot) const;
+	};
+
+	/*
+		Bounding volume hierarchy over world space boxes of scene instances.
+		Every node has up to 4 children whose boxes are stored as structure of arrays,
+		so traversal tests all children of a node at once with SSE2.
+		Children are either inner nodes or leaves of up to 4 instances. Nodes are laid out in depth first order,
+		so every child has a higher index than its parent.
+
+		Build (after instances are added or deleted) sorts instances along a Morton curve and halves the sorted ranges.
+		Refit (after transforms change) recomputes boxes of changed instances and of their ancestor nodes only.
+		Queries test instance boxes, not geometry.
+	*/
+	class SceneBvh
+	{
+	public:
+
+		struct RayHit
+		{
+			InstanceHandle instance;
+			// Distance along the ray to the instance box, 0 if ray starts inside of it
+			float distance = FLT_MAX;
+		};
+
+		void build(const SceneGraph& scene);
+		// Updated are instances with a new world matrix, as reported by SceneGraph::updateTransforms
+		void refit(const SceneGraph& scene, const std::vector<InstanceHandle>& updated);
+		void clear();
+
+		// Closest instance box hit by the ray within maxDistance. Direction doesn't have to be normalized,
+		// distance is then measured in direction lengths.
+		bool raycast(const Ray& ray, RayHit& hit, float maxDistance = FLT_MAX) const;
+		// Instances whose boxes intersect the frustum or the box, appended to result
+		void queryFrustum(const Frustum& frustum, std::vector<InstanceHandle>& result) const;
+		void queryBox(const BoundingBox& box, std::vector<InstanceHandle>& result) const;
+		// Instance with the closest box to point within maxDistance, invalid handle if there is none
+		InstanceHandle findNearest(const glm::vec3& point, float maxDistance = FLT_MAX) const;
+
+		size_t getInstanceCount() const { return instances.size(); }
+		size_t getNodeCount() const { return nodes.size(); }
+		// Bounds of the whole scene
+		BoundingBox getBounds() const;
+
+		// Box around local box transformed by an affine matrix
+		static BoundingBox transformBox(const BoundingBox& box, const glm::mat4& matrix);
+
+	private:
+
+		static constexpr uint32_t c_leafSize = 4;
+
+		std::vector<BvhNode> nodes;
+		std::vector<uint32_t> parents;
+		std::vector<uint8_t> dirtyNodes;
+
+		// Instances in leaf order, with their boxes and owning node
+		std::vector<InstanceHandle> instances;
+		std::vector<BoundingBox> boxes;
+		std::vector<uint32_t> owners;
+		// Instance position by handle slot, UINT32_MAX for slots not in the tree
+		std::vector<uint32_t> positions;
+
+		// Instance references being sorted during build, defined in the source file
+		struct BuildState;
+
+		uint32_t buildNode(uint32_t parent, uint32_t first, uint32_t last, BuildState& state);
+		void refitNode(uint32_t nodeIndex);
+	};
+}
\ No newline at end of file
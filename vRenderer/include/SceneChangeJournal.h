@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "HandleTable.h"
+#include "ModelInstance.h"
+
+namespace VRD::Scene
+{
+	/*
+		Changes made to a scene graph since renderers have last seen it, recorded by SceneGraph
+		and consumed by IRenderer::applySceneChanges once per frame.
+		Instances are referred to by handle, renderers keep their models in a HandleTable.
+		Matrices of all transformed instances are stored contiguously, so they can be uploaded at once.
+
+		Entries have to be applied group by group in this order: created, transformed, visibility, destroyed.
+		Instance created and destroyed during the same frame then never outlives the frame,
+		and the same instance may be transformed several times, the last entry wins.
+		Slot of a destroyed instance may be reused by one created later in the same frame,
+		HandleTable::insert then releases the stale entry before its destroyed entry is reached.
+	*/
+	struct SceneChangeJournal
+	{
+		std::vector<ModelInstance> created;
+
+		// World matrices of created instances and of all instances under changed ones, recorded by SceneGraph::updateTransforms
+		std::vector<InstanceHandle> transformed;
+		std::vector<glm::mat4> worldMatrices;
+		std::vector<glm::mat4> normalMatrices;
+
+		std::vector<InstanceHandle> visibilityChanged;
+		std::vector<uint8_t> visible;
+
+		std::vector<InstanceHandle> destroyed;
+
+		bool empty() const
+		{
+			return created.empty() && transformed.empty() && visibilityChanged.empty() && destroyed.empty();
+		}
+
+		// Keeps allocations for the next frame
+		void clear()
+		{
+			created.clear();
+			transformed.clear();
+			worldMatrices.clear();
+			normalMatrices.clear();
+			visibilityChanged.clear();
+			visible.clear();
+			destroyed.clear();
+		}
+	};
+}
\ No newline at end of file
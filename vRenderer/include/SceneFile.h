@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+#include <glm/glm.hpp>
+
+#include "AssetBundle.h"
+#include "SceneGraph.h"
+#include "Lighting.h"
+#include "editor_settings.h"
+
+#define SCENE_FILE "vRenderer\\scene.vrds"
+
+namespace VRD::Scene
+{
+	/// <summary>
+	/// Light source as stored in a scene file. Ids are assigned anew on load.
+	/// </summary>
+	struct SceneLight
+	{
+		uint32_t type;
+		float constant;
+		float linear;
+		float quadratic;
+		glm::vec3 color;
+		glm::vec3 position;
+		glm::vec3 direction;
+		float cutOff;
+		float outerCutOff;
+
+		static SceneLight fromLight(const Light& light);
+		void apply(Light& light) const;
+	};
+
+	struct SceneCamera
+	{
+		uint32_t type = CameraType::ORBIT;
+		int32_t fov = 70;
+		glm::vec3 position = glm::vec3(0.0f);
+		glm::vec3 target = glm::vec3(0.0f);
+	};
+
+	/// <summary>
+	/// Snapshot of a scene detached from the live scene graph, so it can be serialized on another thread.
+	/// Instance attributes are parallel arrays in scene graph dense order.
+	/// </summary>
+	struct SceneData
+	{
+		// Referenced assets by name, as accepted by AssetImporter
+		std::vector<std::string> modelNames;
+		std::string skyboxName;
+
+		// Index into modelNames
+		std::vector<uint32_t> instanceModels;
+		// Index of the parent instance, UINT32_MAX for roots
+		std::vector<uint32_t> instanceParents;
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec3> rotations;
+		std::vector<glm::vec3> scales;
+		std::vector<uint8_t> instanceFlags;
+
+		std::vector<SceneLight> lights;
+		SceneCamera camera;
+
+		// Fills model table and instance arrays from the scene graph
+		void captureInstances(const SceneGraph& scene);
+		size_t getInstanceCount() const { return instanceModels.size(); }
+	};
+
+	/*
+		Binary scene file.
+
+		Layout:
+		[Header][payload]
+
+		Payload holds the model table followed by every instance attribute as one contiguous array,
+		so loading is a handful of bulk copies regardless of instance count. Payload is compressed as a whole
+		with the asset bundle chunk compression. Models are referenced by name and imported on load.
+	*/
+	class SceneFile
+	{
+	public:
+
+		static constexpr char MAGIC[4] = { 'V', 'R', 'D', 'S' };
+		static constexpr uint32_t VERSION = 1;
+
+		struct Header
+		{
+			char magic[4];
+			uint32_t version;
+			AssetBundle::Compression compression;
+			uint32_t instanceCount;
+			uint64_t storedSize;		// payload size in file
+			uint64_t size;				// payload size after decompression
+		};
+
+		static void save(const std::filesystem::path& scenePath, const SceneData& scene,
+			AssetBundle::Compression compression = AssetBundle::Compression::LZ4);
+		static SceneData load(const std::filesystem::path& scenePath);
+
+		static std::vector<uint8_t> serialize(const SceneData& scene);
+		// Throws if data is malformed, including out of range model and parent references and unknown light or camera types
+		static SceneData deserialize(const uint8_t* data, size_t size);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SceneFile.h"
+
+namespace VRD::Scene
+{
+	/*
+		Synthetic scenes for stress and scaling tests.
+		Generator fills the same SceneData that scene files are loaded into, so generated scenes are instanced
+		through the same batched path and can be saved for later runs. Output depends only on settings,
+		the same seed always produces the same scene.
+	*/
+	class SceneGenerator
+	{
+	public:
+
+		enum class Distribution : uint32_t
+		{
+			// Square grid on the ground plane, models are assigned round robin
+			GRID,
+			// Uniform over the area, up to a quarter of its size above the ground
+			RANDOM,
+			// Gaussian blobs around uniformly placed cluster centers
+			CLUSTERED
+		};
+
+		struct Settings
+		{
+			// Models picked from for every instance, by name as accepted by AssetImporter
+			std::vector<std::string> modelNames;
+			uint32_t instanceCount = 1000;
+			uint32_t lightCount = 2;
+			Distribution distribution = Distribution::GRID;
+			// Half size of the square area instances are spread over
+			float extent = 50.0f;
+			uint32_t clusterCount = 16;
+			// Standard deviation of instance offsets from the cluster center
+			float clusterRadius = 3.0f;
+			// Random rotation about the vertical axis and uniform scale, except for the grid
+			bool randomizeTransforms = true;
+			uint32_t seed = 1;
+
+			/// <summary>
+			/// Usage: --generate-scene count [--scene-distribution grid|random|clustered] [--scene-lights count]
+			/// [--scene-models name,name,...] [--scene-extent size] [--scene-seed seed]
+			/// Returns false if there is no --generate-scene flag.
+			/// </summary>
+			bool applyCommandLine(int argc, char* argv[]);
+		};
+
+		static constexpr uint32_t c_maxInstanceCount = 1000000;
+
+		// Throws if instances are requested without any model to instance
+		static SceneData generate(const Settings& settings);
+	};
+}
\ No newline at end of file
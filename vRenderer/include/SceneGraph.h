@@ -1,78 +1,162 @@
 #pragma once
 
 #include <vector>
-#include <unordered_map>
-#include <algorithm>
+#include <string>
 #include <memory>
+#include <cstdint>
 
-#include "ISceneInstanceTemplate.h"
-#include "SceneGraphInstance.h"
+#include <glm/glm.hpp>
+
+#include "Model.h"
+#include "HandleTable.h"
+#include "ModelInstance.h"
+#include "SceneChangeJournal.h"
 
 namespace VRD::Scene
 {
-	class SceneGraph
+	enum InstanceFlags : uint8_t
 	{
-	public:
+		INSTANCE_VISIBLE = 1 << 0,
+		// Local matrix is out of date with position, rotation or scale, world matrices of the whole subtree need an update
+		INSTANCE_TRANSFORM_DIRTY = 1 << 1
+	};
 
-		SceneGraph() {}
+	/*
+		Scene instances stored as structure of arrays. Every attribute lives in its own contiguous array,
+		indexed by dense index, so per-frame passes only touch the attributes they need.
+		Deletion moves the last instance into the freed place, handles are resolved to dense indices through slots.
+		Dense index of an instance is therefore only valid until the next deletion.
 
-		const SceneGraphInstance& addInstance(const ISceneInstanceTemplate& instanceTemplate)
-		{
-			uint32_t newInstanceId = global_nextId++;
-			SceneGraphInstance* newInstance = createInstanceFromTemplate(newInstanceId, instanceTemplate);
-			sceneInstances[newInstance->id] = newInstance;
-			return *newInstance;;
-		}
+		Instances form a hierarchy: position, rotation and scale are relative to the parent, world matrix is
+		parent world * local. Children are linked through first child / next sibling handles.
+		Local, world and normal matrices are cached and only subtrees under changed instances are recomputed.
+		Matrix math runs in batches over the dense arrays, see TransformKernel.
 
-		const SceneGraphInstance& cloneInstance(uint32_t id)
-		{
-			const SceneGraphInstance& clonedInstance = *sceneInstances[id];
-			uint32_t newInstanceId = global_nextId++;
-			std::string newInstanceName = clonedInstance.printName + " Copy";
-			SceneGraphInstance* newInstance = clonedInstance.clone(newInstanceId, newInstanceName);
-			sceneInstances[newInstance->id] = newInstance;
-			return *newInstance;
-		}
-
-		bool deleteInstance(uint32_t id)
-		{
-			sceneInstances.erase(id);
-			return true;
-		}
+		Every change renderers care about is recorded into a change journal, which is handed over to
+		the renderer and cleared once per frame.
 
-		const std::unordered_map<uint32_t, SceneGraphInstance*>& getInstances() const
-		{
-			return sceneInstances;
-		}
+		Scene graph is owned by the main thread.
+	*/
+	class SceneGraph
+	{
+	public:
 
-		inline bool hasInstance(uint32_t id) const
-		{
-			return sceneInstances.find(id) != sceneInstances.end();
-		}
+		SceneGraph() = default;
+
+		InstanceHandle addInstance(std::shared_ptr<const Model> model);
+		InstanceHandle addInstance(std::shared_ptr<const Model> model, const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale);
+		// Clone is placed under the same parent, children aren't cloned
+		InstanceHandle cloneInstance(InstanceHandle handle);
+		// Children of deleted instance are moved to its parent, keeping their local transform
+		bool deleteInstance(InstanceHandle handle);
+
+		// Invalid parent makes instance a root. Returns false if parent is the instance itself or one of its descendants.
+		bool setParent(InstanceHandle handle, InstanceHandle parent);
+		InstanceHandle getParent(InstanceHandle handle) const;
+		InstanceHandle getFirstChild(InstanceHandle handle) const;
+		InstanceHandle getNextSibling(InstanceHandle handle) const;
+
+		bool isValid(InstanceHandle handle) const;
+		size_t getInstanceCount() const;
+		// Preallocates dense arrays before adding many instances at once
+		void reserve(size_t instanceCount);
+
+		// Dense index of a valid handle and back
+		uint32_t getDenseIndex(InstanceHandle handle) const;
+		InstanceHandle getHandle(uint32_t denseIndex) const;
+
+		// Id is unique for the whole lifetime of the scene and is how renderers refer to instances
+		uint32_t getId(InstanceHandle handle) const;
+		const std::string& getName(InstanceHandle handle) const;
+		const std::shared_ptr<const Model>& getModel(InstanceHandle handle) const;
+		// Descriptor handed over to renderers
+		ModelInstance getModelInstance(InstanceHandle handle) const;
+
+		const glm::vec3& getPosition(InstanceHandle handle) const;
+		// Euler angles in degrees
+		const glm::vec3& getRotation(InstanceHandle handle) const;
+		const glm::vec3& getScale(InstanceHandle handle) const;
+		void setTransform(InstanceHandle handle, const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale);
+
+		// Matrices as of the last updateTransforms() call
+		const glm::mat4& getLocalMatrix(InstanceHandle handle) const;
+		const glm::mat4& getWorldMatrix(InstanceHandle handle) const;
+		// Inverse transpose of the world matrix, for transforming normals
+		const glm::mat4& getNormalMatrix(InstanceHandle handle) const;
+
+		uint8_t getFlags(InstanceHandle handle) const;
+		bool isVisible(InstanceHandle handle) const;
+		void setVisible(InstanceHandle handle, bool visible);
+
+		// Recomputes matrices of changed instances and world matrices of their subtrees.
+		// Handles of all instances with a new world matrix are appended to updated, if provided. Returns their number.
+		size_t updateTransforms(std::vector<InstanceHandle>* updated = nullptr);
+
+		// Changes since the last clearChanges(). Transforms are only recorded by updateTransforms().
+		const SceneChangeJournal& getChanges() const { return journal; }
+		void clearChanges() { journal.clear(); }
+
+		// Dense attribute arrays, all of getInstanceCount() size
+		const std::vector<uint32_t>& getIds() const { return ids; }
+		const std::vector<glm::vec3>& getPositions() const { return positions; }
+		const std::vector<glm::vec3>& getRotations() const { return rotations; }
+		const std::vector<glm::vec3>& getScales() const { return scales; }
+		const std::vector<InstanceHandle>& getParents() const { return parents; }
+		const std::vector<glm::mat4>& getLocalMatrices() const { return localMatrices; }
+		const std::vector<glm::mat4>& getWorldMatrices() const { return worldMatrices; }
+		const std::vector<glm::mat4>& getNormalMatrices() const { return normalMatrices; }
+		const std::vector<std::shared_ptr<const Model>>& getModels() const { return models; }
+		const std::vector<uint8_t>& getFlags() const { return flags; }
 
-		const SceneGraphInstance& getInstance(uint32_t id) const
-		{
-			return *sceneInstances.at(id);
-		}
+	private:
 
-		SceneGraphInstance& getInstance(uint32_t id)
+		struct Slot
 		{
-			return *sceneInstances.at(id);
-		}
-
-	private:
+			uint32_t denseIndex = 0;
+			uint32_t generation = 0;
+		};
 
 		uint32_t global_nextId = 0;
 
-		std::unordered_map<uint32_t, SceneGraphInstance*> sceneInstances = {};
-
-		SceneGraphInstance* createInstanceFromTemplate(uint32_t id, const ISceneInstanceTemplate& instanceTemplate)
-		{
-			std::string name = instanceTemplate.name + " (ModelInstance #" + std::to_string(id) + ")";
-			ModelInstance* modelInstance = new ModelInstance(id, name);
-			modelInstance->createFromTemplate(dynamic_cast<const Model&>(instanceTemplate));
-			return modelInstance;
-		}
+		std::vector<Slot> slots;
+		std::vector<uint32_t> freeSlots;
+
+		// Dense arrays
+		std::vector<InstanceHandle> handles;
+		std::vector<uint32_t> ids;
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec3> rotations;
+		std::vector<glm::vec3> scales;
+		std::vector<InstanceHandle> parents;
+		std::vector<InstanceHandle> firstChildren;
+		std::vector<InstanceHandle> nextSiblings;
+		std::vector<InstanceHandle> previousSiblings;
+		std::vector<glm::mat4> localMatrices;
+		std::vector<glm::mat4> worldMatrices;
+		std::vector<glm::mat4> normalMatrices;
+		std::vector<std::shared_ptr<const Model>> models;
+		std::vector<uint8_t> flags;
+		// Only needed by UI, kept apart from the data touched every frame
+		std::vector<std::string> names;
+
+		SceneChangeJournal journal;
+
+		// Instances marked INSTANCE_TRANSFORM_DIRTY since the last update, may contain deleted ones
+		std::vector<InstanceHandle> dirtyInstances;
+		// Dense indices used by updateTransforms(), kept to not allocate every frame
+		std::vector<uint32_t> changedIndices;
+		std::vector<uint32_t> rootIndices;
+		std::vector<uint32_t> updatedIndices;
+
+		InstanceHandle emplace(std::shared_ptr<const Model> model, std::string name,
+			const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale);
+		void markDirty(uint32_t denseIndex);
+
+		uint32_t dense(InstanceHandle handle) const { return slots[handle.index].denseIndex; }
+		void link(InstanceHandle handle, InstanceHandle parent);
+		void unlink(InstanceHandle handle);
+		// Updates world matrices of the subtree under root, whose parent world matrix is up to date
+		void updateSubtree(uint32_t root, std::vector<uint32_t>& updated);
 	};
 
 }
\ No newline at end of file
@@ -19,69 +19,111 @@ namespace VRD::OVERL
 			SELECT,
 			CLONE,
 			DELETE,
+			// Toggles visibility
 			HIDE
 		};
 
-		SceneGraphWindow()
+		SceneGraphWindow() = default;
+
+		// Selection made outside of the window, e.g. by picking in the viewport
+		void select(InstanceHandle instance)
 		{
-			selectedId = std::numeric_limits<uint32_t>::max();
+			selected = instance;
 		}
 
-		void Draw(SceneGraph& sceneGraph, std::function<void(Op action, uint32_t instanceId)> onAction, std::function<void(uint32_t instanceId)> onTransformChanged)
+		void Draw(SceneGraph& sceneGraph, std::function<void(Op action, InstanceHandle instance)> onAction, std::function<void(InstanceHandle instance)> onTransformChanged)
 		{
-			const auto& sceneGraphInstances = sceneGraph.getInstances();
-
 			ImGui::Separator();
 
 			ImGui::SameLine();
 			if (ImGui::Button("Clone"))
 			{
-				if (sceneGraph.hasInstance(selectedId))
+				if (sceneGraph.isValid(selected))
 				{
-					onAction(Op::CLONE, selectedId);
+					onAction(Op::CLONE, selected);
 				}
 			}
 			ImGui::SameLine();
 			if (ImGui::Button("Delete"))
 			{
-				if (sceneGraph.hasInstance(selectedId))
+				if (sceneGraph.isValid(selected))
+				{
+					onAction(Op::DELETE, selected);
+				}
+			}
+			ImGui::SameLine();
+			bool hidden = sceneGraph.isValid(selected) && !sceneGraph.isVisible(selected);
+			if (ImGui::Button(hidden ? "Show###Hide" : "Hide###Hide"))
+			{
+				if (sceneGraph.isValid(selected))
 				{
-					onAction(Op::DELETE, selectedId);
+					onAction(Op::HIDE, selected);
 				}
 			}
 			ImGui::SameLine();
-			if (ImGui::Button("Hide"))
+			if (ImGui::Button("Unparent"))
 			{
-				if (sceneGraph.hasInstance(selectedId))
+				if (sceneGraph.isValid(selected) && sceneGraph.getParent(selected).isValid())
 				{
-					onAction(Op::HIDE, selectedId);
+					sceneGraph.setParent(selected, InstanceHandle());
+					onTransformChanged(selected);
 				}
 			}
-			
 
 			ImGui::BeginChild("Scene graph", ImVec2(0, 200), true);
-			for (const auto& pair : sceneGraphInstances)
+			// Only visible rows are submitted, scenes may hold tens of thousands of instances
+			ImGuiListClipper clipper;
+			clipper.Begin(static_cast<int>(sceneGraph.getInstanceCount()));
+			while (clipper.Step())
 			{
-				const auto& instance = pair.second;
-				if (ImGui::Selectable(instance->printName.c_str(), selectedId == instance->id))
+				for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
 				{
-					selectedId = instance->id;
-					onAction(Op::SELECT, selectedId);
+					InstanceHandle instance = sceneGraph.getHandle(static_cast<uint32_t>(i));
+					if (ImGui::Selectable(sceneGraph.getName(instance).c_str(), selected == instance))
+					{
+						selected = instance;
+						onAction(Op::SELECT, selected);
+					}
+					// Dropping one row onto another makes the dragged instance a child of the target
+					if (ImGui::BeginDragDropSource())
+					{
+						ImGui::SetDragDropPayload("SCENE_INSTANCE", &instance, sizeof(InstanceHandle));
+						ImGui::TextUnformatted(sceneGraph.getName(instance).c_str());
+						ImGui::EndDragDropSource();
+					}
+					if (ImGui::BeginDragDropTarget())
+					{
+						if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("SCENE_INSTANCE"))
+						{
+							InstanceHandle child = *static_cast<const InstanceHandle*>(payload->Data);
+							if (sceneGraph.isValid(child) && sceneGraph.setParent(child, instance))
+							{
+								onTransformChanged(child);
+							}
+						}
+						ImGui::EndDragDropTarget();
+					}
 				}
 			}
 			ImGui::EndChild();
 
-			if (sceneGraph.hasInstance(selectedId))
+			if (sceneGraph.isValid(selected))
 			{
-				SceneGraphInstance& instance = sceneGraph.getInstance(selectedId);
-				if (imgui_helper::ShowTransformEditor(instance))
+				InstanceHandle parent = sceneGraph.getParent(selected);
+				ImGui::Text("Parent: %s", parent.isValid() ? sceneGraph.getName(parent).c_str() : "none");
+
+				glm::vec3 position = sceneGraph.getPosition(selected);
+				glm::vec3 rotation = sceneGraph.getRotation(selected);
+				glm::vec3 scale = sceneGraph.getScale(selected);
+				if (imgui_helper::ShowTransformEditor(position, rotation, scale))
 				{
-					onTransformChanged(selectedId);
+					sceneGraph.setTransform(selected, position, rotation, scale);
+					onTransformChanged(selected);
 				}
 			}
 		}
 
 	private:
-		uint32_t selectedId;
+		InstanceHandle selected;
 	};
 }
\ No newline at end of file
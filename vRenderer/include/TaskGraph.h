@@ -0,0 +1,102 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <exception>
+#include <condition_variable>
+
+#include "InplaceFunction.h"
+#include "ThreadDispatcher.h"
+
+/*
+	Acyclic graph of tasks scheduled on ThreadDispatcher.
+
+	Tasks are added up front together with dependencies between them, then the whole graph is started with run().
+	A task starts as soon as all tasks it depends on have finished. Tasks run on worker threads unless
+	main thread affinity is requested, which is meant for final nodes that hand results over to the application.
+
+	If a task throws, tasks that haven't started yet are skipped and the exception is rethrown by wait().
+*/
+
+class TaskGraph : public std::enable_shared_from_this<TaskGraph>
+{
+public:
+
+	using TaskId = uint32_t;
+	using Work = InplaceFunction<48>;
+
+	enum class Affinity
+	{
+		WORKER,
+		MAIN
+	};
+
+	// Graph keeps itself alive while running, so it is always owned by a shared pointer
+	static std::shared_ptr<TaskGraph> create();
+
+	// Priority only applies to tasks with main thread affinity
+	template<typename Callable>
+	TaskId addTask(Callable&& callable, Affinity affinity = Affinity::WORKER, DispatchPriority priority = DispatchPriority::NORMAL);
+
+	// Adds a task that starts after the given one
+	template<typename Callable>
+	TaskId then(TaskId task, Callable&& callable, Affinity affinity = Affinity::WORKER, DispatchPriority priority = DispatchPriority::NORMAL);
+
+	// Makes task wait for dependency to finish
+	void addDependency(TaskId task, TaskId dependency);
+
+	void run();
+
+	// Blocks until all tasks are finished, running queued worker tasks meanwhile.
+	// Must not be called on main thread if graph has tasks with main thread affinity.
+	void wait();
+
+	bool isFinished() const;
+
+private:
+
+	struct Node
+	{
+		Work work;
+		Affinity affinity = Affinity::WORKER;
+		DispatchPriority priority = DispatchPriority::NORMAL;
+		std::vector<TaskId> successors;
+		std::atomic<uint32_t> pendingDependencies = 0;
+	};
+
+	// Deque keeps nodes in place as the graph grows
+	std::deque<Node> nodes;
+
+	std::atomic<bool> started = false;
+	std::atomic<uint32_t> unfinishedCount = 0;
+
+	mutable std::mutex mutex;
+	std::condition_variable finishedCondition;
+	std::atomic<bool> failed = false;
+	std::exception_ptr exception;
+
+	TaskGraph() = default;
+
+	TaskId addNode(Work work, Affinity affinity, DispatchPriority priority);
+	void validate() const;
+	void schedule(TaskId task);
+	void execute(TaskId task);
+};
+
+template<typename Callable>
+inline TaskGraph::TaskId TaskGraph::addTask(Callable&& callable, Affinity affinity, DispatchPriority priority)
+{
+	return addNode(Work(std::forward<Callable>(callable)), affinity, priority);
+}
+
+template<typename Callable>
+inline TaskGraph::TaskId TaskGraph::then(TaskId task, Callable&& callable, Affinity affinity, DispatchPriority priority)
+{
+	TaskId continuation = addTask(std::forward<Callable>(callable), affinity, priority);
+	addDependency(continuation, task);
+	return continuation;
+}
\ No newline at end of file
@@ -19,6 +19,9 @@ struct Texture
 	uint32_t size = 0;			// byte size
 	std::string name;
 
+	// Hash of decoded pixel data. Textures with equal hashes are considered identical.
+	uint64_t contentHash = 0;
+
 	// Copy constructor and operators are deleted for design reasons.
 	// We generally do not want any duplicates of a single asset in memory.
 	// So any object that wants texture's data should reference to the once imported instance of it.
@@ -34,11 +37,13 @@ struct Texture
 		this->width = other.width;
 		this->size = other.size;
 		this->name = std::move(other.name);
+		this->contentHash = other.contentHash;
 
 		other.ptr = nullptr;
 		other.height = 0;
 		other.width = 0;
 		other.size = 0;
+		other.contentHash = 0;
 
 		return *this;
 	}
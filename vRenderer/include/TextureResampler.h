@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Texture.h"
+
+/*
+	Fast downscaling of RGBA8 textures.
+	Texture is repeatedly halved with a 2x2 box filter (same as mip map generation) until it fits requested size.
+	Rows are split between worker tasks, each of which averages 4 pixels at a time with SSE2 where available.
+*/
+
+class TextureResampler
+{
+public:
+
+	// Returns true if texture was downscaled
+	static bool downscaleToFit(Texture& texture, uint32_t maxSize);
+
+	static void halve(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst);
+
+private:
+
+	static void halveRows(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst, uint32_t firstRow, uint32_t lastRow);
+};
\ No newline at end of file
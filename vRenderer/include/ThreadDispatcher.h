@@ -1,21 +1,50 @@
 #pragma once
 
-#include <queue>
+#include <vector>
+#include <algorithm>
+#include <tuple>
 #include <mutex>
 #include <memory>
+#include <atomic>
+#include <thread>
+#include <exception>
 #include <condition_variable>
 
 #include "Singleton.h"
-#include "ThreadPool.h"
+#include "WorkStealingPool.h"
+#include "MpscTaskQueue.h"
+#include "ThreadTopology.h"
 
-struct Task
+// Order in which main thread tasks are run when not all of them fit into the frame budget
+enum class DispatchPriority : uint8_t
 {
-    void (*function)(void*);  // Raw function pointer
-    void* data;               // Pointer to data for the function (if needed)
+    HIGH = 0,       // cheap work that should never be delayed (UI feedback, progress)
+    NORMAL = 1,     // default
+    LOW = 2,        // heavy work that may be spread across frames (e.g. GPU uploads of prefetched assets)
+    COUNT = 3
 };
 
 /// <summary>
-/// Thread dispatcher for both main and worker threads
+/// Activity of dispatcher threads over a sampling window.
+/// </summary>
+struct ThreadingMetrics
+{
+    // Counters and histograms cover the window, queue depth is taken at its end
+    PoolMetrics cpu;
+    PoolMetrics io;
+    MpscTaskQueue::Stats main[static_cast<size_t>(DispatchPriority::COUNT)];
+    float windowMs = 0.0f;
+
+    // Share of the window the worker spent running tasks
+    float getUtilization(const WorkerMetrics& worker) const
+    {
+        return windowMs > 0.0f ? static_cast<float>(worker.busyNs) / (windowMs * 1e6f) : 0.0f;
+    }
+};
+
+/// <summary>
+/// Thread dispatcher for main thread and two worker pools laid out by ThreadTopology:
+/// compute workers for CPU bound work and an oversubscribed I/O pool for work that blocks.
 /// </summary>
 class ThreadDispatcher : public Singleton<ThreadDispatcher>
 {
@@ -23,9 +52,11 @@ class ThreadDispatcher : public Singleton<ThreadDispatcher>
 
 public:
 
-    ThreadDispatcher();
+    ThreadDispatcher(const ThreadTopology& topology = {});
 
-    void process();
+    // Runs main thread tasks by priority until budgetMs is spent, 0 means no limit. Every non-empty
+    // priority runs at least one task per call. Tasks that didn't fit are run on the following calls.
+    void process(float budgetMs = 0.0f);
 
     // Note:
     // This class utilizes template approach to callback handling for performance reasons.
@@ -35,46 +66,198 @@ public:
     template <typename Callable, typename... Args>
     void main(Callable callable, Args... args);
     template <typename Callable, typename... Args>
+    void main(DispatchPriority priority, Callable callable, Args... args);
+    template <typename Callable, typename... Args>
     void worker(Callable callable, Args... args);
+    // Dispatches blocking work (file reads etc.), so it doesn't occupy compute workers
+    template <typename Callable, typename... Args>
+    void io(Callable callable, Args... args);
+
+    // Queue state of main thread tasks of given priority, as of the last process() call. Main thread only.
+    const MpscTaskQueue::Stats& getMainQueueStats(DispatchPriority priority) const;
+
+    // Metrics of the last completed window of at least windowMs, resampled when it elapses. Main thread only.
+    const ThreadingMetrics& getMetrics(float windowMs = 500.0f);
+
+    // Runs a single queued worker task on the calling thread. Returns false if there was none.
+    bool tryRunWorkerTask();
+    uint32_t getWorkerCount() const;
+
+    // Splits [begin, end) into ranges of grainSize elements and runs body(rangeBegin, rangeEnd) for each of them
+    // on worker threads. Calling thread processes ranges too and returns once all of them are done.
+    // Grain size of 0 picks one giving each worker several ranges.
+    template <typename Body>
+    void parallel_for(size_t begin, size_t end, size_t grainSize, Body body);
+
+    // Computes map(rangeBegin, rangeEnd) for each range in parallel and folds results with reduce in range order,
+    // so the result doesn't depend on scheduling.
+    template <typename T, typename Map, typename Reduce>
+    T parallel_reduce(size_t begin, size_t end, size_t grainSize, T identity, Map map, Reduce reduce);
 
 private:
 
-    std::mutex queueMutex;    
-    std::queue<Task> taskQueue;   
-    std::unique_ptr<ThreadPool> workerPool;
+    MpscTaskQueue mainQueues[static_cast<size_t>(DispatchPriority::COUNT)];
+    std::unique_ptr<WorkStealingPool> workerPool;
+    std::unique_ptr<WorkStealingPool> ioPool;
 
-    void dispatch_main_internal(void (*function)(void*), void* data = nullptr);
+    // Totals at the start of the current metrics window
+    PoolMetrics cpuMetricsBase;
+    PoolMetrics ioMetricsBase;
+    ThreadingMetrics metrics;
+
+    // Wraps callable and its arguments into a single callable with no arguments
+    template <typename Callable, typename... Args>
+    static auto bind(Callable&& callable, Args&&... args);
+
+    size_t getGrainSize(size_t count, size_t grainSize) const;
+    template <typename ChunkBody>
+    void runChunks(size_t chunkCount, ChunkBody& chunkBody);
 };
 
 /// <summary>
-/// Dispatches provided callable to main thread
+/// Dispatches provided callable to main thread with normal priority.
+/// Small callables are stored in the queue itself, so dispatch doesn't lock or allocate.
 /// </summary>
 template <typename Callable, typename... Args>
 void ThreadDispatcher::main(Callable callable, Args... args) 
 {
-    struct Wrapper
-    {
-        Callable callable;
-        std::tuple<Args...> args;
-
-        // The function to invoke the callable
-        static void invoke(void* data) {
-            auto wrapper = static_cast<Wrapper*>(data);
-            std::apply(wrapper->callable, wrapper->args);
-            delete wrapper; // Clean up the wrapper
-        }
-    };
+    main(DispatchPriority::NORMAL, std::move(callable), std::move(args)...);
+}
 
-    // Create a wrapper to hold the callable and arguments
-    auto* wrapper = new Wrapper{ callable, std::make_tuple(args...) };
-    dispatch_main_internal(&Wrapper::invoke, wrapper);
+template <typename Callable, typename... Args>
+void ThreadDispatcher::main(DispatchPriority priority, Callable callable, Args... args)
+{
+    mainQueues[static_cast<size_t>(priority)].push(bind(std::move(callable), std::move(args)...));
 }
 
 /// <summary>
-/// Dispatches provided callable to the available working thread
+/// Dispatches provided callable to the available working thread.
+/// Work dispatched from a worker thread is queued on that worker first and is stolen by others when they run out of work.
 /// </summary>
 template <typename Callable, typename... Args>
 void ThreadDispatcher::worker(Callable callable, Args... args)
 {
-    workerPool->enqueue(callable, args...);
+    workerPool->submit(bind(std::move(callable), std::move(args)...));
+}
+
+/// <summary>
+/// Dispatches provided callable to the I/O pool.
+/// </summary>
+template <typename Callable, typename... Args>
+void ThreadDispatcher::io(Callable callable, Args... args)
+{
+    ioPool->submit(bind(std::move(callable), std::move(args)...));
+}
+
+template <typename Callable, typename... Args>
+auto ThreadDispatcher::bind(Callable&& callable, Args&&... args)
+{
+    if constexpr (sizeof...(Args) == 0)
+    {
+        return std::forward<Callable>(callable);
+    }
+    else
+    {
+        return [callable = std::forward<Callable>(callable), args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+            std::apply(callable, args);
+        };
+    }
+}
+
+template <typename Body>
+void ThreadDispatcher::parallel_for(size_t begin, size_t end, size_t grainSize, Body body)
+{
+    if (begin >= end) return;
+
+    grainSize = getGrainSize(end - begin, grainSize);
+    auto chunkBody = [&](size_t chunk) {
+        size_t rangeBegin = begin + chunk * grainSize;
+        body(rangeBegin, std::min(rangeBegin + grainSize, end));
+    };
+    runChunks((end - begin + grainSize - 1) / grainSize, chunkBody);
+}
+
+template <typename T, typename Map, typename Reduce>
+T ThreadDispatcher::parallel_reduce(size_t begin, size_t end, size_t grainSize, T identity, Map map, Reduce reduce)
+{
+    if (begin >= end) return identity;
+
+    grainSize = getGrainSize(end - begin, grainSize);
+    size_t chunkCount = (end - begin + grainSize - 1) / grainSize;
+    std::vector<T> results(chunkCount, identity);
+    auto chunkBody = [&](size_t chunk) {
+        size_t rangeBegin = begin + chunk * grainSize;
+        results[chunk] = map(rangeBegin, std::min(rangeBegin + grainSize, end));
+    };
+    runChunks(chunkCount, chunkBody);
+
+    T result = identity;
+    for (T& chunkResult : results)
+    {
+        result = reduce(result, chunkResult);
+    }
+    return result;
 }
+
+/// <summary>
+/// Runs chunkBody(chunk) for every chunk index. Chunks are claimed from a shared counter by the calling thread
+/// and by up to one helper per worker, so the call never depends on a free worker to make progress.
+/// Helpers that start after all chunks are claimed exit right away, which is why state is shared with them.
+/// </summary>
+template <typename ChunkBody>
+void ThreadDispatcher::runChunks(size_t chunkCount, ChunkBody& chunkBody)
+{
+    struct State
+    {
+        ChunkBody* body;
+        size_t chunkCount;
+        std::atomic<size_t> nextChunk = 0;
+        std::atomic<size_t> remainingChunks;
+        std::atomic<bool> failed = false;
+        std::mutex exceptionMutex;
+        std::exception_ptr exception;
+
+        void runAvailableChunks()
+        {
+            for (size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++)
+            {
+                if (!failed.load(std::memory_order_relaxed))
+                {
+                    try
+                    {
+                        (*body)(chunk);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(exceptionMutex);
+                        if (!exception) exception = std::current_exception();
+                        failed = true;
+                    }
+                }
+                remainingChunks.fetch_sub(1, std::memory_order_acq_rel);
+            }
+        }
+    };
+
+    auto state = std::make_shared<State>();
+    state->body = &chunkBody;
+    state->chunkCount = chunkCount;
+    state->remainingChunks = chunkCount;
+
+    size_t helperCount = std::min<size_t>(chunkCount - 1, getWorkerCount());
+    for (size_t i = 0; i < helperCount; i++)
+    {
+        workerPool->submit([state]() { state->runAvailableChunks(); });
+    }
+
+    state->runAvailableChunks();
+    while (state->remainingChunks.load(std::memory_order_acquire) > 0)
+    {
+        std::this_thread::yield();
+    }
+
+    if (state->exception)
+    {
+        std::rethrow_exception(state->exception);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+
+/// <summary>
+/// Histogram of durations with power of two buckets: bucket 0 counts durations under 1us,
+/// bucket i durations in [2^(i-1), 2^i) us and the last one everything longer.
+/// </summary>
+struct LatencyHistogram
+{
+	static constexpr size_t c_bucketCount = 16;
+
+	std::array<uint64_t, c_bucketCount> buckets = {};
+
+	static size_t getBucket(uint64_t durationNs)
+	{
+		uint64_t us = durationNs / 1000;
+		size_t bucket = 0;
+		while (us > 0 && bucket < c_bucketCount - 1)
+		{
+			us >>= 1;
+			bucket++;
+		}
+		return bucket;
+	}
+
+	// Upper bound of the bucket in milliseconds, the last bucket is reported with its lower bound
+	static float getBucketLimitMs(size_t bucket)
+	{
+		size_t shift = bucket < c_bucketCount - 1 ? bucket : bucket - 1;
+		return static_cast<float>(1ull << shift) / 1000.0f;
+	}
+
+	uint64_t getCount() const
+	{
+		uint64_t count = 0;
+		for (uint64_t bucketCount : buckets) count += bucketCount;
+		return count;
+	}
+
+	// Approximate duration under which the given fraction (0..1) of samples falls
+	float getPercentileMs(float fraction) const
+	{
+		uint64_t count = getCount();
+		if (count == 0) return 0.0f;
+
+		uint64_t target = static_cast<uint64_t>(fraction * static_cast<float>(count - 1)) + 1;
+		uint64_t accumulated = 0;
+		for (size_t i = 0; i < c_bucketCount; i++)
+		{
+			accumulated += buckets[i];
+			if (accumulated >= target) return getBucketLimitMs(i);
+		}
+		return getBucketLimitMs(c_bucketCount - 1);
+	}
+
+	LatencyHistogram& operator+=(const LatencyHistogram& other)
+	{
+		for (size_t i = 0; i < c_bucketCount; i++) buckets[i] += other.buckets[i];
+		return *this;
+	}
+
+	LatencyHistogram& operator-=(const LatencyHistogram& other)
+	{
+		for (size_t i = 0; i < c_bucketCount; i++) buckets[i] -= other.buckets[i];
+		return *this;
+	}
+};
+
+/// <summary>
+/// Counters of a single pool thread. Time is measured from submission of a task to its start (wait) and to its end (run).
+/// </summary>
+struct WorkerMetrics
+{
+	uint64_t taskCount = 0;
+	// Tasks taken from other workers' deques
+	uint64_t stealCount = 0;
+	uint64_t busyNs = 0;
+	LatencyHistogram waitTime;
+	LatencyHistogram runTime;
+
+	WorkerMetrics& operator+=(const WorkerMetrics& other)
+	{
+		taskCount += other.taskCount;
+		stealCount += other.stealCount;
+		busyNs += other.busyNs;
+		waitTime += other.waitTime;
+		runTime += other.runTime;
+		return *this;
+	}
+
+	WorkerMetrics& operator-=(const WorkerMetrics& other)
+	{
+		taskCount -= other.taskCount;
+		stealCount -= other.stealCount;
+		busyNs -= other.busyNs;
+		waitTime -= other.waitTime;
+		runTime -= other.runTime;
+		return *this;
+	}
+};
+
+/// <summary>
+/// Snapshot of pool metrics. Counters either are totals since pool creation or cover an interval, depending on the source.
+/// </summary>
+struct PoolMetrics
+{
+	std::vector<WorkerMetrics> workers;
+	// Tasks run by threads that help the pool while waiting (e.g. parallel_for callers)
+	WorkerMetrics external;
+	// Submitted tasks no thread has taken yet
+	int64_t queueDepth = 0;
+	std::chrono::steady_clock::time_point sampleTime;
+
+	WorkerMetrics getTotal() const
+	{
+		WorkerMetrics total = external;
+		for (const WorkerMetrics& worker : workers) total += worker;
+		return total;
+	}
+
+	// Replaces totals with the change since the earlier snapshot of the same pool
+	void subtract(const PoolMetrics& earlier)
+	{
+		for (size_t i = 0; i < workers.size() && i < earlier.workers.size(); i++)
+		{
+			workers[i] -= earlier.workers[i];
+		}
+		external -= earlier.external;
+	}
+};
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "json.hpp"
+#include <string>
+#include <cstdint>
+
+/*
+	Thread layout of the application, read once at startup from prefs ("Thread_topology") and command line:
+
+	--cpu-threads N		number of workers for compute work, 0 sizes the pool to the number of logical cores
+	--io-threads N		number of threads for blocking work, mostly file reads
+	--pin-threads		pins each compute worker to its own core
+*/
+
+struct ThreadTopology
+{
+    uint32_t cpuThreadCount = 0;
+
+    // Threads of this pool mostly wait for the disk, so it is oversubscribed on top of the compute pool
+    uint32_t ioThreadCount = 4;
+
+    bool pinCpuThreads = false;
+
+    // Overrides settings with the ones provided in command line
+    void applyCommandLine(int argc, char* argv[]);
+
+    uint32_t getCpuThreadCount() const;
+    uint32_t getIoThreadCount() const;
+
+    // Names calling thread for debuggers and profilers and optionally pins it to a core (negative core leaves it unpinned)
+    static void setupCurrentThread(const std::string& name, int32_t core = -1);
+
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE(ThreadTopology, cpuThreadCount, ioThreadCount, pinCpuThreads);
+};
\ No newline at end of file
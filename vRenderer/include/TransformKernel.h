@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+namespace VRD::Scene
+{
+	/*
+		Batch transform math over the dense attribute arrays of the scene graph.
+		Instances are addressed by dense indices, so only changed ones are touched. Each batch is processed
+		4 instances at a time with SSE2 where available: attributes of 4 instances are gathered into one register
+		per matrix element, computed lane-wise and transposed back into column major matrices.
+
+		Functions are stateless, callers split large batches between worker tasks.
+	*/
+	class TransformKernel
+	{
+	public:
+
+		// locals[i] = translation * rotation (Z * Y * X, degrees) * scale, for every i in indices
+		static void composeLocal(const glm::vec3* positions, const glm::vec3* rotations, const glm::vec3* scales,
+			const uint32_t* indices, size_t count, glm::mat4* locals);
+
+		// normals[i] = inverse transpose of the upper 3x3 of worlds[i], for every i in indices.
+		// Translation part is left zero, so the result can be applied to a vec4(normal, 1).
+		static void computeNormals(const glm::mat4* worlds, const uint32_t* indices, size_t count, glm::mat4* normals);
+
+		// Single instance versions of the above
+		static glm::mat4 compose(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale);
+		static glm::mat4 normalMatrix(const glm::mat4& world);
+
+		static glm::mat4 multiply(const glm::mat4& a, const glm::mat4& b);
+	};
+}
\ No newline at end of file
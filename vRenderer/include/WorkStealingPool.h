@@ -0,0 +1,119 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <condition_variable>
+
+#include "InplaceFunction.h"
+#include "ThreadMetrics.h"
+
+/*
+	Thread pool with a task deque per worker.
+
+	Tasks submitted from a worker thread go to that worker's own deque, which it pops in LIFO order
+	while idle workers steal from the opposite end (Chase-Lev deque, no locks on either path).
+	Tasks submitted from other threads go through a shared bounded lock-free injection ring.
+	If the ring is full, they spill into a mutex protected overflow list, and until it is drained new tasks go there too,
+	so tasks from outside keep their order. Workers take from overflow once the ring is empty.
+	Threads outside the pool never run pool tasks unless they ask for it with tryRunPendingTask().
+
+	Tasks are stored in pooled nodes with a 40 byte inline buffer for the callable. Free nodes are cached per thread,
+	and surplus is exchanged through a lock-free free list shared by all threads, so nodes released by workers flow back
+	to the threads outside the pool that submit them. In steady state neither submission nor execution allocates.
+
+	Every thread keeps its own metrics counters, so collecting them doesn't add contention between workers.
+*/
+
+class WorkStealingPool
+{
+public:
+
+	using Clock = std::chrono::steady_clock;
+
+	// Sized so that a pooled task node with its submission time fits into a single cache line
+	using Task = InplaceFunction<40>;
+
+	// onThreadStart(workerIndex) is called on each worker thread before it takes any task
+	WorkStealingPool(uint32_t threadCount, std::function<void(uint32_t)> onThreadStart = nullptr);
+	// Runs all remaining tasks before joining worker threads
+	~WorkStealingPool();
+
+	WorkStealingPool(const WorkStealingPool&) = delete;
+	WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+	template<typename Callable>
+	void submit(Callable&& callable);
+
+	uint32_t getThreadCount() const;
+
+	// Index of the calling worker thread in this pool, or -1 for threads not owned by the pool
+	int32_t getCurrentWorkerIndex() const;
+
+	// Runs a single pending task on the calling thread if there is one.
+	// Lets threads that wait for other tasks to finish help instead of blocking.
+	bool tryRunPendingTask();
+
+	// Totals since the pool was created. Can be called from any thread.
+	PoolMetrics getMetrics() const;
+
+private:
+
+	struct TaskNode
+	{
+		Task task;
+		Clock::time_point submitTime;
+	};
+
+	class TaskDeque;
+	class NodeRing;
+	struct Counters;
+	struct Worker;
+	struct NodeCache;
+
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::function<void(uint32_t)> onThreadStart;
+	// Shared by all threads not owned by the pool
+	std::unique_ptr<Counters> externalCounters;
+
+	// Tasks submitted by threads not owned by the pool
+	std::unique_ptr<NodeRing> injectionQueue;
+	// Tasks that didn't fit into injectionQueue, taken from overflowHead on. Storage is kept once drained.
+	std::mutex overflowMutex;
+	std::vector<TaskNode*> overflow;
+	size_t overflowHead = 0;
+	std::atomic<bool> overflowActive = false;
+
+	// Sleeping workers are woken when pending task count becomes non zero
+	std::atomic<int64_t> pendingTaskCount = 0;
+	std::atomic<uint32_t> sleepingWorkerCount = 0;
+	std::mutex sleepMutex;
+	std::condition_variable sleepCondition;
+	std::atomic<bool> stop = false;
+
+	void submitNode(TaskNode* node);
+	void pushToOverflow(TaskNode* node);
+	TaskNode* popFromOverflow();
+	TaskNode* findTask(uint32_t workerIndex, bool& stolen);
+	void runTask(TaskNode* node, bool stolen, Counters& counters);
+	void workerLoop(uint32_t workerIndex);
+
+	static NodeCache& getNodeCache();
+	static NodeRing& getFreeNodes();
+	static TaskNode* allocateNode();
+	static void releaseNode(TaskNode* node);
+};
+
+template<typename Callable>
+inline void WorkStealingPool::submit(Callable&& callable)
+{
+	TaskNode* node = allocateNode();
+	node->task = Task(std::forward<Callable>(callable));
+	node->submitTime = Clock::now();
+	submitNode(node);
+}
\ No newline at end of file
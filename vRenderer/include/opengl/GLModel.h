@@ -13,6 +13,8 @@
 #include "GLUtils.h"
 #include "Model.h"
 #include "BaseCamera.h"
+#include "Bounds.h"
+#include "OcclusionCuller.h"
 
 class GLModel
 {
@@ -22,9 +24,18 @@ public:
 	GLModel(uint32_t id, const Model& model);
 	~GLModel();
 
-	void draw(GLShader& shader, BaseCamera& camera);
-	void setTransform(glm::mat4 transform);
+	// Meshes outside of frustum are skipped, if it is provided
+	void draw(GLShader& shader, BaseCamera& camera, const Frustum* frustum = nullptr);
+	void setTransform(const glm::mat4& transform, const glm::mat4& normalMatrix);
 	const glm::mat4 getTransform() const;
+	// World space sphere around all meshes, packed as (center, radius)
+	const glm::vec4& getWorldBounds() const;
+	// Offers meshes as occluders with the current transform
+	void addOccluders(OcclusionCuller& culler) const;
+
+	// Hidden models are skipped by culling, so they are neither drawn nor occlude others
+	void setVisible(bool visible) { this->visible = visible; }
+	bool isVisible() const { return visible; }
 
 private:
 	
@@ -35,6 +46,16 @@ private:
 	uint32_t materialCount;
 
 	glm::mat4 transform;
+	glm::mat4 normalMatrix;
+	bool visible = true;
+
+	// Model space bounds and their world space counterparts, updated with transform
+	BoundingSphere bounds;
+	std::vector<BoundingSphere> meshBounds;
+	glm::vec4 worldBounds;
+	std::vector<glm::vec4> worldMeshBounds;
+	// CPU geometry rasterized for occlusion culling, shared with the source model
+	std::vector<std::shared_ptr<const Mesh>> sourceMeshes;
 
 	std::vector<GLMesh*> meshes;
 	std::vector<GLMaterial*> materials;
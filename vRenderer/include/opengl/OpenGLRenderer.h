@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <span>
 #include <glad/glad.h>
 
 #include <glm/glm.hpp>
@@ -12,12 +13,15 @@
 #include <imgui_impl_opengl3.h>
 
 #include "IRenderer.h"
+#include "HandleTable.h"
 #include "Lighting.h"
 #include "GLUtils.h"
 #include "GLShader.h"
 #include "GLModel.h"
 #include "GLTexture.h"
 #include "BaseCamera.h"
+#include "FrustumCuller.h"
+#include "OcclusionCuller.h"
 
 #define BACKGROUND_COLOR 0x888800FF
 
@@ -34,10 +38,12 @@ public:
 	int init(GLFWwindow* window) override;
 	void draw() override;
 	bool addToRenderer(const Model& model, glm::vec3 color) override;
-	bool addToRendererTextured(const ModelInstance& model) override;
-	bool removeFromRenderer(int modelId) override;
-	bool isModelInRenderer(uint32_t id) override;
-	bool updateModelTransform(int modelId, glm::mat4 newTransform) override;
+	size_t addModelsToRenderer(std::span<const ModelInstance> models) override;
+	size_t removeModelsFromRenderer(std::span<const InstanceHandle> handles) override;
+	bool isModelInRenderer(InstanceHandle handle) override;
+	void applySceneChanges(const SceneChangeJournal& changes) override;
+	size_t updateModelTransforms(std::span<const InstanceHandle> handles,
+		std::span<const glm::mat4> transforms, std::span<const glm::mat4> normalMatrices) override;
 	void setCamera(const std::shared_ptr<BaseCamera> camera) override;
 	bool addLightSources(const std::shared_ptr<Light> lights[], uint32_t count) override;
 	bool removeLightSources(uint32_t* ids, uint32_t count) override;
@@ -53,14 +59,21 @@ private:
 	std::unique_ptr<GLShader> outlineShader;
 
 	std::shared_ptr<BaseCamera> camera;
-	std::vector<GLModel*> modelsToRender;
+	// Models of scene instances, iterated densely by culling and drawing
+	HandleTable<GLModel*> modelsToRender;
+	// World bounds of modelsToRender and indices of those in view, refreshed every frame
+	std::vector<glm::vec4> modelBounds;
+	std::vector<uint32_t> visibleModels;
+	Frustum viewFrustum;
+	OcclusionCuller occlusionCuller;
 	std::vector<std::shared_ptr<Light>> lightSources;
 
-	GLModel* getModel(uint32_t id);
+	GLModel* getModel(InstanceHandle handle);
 
 	void createFramebuffers();
 
 	void applyLighting();
+	void cullModels();
 	void drawOutline();
 	/*
 	---- IMGUI fields -----
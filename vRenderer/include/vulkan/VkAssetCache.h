@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+
+#include "Singleton.h"
+#include "VulkanUtils.h"
+#include "VkTexture.h"
+#include "VkMesh.h"
+
+using namespace VkUtils;
+
+/// <summary>
+/// Keeps track of GPU resources created from generic assets, keyed by asset content hash.
+/// Identical textures and meshes (even if imported from different files) are uploaded only once
+/// and shared between all models that reference them. Resources are released as soon as
+/// the last user drops its reference.
+/// </summary>
+class VkAssetCache : public Singleton<VkAssetCache>
+{
+	friend class Singleton<VkAssetCache>;
+
+public:
+
+	std::shared_ptr<VkTexture> getTexture(const Texture& texture);
+	std::shared_ptr<VkMesh> getMesh(const Mesh& mesh);
+
+protected:
+
+	VkAssetCache(VkContext context);
+	~VkAssetCache() = default;
+
+private:
+
+	VkContext context;
+
+	std::unordered_map<uint64_t, std::weak_ptr<VkTexture>> textures;
+	std::unordered_map<uint64_t, std::weak_ptr<VkMesh>> meshes;
+};
\ No newline at end of file
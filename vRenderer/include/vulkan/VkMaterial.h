@@ -21,10 +21,11 @@ public:
 	// The order of texture creation affects the order of sampler descriptors in samplerDescriptorSets vector,
 	// and, accordingly, what texture is passed in shader.
 	// This way, let the order of declaration here match the order of creation and the declaration order in shader.
-	std::unique_ptr<VkTexture> ambient;
-	std::unique_ptr<VkTexture> diffuse;
-	std::unique_ptr<VkTexture> specular;
-	std::unique_ptr<VkTexture> opacityMap;
+	// Textures are shared between materials referencing identical images (see VkAssetCache).
+	std::shared_ptr<VkTexture> ambient;
+	std::shared_ptr<VkTexture> diffuse;
+	std::shared_ptr<VkTexture> specular;
+	std::shared_ptr<VkTexture> opacityMap;
 
 	struct ALIGN_STD140 UboMaterial
 	{
@@ -26,9 +26,6 @@ public:
 	VkBuffer getVertexBuffer();
 	int getIndexCount();
 	VkBuffer getIndexBuffer();
-	glm::mat4 getTransformMat();
-
-	void setTransformMat(glm::mat4 transform);
 
 private:
 
@@ -42,9 +39,6 @@ private:
 
 	VkContext context;
 
-	// Transform
-	glm::mat4 transformMat;
-
 	void createFromGenericMesh(const Mesh& mesh);
 	void createVertexBuffer(const std::vector<Vertex>& vertices, VkContext context);
 	void createIndexBuffer(const std::vector<uint32_t>& indices, VkContext context);
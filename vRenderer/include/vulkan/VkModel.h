@@ -5,6 +5,7 @@
 #include <vector>
 #include <map>
 #include <algorithm>
+#include <memory>
 
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -13,6 +14,8 @@
 #include "VkMesh.h"
 #include "VkMaterial.h"
 #include "BaseCamera.h"
+#include "Bounds.h"
+#include "OcclusionCuller.h"
 
 using namespace VkUtils;
 
@@ -23,30 +26,52 @@ public:
 	const uint32_t id;
 
 	VkModel(uint32_t id, const Model& model, VkContext context, VkSamplerDescriptorSetCreateInfo createInfo);
+	// Shares GPU meshes and materials of a model created from the same template, nothing is allocated on the GPU
+	VkModel(uint32_t id, const VkModel& prototype);
 	~VkModel();
 
 	int getMeshCount() const;
 	int getMaterialCount() const;
 
-	const VkMesh* getMesh(uint32_t id) const;
-	const std::vector<VkMesh*>& getMeshes() const;
+	const std::vector<std::shared_ptr<VkMesh>>& getMeshes() const;
 
-	void draw(uint32_t imageIndex, VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, bool bindMaterials);
+	// Meshes outside of frustum are skipped, if it is provided
+	void draw(uint32_t imageIndex, VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, bool bindMaterials, const Frustum* frustum = nullptr);
 
-	void setTransform(glm::mat4 transform);
+	void setTransform(const glm::mat4& transform, const glm::mat4& normalMatrix);
+	// World space sphere around all meshes, packed as (center, radius)
+	const glm::vec4& getWorldBounds() const;
+	// Offers meshes as occluders with the current transform
+	void addOccluders(OcclusionCuller& culler) const;
+
+	// Hidden models are skipped by culling, so they are neither drawn nor occlude others
+	void setVisible(bool visible) { this->visible = visible; }
+	bool isVisible() const { return visible; }
 
 private:
 
 	const uint32_t NO_MATERIAL_INDEX = -1;
 
 	int meshCount;
-	int materialCount;
+	int materialCount = 0;
 	VkContext context;
 	glm::mat4 transform;
+	glm::mat4 normalMatrix;
+	bool visible = true;
+
+	// Model space bounds and their world space counterparts, updated with transform
+	BoundingSphere bounds;
+	std::vector<BoundingSphere> meshBounds;
+	glm::vec4 worldBounds;
+	std::vector<glm::vec4> worldMeshBounds;
+	// CPU geometry rasterized for occlusion culling, shared with the source model
+	std::vector<std::shared_ptr<const Mesh>> sourceMeshes;
 
 	// 1:1 relation
-	std::vector<VkMesh*> meshes;
-	std::vector<VkMaterial*> materials;
+	// Meshes are shared between models referencing identical geometry (see VkAssetCache)
+	std::vector<std::shared_ptr<VkMesh>> meshes;
+	// Materials are shared between models constructed from a prototype
+	std::vector<std::shared_ptr<VkMaterial>> materials;
 
 	void createFromGenericModel(const Model& model, VkSamplerDescriptorSetCreateInfo createInfo);
 	void cleanup();
@@ -14,6 +14,7 @@
 
 #include "Singleton.h"
 #include "VulkanUtils.h"
+#include "AsyncFileReader.h"
 
 using namespace VkUtils;
 namespace fs = std::filesystem;
@@ -45,6 +45,11 @@ inline size_t VkUniformDynamic<T>::getBufferSize() const
 template<typename T>
 inline void VkUniformDynamic<T>::update(uint32_t imageIndex, const T* data, uint32_t drawCount)
 {
+	if (drawCount > MAX_OBJECTS)
+	{
+		throw std::runtime_error("Dynamic uniform buffer holds " + std::to_string(MAX_OBJECTS) + " objects, " + std::to_string(drawCount) + " provided.");
+	}
+
 	if (drawCount > 0)
 	{
 		for (int i = 0; i < drawCount; i++)
@@ -121,6 +126,11 @@ inline void VkUniformDynamic<T>::create()
 template<typename T>
 inline void VkUniformDynamic<T>::cmdBind(uint32_t setIndex, uint32_t imageIndex, uint32_t drawIndex, VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout)
 {
+	if (drawIndex >= MAX_OBJECTS)
+	{
+		throw std::runtime_error("Dynamic uniform draw index is out of buffer range.");
+	}
+
 	uint32_t dynamicOffset = static_cast<uint32_t>(alignment) * drawIndex;
 	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout,
 		setIndex, 1, &descriptorSet[imageIndex], 1, &dynamicOffset);
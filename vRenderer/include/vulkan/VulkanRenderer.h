@@ -27,6 +27,9 @@
 #include <set>
 #include <array>
 #include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <span>
 #include <map>
 #include <functional>
 
@@ -35,6 +38,7 @@
 #include "IRenderer.h"
 #include "Lighting.h"
 #include "ModelInstance.h"
+#include "HandleTable.h"
 #include "VkModel.h"
 #include "VkSimpleMesh.h"
 #include "VulkanUtils.h"
@@ -42,6 +46,7 @@
 #include "VkUniformDynamic.hpp"
 #include "VkImageWrapper.h"
 #include "VkSetLayoutFactory.h"
+#include "VkAssetCache.h"
 #include "BaseCamera.h"
 #include "VkSkyboxPipeline.h"
 #include "VkShaderManager.h"
@@ -50,6 +55,8 @@
 #include "VkOutlinePipeline.h"
 #include "VkMainPipeline.h"
 #include "VkSecondPassPipeline.h"
+#include "FrustumCuller.h"
+#include "OcclusionCuller.h"
 
 // preferrable surface settings (selected if supported)
 #define SURFACE_COLOR_FORMAT		VK_FORMAT_R8G8B8A8_UNORM
@@ -131,8 +138,14 @@ private:
 	std::shared_ptr<RenderSettings> renderSettings;
 	// Scene
 	std::shared_ptr<BaseCamera> sceneCamera;
-	std::vector<VkModel*> modelsToRender;
+	// Models of scene instances, iterated densely by culling and drawing
+	HandleTable<VkModel*> modelsToRender;
 	std::vector<VkModel*> modelsToDestroy;
+	// World bounds of modelsToRender and indices of those in view, refreshed every frame
+	std::vector<glm::vec4> modelBounds;
+	std::vector<uint32_t> visibleModels;
+	Frustum viewFrustum;
+	OcclusionCuller occlusionCuller;
 	std::vector<std::shared_ptr<Light>> lightSources;
 	UboLightArray uboLightArray;
 
@@ -165,11 +178,13 @@ public:
 	void applyLighting();
 
 	bool addToRenderer(const Model& model, glm::vec3 color);
-	bool addToRendererTextured(const ModelInstance& model);
-	bool removeFromRenderer(int modelId);
-	bool isModelInRenderer(uint32_t id);
+	size_t addModelsToRenderer(std::span<const ModelInstance> models) override;
+	size_t removeModelsFromRenderer(std::span<const InstanceHandle> handles) override;
+	bool isModelInRenderer(InstanceHandle handle);
+	void applySceneChanges(const SceneChangeJournal& changes) override;
 
-	bool updateModelTransform(int modelId, glm::mat4 newTransform);
+	size_t updateModelTransforms(std::span<const InstanceHandle> handles,
+		std::span<const glm::mat4> transforms, std::span<const glm::mat4> normalMatrices) override;
 	void setCamera(const std::shared_ptr<BaseCamera> camera);
 	bool addLightSources(const std::shared_ptr<Light> light[], uint32_t count);
 	bool removeLightSources(uint32_t* ids, uint32_t count) override;
@@ -203,6 +218,7 @@ private:
 	void createCommandBuffers();
 	void createSyncTools();
 
+	void cullModels();
 	void recordCommands(uint32_t currentImage, ImDrawData& imguiDrawData);
 	void updateUniforms(uint32_t imageIndex);
 
@@ -221,7 +237,7 @@ private:
 	SwapChainDetails getSwapChainDetails(VkPhysicalDevice device);
 	bool checkValidationLayerSupport();
 
-	VkModel* getModel(uint32_t id);
+	VkModel* getModel(InstanceHandle handle);
 
 	void printPhysicalDeviceInfo(VkPhysicalDevice device, bool printPropertiesFull = false, bool printFeaturesFull = false);
 
@@ -71,11 +71,12 @@ void Application::initWindow(std::string title, const int width, const int heigh
 	}
 }
 
-int Application::initApplication()
+int Application::initApplication(const ThreadTopology& topology)
 {
 	context = &AppContext::instance();
-	ThreadDispatcher::initialize();
+	ThreadDispatcher::initialize(topology);
 	threadDispatcher.reset(&ThreadDispatcher::instance());
+	AsyncFileReader::initialize();
 
 	if (currentApi == RenderSettings::API::VULKAN)
 	{
@@ -97,10 +98,23 @@ int Application::initApplication()
 		renderer->bindRenderSettings(renderSettings);
 	}   
 
-	assetImporter = std::make_unique<AssetImporter>(new AssimpModelImporter(), new StbImageImporter());
+	assetImporter = std::make_unique<AssetImporter>(new AssimpModelImporter(), new ImageImporter());
+	assetImporter->setImportSettings(*importSettings);
+	if (std::filesystem::exists(ASSET_BUNDLE_FILE))
+	{
+		try
+		{
+			assetImporter->mountBundle(ASSET_BUNDLE_FILE);
+		}
+		catch (const std::runtime_error& e)
+		{
+			std::cout << "Asset bundle is not mounted: " << e.what() << std::endl;
+		}
+	}
 	assetBrowser = std::make_unique<AssetBrowser>();
 	sceneGraphWindow = std::make_unique<SceneGraphWindow>();
 	sceneGraph = std::make_unique<SceneGraph>();
+	sceneBvh = std::make_unique<SceneBvh>();
 	
 	initInput(window);
 
@@ -112,11 +126,7 @@ int Application::initApplication()
 	lightSources.push_back(light2);
 	renderer->addLightSources(lightSources.data(), lightSources.size());
 
-	// Load and set skybox
-	assetImporter->importCubemap_async("skybox", [this](std::shared_ptr<Cubemap> cubemap) {
-		skyboxCubemap = cubemap;
-		renderer->setSkybox(skyboxCubemap);
-		});
+	loadSkybox("skybox").detach();
 
 	return 0;
 }
@@ -125,11 +135,16 @@ void Application::loadUserPrefs()
 {
 	renderSettings = std::make_unique<RenderSettings>();
 	GetPrefs("Render_settings", *renderSettings);
+	importSettings = std::make_unique<ImportSettings>();
+	GetPrefs("Import_settings", *importSettings);
+	GetPrefs("Thread_topology", threadTopology);
 }
 
 void Application::saveUserPrefs()
 {
 	SavePrefs("Render_settings", *renderSettings);
+	SavePrefs("Import_settings", *importSettings);
+	SavePrefs("Thread_topology", threadTopology);
 }
 
 void Application::processInput()
@@ -141,6 +156,11 @@ void Application::processInput()
 void Application::update()
 {
 	camera->update();
+	syncSceneTransforms();
+
+	// Renderer sees all scene changes of the frame at once
+	renderer->applySceneChanges(sceneGraph->getChanges());
+	sceneGraph->clearChanges();
 }
 
 void Application::render()
@@ -223,28 +243,28 @@ void Application::setSceneCamera(CameraType cameraType)
 		EventBinder::Unbind(&BaseCamera::onKey, oldCamera.get(), inp::onKey);
 	}
 
-	EventBinder::Bind(&BaseCamera::onMouseMove, camera.get(), inp::onMouseMove);
-	EventBinder::Bind(&BaseCamera::onMouseScroll, camera.get(), inp::onMouseScroll);
-	EventBinder::Bind(&BaseCamera::onKey, camera.get(), inp::onKey);
+	EventBinder::Bind<&BaseCamera::onMouseMove>(camera.get(), inp::onMouseMove);
+	EventBinder::Bind<&BaseCamera::onMouseScroll>(camera.get(), inp::onMouseScroll);
+	EventBinder::Bind<&BaseCamera::onKey>(camera.get(), inp::onKey);
 
 	renderer->setCamera(camera);
 }
 
-void Application::cloneSceneInstance(uint32_t instanceId)
+void Application::cloneSceneInstance(InstanceHandle instance)
 {
-	const SceneGraphInstance& newInstance = sceneGraph->cloneInstance(instanceId);\
-	renderer->addToRendererTextured(dynamic_cast<const ModelInstance&>(newInstance));
+	sceneGraph->cloneInstance(instance);
+	sceneBvhStale = true;
 }
 
-void Application::deleteSceneInstance(uint32_t instanceId)
+void Application::deleteSceneInstance(InstanceHandle instance)
 {
-	sceneGraph->deleteInstance(instanceId);
-	renderer->removeFromRenderer(instanceId);
+	sceneGraph->deleteInstance(instance);
+	sceneBvhStale = true;
 }
 
-void Application::hideSceneInstance(uint32_t instanceId)
+void Application::hideSceneInstance(InstanceHandle instance)
 {
-	std::cout << "hide" << std::endl;
+	sceneGraph->setVisible(instance, !sceneGraph->isVisible(instance));
 }
 
 void Application::onAssetBrowserAction(AssetBrowserOp action, std::string modelName)
@@ -252,48 +272,282 @@ void Application::onAssetBrowserAction(AssetBrowserOp action, std::string modelN
 	switch (action)
 	{
 	case AssetBrowserOp::ADD:
-		addModelToRenderer(modelName);
+		addModelToRenderer(modelName).detach();
 		break;
 	default:
 		break;
 	}
 }
 
-void Application::addModelToRenderer(std::string modelName)
+AsyncTask<void> Application::addModelToRenderer(std::string modelName)
+{
+	if (renderer == nullptr || sceneGraph == nullptr) co_return;
+
+	std::shared_ptr<Model> model = co_await assetImporter->importModelTask(modelName);
+	co_await switchToMain();
+
+	sceneGraph->addInstance(model);
+	sceneBvhStale = true;
+}
+
+AsyncTask<void> Application::loadSkybox(std::string cubemapName)
+{
+	std::shared_ptr<Cubemap> cubemap = co_await assetImporter->importCubemapTask(cubemapName);
+	co_await switchToMain();
+
+	skyboxCubemap = cubemap;
+	skyboxName = cubemapName;
+	renderer->setSkybox(skyboxCubemap);
+}
+
+void Application::clearScene()
 {
-	if (renderer != nullptr && sceneGraph != nullptr)
+	// Deleting from the back doesn't move any instance
+	while (sceneGraph->getInstanceCount() > 0)
+	{
+		InstanceHandle instance = sceneGraph->getHandle(static_cast<uint32_t>(sceneGraph->getInstanceCount() - 1));
+		deleteSceneInstance(instance);
+	}
+
+	std::vector<uint32_t> lightIds;
+	for (const auto& light : lightSources)
+	{
+		lightIds.push_back(light->id);
+	}
+	renderer->removeLightSources(lightIds.data(), lightIds.size());
+	lightSources.clear();
+}
+
+namespace
+{
+	/// <summary>
+	/// Keeps scene IO flag set for the lifetime of a scene coroutine, so it is cleared however the coroutine ends.
+	/// Scene coroutines switch back to the main thread before finishing, so the flag is cleared there.
+	/// </summary>
+	class SceneIoScope
+	{
+	public:
+		explicit SceneIoScope(bool& pending) : pending(pending) { pending = true; }
+		~SceneIoScope() { pending = false; }
+
+		SceneIoScope(const SceneIoScope&) = delete;
+		SceneIoScope& operator=(const SceneIoScope&) = delete;
+
+	private:
+		bool& pending;
+	};
+}
+
+/// <summary>
+/// Takes a snapshot of the scene on the main thread, serialization, compression and writing run on the IO thread.
+/// </summary>
+AsyncTask<void> Application::saveScene(std::string scenePath)
+{
+	if (sceneIoPending) co_return;
+	SceneIoScope ioScope(sceneIoPending);
+
+	SceneData scene;
+	scene.captureInstances(*sceneGraph);
+	for (const auto& light : lightSources)
+	{
+		scene.lights.push_back(SceneLight::fromLight(*light));
+	}
+	scene.camera.type = cameraType;
+	scene.camera.fov = cameraFov;
+	scene.camera.position = camera->getPosition();
+	scene.camera.target = camera->getTarget();
+	scene.skyboxName = skyboxName;
+
+	co_await switchToIo();
+	try
+	{
+		SceneFile::save(scenePath, scene);
+		std::cout << "Scene with " << scene.getInstanceCount() << " instances is saved to \"" << scenePath << "\"" << std::endl;
+	}
+	catch (const std::exception& e)
+	{
+		std::cout << "Scene is not saved: " << e.what() << std::endl;
+	}
+
+	co_await switchToMain();
+}
+
+/// <summary>
+/// Reads scene on the IO thread and hands it over to replaceScene.
+/// </summary>
+AsyncTask<void> Application::loadScene(std::string scenePath)
+{
+	if (sceneIoPending) co_return;
+	SceneIoScope ioScope(sceneIoPending);
+
+	try
+	{
+		co_await switchToIo();
+		SceneData scene = SceneFile::load(scenePath);
+		co_await replaceScene(std::move(scene));
+		std::cout << "Scene is loaded from \"" << scenePath << "\"" << std::endl;
+	}
+	catch (const std::exception& e)
+	{
+		std::cout << "Scene is not loaded: " << e.what() << std::endl;
+	}
+
+	co_await switchToMain();
+}
+
+AsyncTask<void> Application::generateScene(SceneGenerator::Settings settings)
+{
+	if (sceneIoPending) co_return;
+	SceneIoScope ioScope(sceneIoPending);
+
+	try
+	{
+		if (settings.modelNames.empty())
+		{
+			AssetBrowser::ScanForModels(MODEL_ASSETS_FOLDER, c_supportedFormats, settings.modelNames);
+		}
+		co_await switchToWorker();
+		SceneData scene = SceneGenerator::generate(settings);
+		// Generator clamps requested count, so the generated one is reported
+		size_t instanceCount = scene.instanceModels.size();
+		co_await replaceScene(std::move(scene));
+		std::cout << "Scene with " << instanceCount << " instances is generated" << std::endl;
+	}
+	catch (const std::exception& e)
+	{
+		std::cout << "Scene is not generated: " << e.what() << std::endl;
+	}
+
+	co_await switchToMain();
+}
+
+/// <summary>
+/// Imports all models referenced by the scene concurrently. Current scene is replaced only once every model
+/// is imported, then instances are added in batches, yielding to the frame between them. Resumes on the main thread.
+/// </summary>
+AsyncTask<void> Application::replaceScene(SceneData scene)
+{
+	std::vector<AsyncTask<std::shared_ptr<Model>>> imports;
+	imports.reserve(scene.modelNames.size());
+	for (const std::string& modelName : scene.modelNames)
+	{
+		imports.push_back(assetImporter->importModelTask(modelName));
+	}
+	std::vector<std::shared_ptr<Model>> models = co_await whenAll(std::move(imports));
+	co_await switchToMain();
+
+	clearScene();
+
+	size_t count = scene.getInstanceCount();
+	std::vector<InstanceHandle> instances(count);
+	sceneGraph->reserve(count);
+	for (size_t first = 0; first < count; first += c_sceneInstancesPerBatch)
+	{
+		size_t last = std::min(first + c_sceneInstancesPerBatch, count);
+		for (size_t i = first; i < last; i++)
+		{
+			InstanceHandle instance = sceneGraph->addInstance(models[scene.instanceModels[i]], scene.positions[i], scene.rotations[i], scene.scales[i]);
+			if (!(scene.instanceFlags[i] & INSTANCE_VISIBLE))
+			{
+				sceneGraph->setVisible(instance, false);
+			}
+			instances[i] = instance;
+		}
+		sceneBvhStale = true;
+		co_await switchToMain();
+	}
+
+	// Instances might have been deleted by user while batches were being added.
+	// Children get their world matrices with the next transform update.
+	for (size_t i = 0; i < count; i++)
+	{
+		uint32_t parent = scene.instanceParents[i];
+		if (parent != UINT32_MAX && sceneGraph->isValid(instances[i]) && sceneGraph->isValid(instances[parent]))
+		{
+			sceneGraph->setParent(instances[i], instances[parent]);
+		}
+	}
+
+	for (const SceneLight& record : scene.lights)
 	{
-		assetImporter->importModel_async(modelName, [this](std::shared_ptr<Model> model) {
-			const SceneGraphInstance& newInstance = sceneGraph->addInstance(*model);
-			renderer->addToRendererTextured(dynamic_cast<const ModelInstance&>(newInstance));
-		});
+		auto light = std::make_shared<Light>(global_lightId++, Light::POINT);
+		record.apply(*light);
+		if (!renderer->addLightSources(&light, 1))
+		{
+			std::cout << "Renderer light source limit is reached, remaining scene lights are skipped" << std::endl;
+			break;
+		}
+		lightSources.push_back(light);
+	}
+
+	cameraType = static_cast<CameraType>(scene.camera.type);
+	cameraFov = scene.camera.fov;
+	setSceneCamera(cameraType);
+	camera->setPosition(scene.camera.position);
+	camera->lookAt(scene.camera.target);
+
+	if (!scene.skyboxName.empty() && scene.skyboxName != skyboxName)
+	{
+		loadSkybox(scene.skyboxName).detach();
 	}
 }
 
-void Application::onSceneGraphAction(SceneGraphOp action, uint32_t instanceId)
+void Application::onSceneGraphAction(SceneGraphOp action, InstanceHandle instance)
 {
 	switch(action)
 	{
 	case SceneGraphOp::CLONE :
-		cloneSceneInstance(instanceId);
+		cloneSceneInstance(instance);
 		break;
 	case SceneGraphOp::DELETE:
-		deleteSceneInstance(instanceId);
+		deleteSceneInstance(instance);
 		break;
 	case SceneGraphOp::HIDE:
-		hideSceneInstance(instanceId);
+		hideSceneInstance(instance);
 		break;
 	}
 }
 
-void Application::onInstanceTransformChanged(uint32_t id)
+void Application::onInstanceTransformChanged(InstanceHandle instance)
 {
-	const SceneGraphInstance& instance = sceneGraph->getInstance(id);
-	renderer->updateModelTransform(instance.id, instance.getTransformMat());
+	syncSceneTransforms();
+}
+
+void Application::syncSceneTransforms()
+{
+	updatedInstances.clear();
+	// Only instances under changed ones get a new world matrix, renderer gets them through the change journal
+	sceneGraph->updateTransforms(&updatedInstances);
+
+	if (sceneBvhStale)
+	{
+		sceneBvh->build(*sceneGraph);
+		sceneBvhStale = false;
+	}
+	else if (!updatedInstances.empty())
+	{
+		sceneBvh->refit(*sceneGraph, updatedInstances);
+	}
+}
+
+void Application::pickSceneInstance(glm::vec2 viewportPoint)
+{
+	SceneBvh::RayHit hit;
+	if (sceneBvh->raycast(camera->getViewRay(viewportPoint), hit))
+	{
+		sceneGraphWindow->select(hit.instance);
+	}
 }
 
 void Application::imguiMenu()
 {	
+	// Click in the viewport that is not a camera drag picks an instance
+	ImGuiIO& io = ImGui::GetIO();
+	if (!io.WantCaptureMouse && ImGui::IsMouseReleased(ImGuiMouseButton_Left) && io.MouseDragMaxDistanceSqr[0] < 9.0f)
+	{
+		pickSceneInstance(glm::vec2(io.MousePos.x / io.DisplaySize.x, io.MousePos.y / io.DisplaySize.y));
+	}
+
 	// SETTINGS EDITOR WINDOW
 	{
 		ImGui::Begin("vRenderer Settings", nullptr, ImGuiWindowFlags_None);
@@ -310,6 +564,14 @@ void Application::imguiMenu()
 				imgui_helper::ShowRendererSettingsTab(*renderSettings.get());
 				ImGui::EndTabItem();
 			}
+			if (ImGui::BeginTabItem("Import"))
+			{
+				if (imgui_helper::ShowImportSettingsTab(*importSettings))
+				{
+					assetImporter->setImportSettings(*importSettings);
+				}
+				ImGui::EndTabItem();
+			}
 			if (ImGui::BeginTabItem("Camera"))
 			{
 				bool typeChanged, settingsChanged;
@@ -332,15 +594,37 @@ void Application::imguiMenu()
 					
 				ImGui::EndTabItem();
 			}
+			if (ImGui::BeginTabItem("Scene"))
+			{
+				bool save, load;
+				imgui_helper::ShowSceneTab(scenePath, sizeof(scenePath), sceneIoPending, save, load);
+				if (save)
+				{
+					saveScene(scenePath).detach();
+				}
+				if (load)
+				{
+					loadScene(scenePath).detach();
+				}
+
+				ImGui::SeparatorText("Generator");
+				std::vector<std::string> availableModels;
+				AssetBrowser::ScanForModels(MODEL_ASSETS_FOLDER, c_supportedFormats, availableModels);
+				if (imgui_helper::ShowSceneGeneratorSettings(sceneGeneratorSettings, availableModels, sceneIoPending))
+				{
+					generateScene(sceneGeneratorSettings).detach();
+				}
+				ImGui::EndTabItem();
+			}
 			ImGui::EndTabBar();
 		}
 		ImGui::End();
 
 		ImGui::Begin("Inspector", nullptr, ImGuiWindowFlags_None);
-		sceneGraphWindow->Draw(*sceneGraph, [this](SceneGraphOp action, uint32_t instanceId) {
-			onSceneGraphAction(action, instanceId);},
-			[this](uint32_t instanceId) {
-				onInstanceTransformChanged(instanceId);
+		sceneGraphWindow->Draw(*sceneGraph, [this](SceneGraphOp action, InstanceHandle instance) {
+			onSceneGraphAction(action, instance);},
+			[this](InstanceHandle instance) {
+				onInstanceTransformChanged(instance);
 			});
 
 		ImGui::Separator();
@@ -348,18 +632,46 @@ void Application::imguiMenu()
 	}
 
 	imgui_helper::DrawFPSOverlay(currentApi == RenderSettings::API::VULKAN ? "Vulkan" : "OpenGL");
+	if (renderSettings->showThreadingMetrics)
+	{
+		imgui_helper::DrawThreadingOverlay(threadDispatcher->getMetrics());
+	}
 }
 
-int Application::run()
+int Application::run(int argc, char* argv[])
 {
 	loadUserPrefs();
 	currentApi = renderSettings->api;
 
+	ThreadTopology topology = threadTopology;
+	try
+	{
+		topology.applyCommandLine(argc, argv);
+	}
+	catch (const std::exception& e)
+	{
+		// Arguments may have been applied partially, so preferences are used as a whole
+		std::cout << "Invalid thread topology arguments: " << e.what() << std::endl;
+		topology = threadTopology;
+	}
+
 	initWindow(WINDOW_TITLE, WINDOW_WIDTH, WINDOW_HEIGHT);
 
-	if (initApplication() == EXIT_FAILURE)
+	if (initApplication(topology) == EXIT_FAILURE)
 		return EXIT_FAILURE;
 
+	try
+	{
+		if (sceneGeneratorSettings.applyCommandLine(argc, argv))
+		{
+			generateScene(sceneGeneratorSettings).detach();
+		}
+	}
+	catch (const std::exception& e)
+	{
+		std::cout << "Invalid scene generator arguments: " << e.what() << std::endl;
+	}
+
 	float frameTime = 0;
 	while (!glfwWindowShouldClose(window))
 	{
@@ -380,7 +692,7 @@ int Application::run()
 		processInput();
 		update();
 
-		threadDispatcher->process();
+		threadDispatcher->process(renderSettings->mainThreadBudgetMs);
 
 		render();
 	}
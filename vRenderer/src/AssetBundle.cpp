@@ -0,0 +1,316 @@
+#include "AssetBundle.h"
+#include "IImageAssetImporter.h"
+#include "Lz4.h"
+
+#ifdef VRD_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+AssetBundle::AssetBundle(const std::filesystem::path& bundlePath)
+{
+	file = std::make_unique<MappedFile>(bundlePath);
+
+	BinaryReader reader(file->data(), file->size());
+	Header header = reader.read<Header>();
+	if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION)
+	{
+		throw std::runtime_error("\"" + bundlePath.string() + "\" is not an asset bundle or its version is not supported.");
+	}
+	if (header.tocOffset > file->size() || header.tocSize > file->size() - header.tocOffset)
+	{
+		throw std::runtime_error("Asset bundle \"" + bundlePath.string() + "\" is truncated.");
+	}
+
+	BinaryReader tocReader(file->data() + header.tocOffset, header.tocSize);
+	for (uint32_t i = 0; i < header.entryCount; i++)
+	{
+		Entry entry;
+		entry.type = tocReader.read<EntryType>();
+		entry.compression = tocReader.read<Compression>();
+		entry.offset = tocReader.read<uint64_t>();
+		entry.storedSize = tocReader.read<uint64_t>();
+		entry.size = tocReader.read<uint64_t>();
+		entry.name = tocReader.readString();
+
+		if (entry.offset > file->size() || entry.storedSize > file->size() - entry.offset)
+		{
+			throw std::runtime_error("Asset bundle entry \"" + entry.name + "\" points outside of the file.");
+		}
+
+		entries[getEntryKey(entry.type, entry.name)] = std::move(entry);
+	}
+}
+
+bool AssetBundle::contains(EntryType type, const std::string& name) const
+{
+	return entries.find(getEntryKey(type, name)) != entries.end();
+}
+
+std::shared_ptr<Model> AssetBundle::loadModel(const std::string& modelName)
+{
+	// If model is already loaded just return it
+	{
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		if (loadedModels.find(modelName) != loadedModels.end())
+		{
+			return loadedModels[modelName];
+		}
+	}
+
+	std::vector<uint8_t> chunk = readChunk(getEntry(EntryType::MODEL, modelName));
+	BinaryReader reader(chunk.data(), chunk.size());
+
+	uint32_t meshCount = reader.read<uint32_t>();
+	uint32_t materialCount = 0;
+	std::vector<std::shared_ptr<Mesh>> meshes(meshCount);
+	std::vector<std::unique_ptr<Material>> materials(meshCount);
+
+	for (uint32_t i = 0; i < meshCount; i++)
+	{
+		int32_t meshId = reader.read<int32_t>();
+		std::string meshName = reader.readString();
+		auto vertices = reader.readVector<glm::vec3>();
+		auto normals = reader.readVector<glm::vec3>();
+		auto texCoords = reader.readVector<glm::vec2>();
+		auto indices = reader.readVector<uint32_t>();
+
+		auto mesh = std::make_shared<Mesh>(meshId, meshName.c_str(), std::move(vertices), std::move(indices), std::move(texCoords), std::move(normals));
+		{
+			// Identical geometry is shared between models, same as on import from loose files
+			std::lock_guard<std::mutex> lock(cacheMutex);
+			auto it = loadedMeshes.find(mesh->getContentHash());
+			if (it != loadedMeshes.end())
+			{
+				mesh = it->second;
+			}
+			else
+			{
+				loadedMeshes[mesh->getContentHash()] = mesh;
+			}
+		}
+		meshes[i] = mesh;
+
+		if (reader.read<uint8_t>() == 0)
+		{
+			continue;
+		}
+
+		std::string materialName = reader.readString();
+		Material* material = new Material(materialName.c_str());
+		material->shininess = reader.read<float>();
+		material->opacity = reader.read<float>();
+		material->refraction = reader.read<float>();
+		material->ambientColor = reader.read<glm::vec3>();
+		material->diffuseColor = reader.read<glm::vec3>();
+		material->specularColor = reader.read<glm::vec3>();
+		material->emmissiveColor = reader.read<glm::vec3>();
+
+		auto getTexture = [&]() {
+			std::string textureName = reader.readString();
+			return textureName.empty() ? nullptr : loadTexture(textureName);
+		};
+
+		// Order should match the one in AssetBundleBuilder::writeModel
+		material->ambientTexture = getTexture();
+		material->diffuseTexture = getTexture();
+		material->specularTexture = getTexture();
+		material->opacityMap = getTexture();
+		material->emissionMap = getTexture();
+		material->normalMap = getTexture();
+
+		materials[i].reset(material);
+		materialCount++;
+	}
+
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	uint32_t id = loadedModels.size();
+	std::shared_ptr<Model> model = std::make_shared<Model>(id, modelName, std::move(meshes), std::move(materials), materialCount);
+	loadedModels[modelName] = model;
+
+	return model;
+}
+
+std::shared_ptr<Texture> AssetBundle::loadTexture(const std::string& textureName)
+{
+	// If texture is already loaded just return it
+	{
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		if (loadedTextures.find(textureName) != loadedTextures.end())
+		{
+			return loadedTextures[textureName];
+		}
+	}
+
+	std::vector<uint8_t> chunk = readChunk(getEntry(EntryType::TEXTURE, textureName));
+	BinaryReader reader(chunk.data(), chunk.size());
+
+	std::shared_ptr<Texture> texture = std::make_shared<Texture>();
+	readTexture(reader, *texture);
+
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	loadedTextures[textureName] = texture;
+
+	return texture;
+}
+
+std::shared_ptr<Cubemap> AssetBundle::loadCubemap(const std::string& cubemapName)
+{
+	// If cubemap is already loaded just return it
+	{
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		if (loadedCubemaps.find(cubemapName) != loadedCubemaps.end())
+		{
+			return loadedCubemaps[cubemapName];
+		}
+	}
+
+	std::vector<uint8_t> chunk = readChunk(getEntry(EntryType::CUBEMAP, cubemapName));
+	BinaryReader reader(chunk.data(), chunk.size());
+
+	// Faces are stored in c_cubemapFaces order
+	std::shared_ptr<Cubemap> cubemap = std::make_shared<Cubemap>();
+	Texture* faces[] = { &cubemap->back, &cubemap->front, &cubemap->top, &cubemap->bottom, &cubemap->left, &cubemap->right };
+	for (Texture* face : faces)
+	{
+		readTexture(reader, *face);
+	}
+
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	loadedCubemaps[cubemapName] = cubemap;
+
+	return cubemap;
+}
+
+std::string AssetBundle::getEntryKey(EntryType type, const std::string& name)
+{
+	return std::to_string(static_cast<uint32_t>(type)) + ":" + name;
+}
+
+/// <summary>
+/// Compresses chunk data with requested compression.
+/// If compression doesn't reduce the size (or is not available) data is stored as is
+/// and inOutCompression is set to Compression::NONE.
+/// </summary>
+std::vector<uint8_t> AssetBundle::compressChunk(const std::vector<uint8_t>& data, Compression& inOutCompression)
+{
+	std::vector<uint8_t> compressed;
+	size_t compressedSize = 0;
+
+	if (inOutCompression == Compression::LZ4)
+	{
+		compressed.resize(Lz4::compressBound(data.size()));
+		compressedSize = Lz4::compress(data.data(), data.size(), compressed.data(), compressed.size());
+	}
+#ifdef VRD_WITH_ZSTD
+	else if (inOutCompression == Compression::ZSTD)
+	{
+		compressed.resize(ZSTD_compressBound(data.size()));
+		compressedSize = ZSTD_compress(compressed.data(), compressed.size(), data.data(), data.size(), ZSTD_CLEVEL_DEFAULT);
+		if (ZSTD_isError(compressedSize))
+		{
+			compressedSize = 0;
+		}
+	}
+#endif
+
+	if (compressedSize == 0 || compressedSize >= data.size())
+	{
+		inOutCompression = Compression::NONE;
+		return data;
+	}
+
+	compressed.resize(compressedSize);
+	return compressed;
+}
+
+/// <summary>
+/// Returns decompressed data of a chunk pointed by entry.
+/// </summary>
+std::vector<uint8_t> AssetBundle::decompressChunk(const uint8_t* data, const Entry& entry)
+{
+	if (entry.size > getMaxDecompressedSize(entry.compression, entry.storedSize))
+	{
+		throw std::runtime_error("Asset bundle entry \"" + entry.name + "\" is corrupted.");
+	}
+
+	std::vector<uint8_t> chunk(entry.size);
+	bool success = false;
+
+	switch (entry.compression)
+	{
+	case Compression::NONE:
+		success = entry.storedSize == entry.size;
+		if (success && entry.size > 0)
+		{
+			memcpy(chunk.data(), data, entry.size);
+		}
+		break;
+	case Compression::LZ4:
+		success = Lz4::decompress(data, entry.storedSize, chunk.data(), chunk.size());
+		break;
+	case Compression::ZSTD:
+#ifdef VRD_WITH_ZSTD
+		success = ZSTD_decompress(chunk.data(), chunk.size(), data, entry.storedSize) == entry.size;
+		break;
+#else
+		throw std::runtime_error("Asset bundle entry \"" + entry.name + "\" is Zstd compressed, but Zstd support is not compiled in.");
+#endif
+	}
+
+	if (!success)
+	{
+		throw std::runtime_error("Asset bundle entry \"" + entry.name + "\" is corrupted.");
+	}
+
+	return chunk;
+}
+
+/// <summary>
+/// LZ4 sequence encodes at most 255 bytes of match length per input byte.
+/// Zstd RLE block stores up to 128KB in 4 bytes.
+/// </summary>
+uint64_t AssetBundle::getMaxDecompressedSize(Compression compression, uint64_t storedSize)
+{
+	switch (compression)
+	{
+	case Compression::NONE:
+		return storedSize;
+	case Compression::LZ4:
+		return storedSize * 255;
+	case Compression::ZSTD:
+		return storedSize * (128 * 1024 / 4);
+	}
+	return 0;
+}
+
+const AssetBundle::Entry& AssetBundle::getEntry(EntryType type, const std::string& name) const
+{
+	auto it = entries.find(getEntryKey(type, name));
+	if (it == entries.end())
+	{
+		throw std::runtime_error("Asset \"" + name + "\" is not found in asset bundle.");
+	}
+	return it->second;
+}
+
+std::vector<uint8_t> AssetBundle::readChunk(const Entry& entry) const
+{
+	return decompressChunk(file->data() + entry.offset, entry);
+}
+
+void AssetBundle::readTexture(BinaryReader& reader, Texture& outTexture)
+{
+	outTexture.width = reader.read<uint32_t>();
+	outTexture.height = reader.read<uint32_t>();
+	outTexture.contentHash = reader.read<uint64_t>();
+	outTexture.name = reader.readString();
+	outTexture.size = outTexture.width * outTexture.height * 4;
+
+	// Texture releases its data with free()
+	outTexture.ptr = static_cast<uint8_t*>(malloc(outTexture.size));
+	if (outTexture.ptr == nullptr)
+	{
+		throw std::runtime_error("Failed to allocate memory for texture \"" + outTexture.name + "\".");
+	}
+	reader.readBytes(outTexture.ptr, outTexture.size);
+}
\ No newline at end of file
@@ -0,0 +1,261 @@
+#include "AssetBundleBuilder.h"
+
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+
+#include "AssetImporter.h"
+#include "AssimpModelImporter.h"
+#include "ImageImporter.h"
+#include "utils.h"
+
+AssetBundleBuilder::AssetBundleBuilder(AssetBundle::Compression compression) :
+	compression(compression)
+{
+}
+
+void AssetBundleBuilder::addModel(const std::string& modelName, const Model& model)
+{
+	BinaryWriter writer;
+
+	const auto& meshes = model.getMeshes();
+	const auto& materials = model.getMaterials();
+
+	writer.write(static_cast<uint32_t>(meshes.size()));
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		const Mesh& mesh = *meshes[i];
+		writer.write(static_cast<int32_t>(mesh.id));
+		writer.writeString(mesh.name);
+		writer.writeVector(mesh.getVertices());
+		writer.writeVector(mesh.getNormals());
+		writer.writeVector(mesh.getTexCoords());
+		writer.writeVector(mesh.getIndices());
+
+		const Material* material = materials[i].get();
+		writer.write(static_cast<uint8_t>(material != nullptr));
+		if (material == nullptr)
+		{
+			continue;
+		}
+
+		writer.writeString(material->name);
+		writer.write(material->shininess);
+		writer.write(material->opacity);
+		writer.write(material->refraction);
+		writer.write(material->ambientColor);
+		writer.write(material->diffuseColor);
+		writer.write(material->specularColor);
+		writer.write(material->emmissiveColor);
+
+		// Textures are referenced by name of their own chunk
+		auto writeTextureRef = [&](const std::shared_ptr<Texture>& texture) {
+			writer.writeString(texture != nullptr ? addTexture(*texture) : std::string());
+		};
+
+		// Order should match the one in AssetBundle::loadModel
+		writeTextureRef(material->ambientTexture);
+		writeTextureRef(material->diffuseTexture);
+		writeTextureRef(material->specularTexture);
+		writeTextureRef(material->opacityMap);
+		writeTextureRef(material->emissionMap);
+		writeTextureRef(material->normalMap);
+	}
+
+	addChunk(AssetBundle::EntryType::MODEL, modelName, writer.release());
+}
+
+void AssetBundleBuilder::addCubemap(const std::string& cubemapName, const Cubemap& cubemap)
+{
+	BinaryWriter writer;
+
+	// Faces are stored in c_cubemapFaces order
+	const Texture* faces[] = { &cubemap.back, &cubemap.front, &cubemap.top, &cubemap.bottom, &cubemap.left, &cubemap.right };
+	for (const Texture* face : faces)
+	{
+		writeTexture(writer, *face);
+	}
+
+	addChunk(AssetBundle::EntryType::CUBEMAP, cubemapName, writer.release());
+}
+
+void AssetBundleBuilder::write(const std::filesystem::path& bundlePath)
+{
+	std::ofstream out(bundlePath, std::ios::binary | std::ios::trunc);
+	if (!out)
+	{
+		throw std::runtime_error("Failed to open \"" + bundlePath.string() + "\" for writing.");
+	}
+
+	// Header is rewritten once table of contents location is known
+	AssetBundle::Header header = {};
+	memcpy(header.magic, AssetBundle::MAGIC, sizeof(header.magic));
+	header.version = AssetBundle::VERSION;
+	header.entryCount = static_cast<uint32_t>(chunks.size());
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	BinaryWriter toc;
+	uint64_t offset = sizeof(header);
+	for (auto& chunk : chunks)
+	{
+		chunk.entry.offset = offset;
+		out.write(reinterpret_cast<const char*>(chunk.data.data()), chunk.data.size());
+		offset += chunk.data.size();
+
+		toc.write(chunk.entry.type);
+		toc.write(chunk.entry.compression);
+		toc.write(chunk.entry.offset);
+		toc.write(chunk.entry.storedSize);
+		toc.write(chunk.entry.size);
+		toc.writeString(chunk.entry.name);
+	}
+
+	header.tocOffset = offset;
+	header.tocSize = toc.size();
+	out.write(reinterpret_cast<const char*>(toc.data().data()), toc.size());
+
+	out.seekp(0);
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	if (!out)
+	{
+		throw std::runtime_error("Failed to write asset bundle \"" + bundlePath.string() + "\".");
+	}
+}
+
+/// <summary>
+/// Builds a bundle out of every model and cubemap in the assets folder.
+/// Usage: --build-bundle [output path] [--compression none|lz4|zstd]
+/// </summary>
+int AssetBundleBuilder::runFromCommandLine(int argc, char* argv[])
+{
+	namespace fs = std::filesystem;
+
+	fs::path outputPath = ASSET_BUNDLE_FILE;
+	AssetBundle::Compression compression = AssetBundle::Compression::LZ4;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--compression" && i + 1 < argc)
+		{
+			std::string value = argv[++i];
+			if (value == "none") compression = AssetBundle::Compression::NONE;
+			else if (value == "lz4") compression = AssetBundle::Compression::LZ4;
+			else if (value == "zstd") compression = AssetBundle::Compression::ZSTD;
+			else
+			{
+				std::cerr << "Unknown compression \"" << value << "\"." << std::endl;
+				return EXIT_FAILURE;
+			}
+#ifndef VRD_WITH_ZSTD
+			if (compression == AssetBundle::Compression::ZSTD)
+			{
+				std::cerr << "Zstd support is not compiled in, falling back to LZ4." << std::endl;
+				compression = AssetBundle::Compression::LZ4;
+			}
+#endif
+		}
+		else if (arg == "--build-bundle" && i + 1 < argc && argv[i + 1][0] != '-')
+		{
+			outputPath = argv[++i];
+		}
+	}
+
+	try
+	{
+		ThreadTopology topology;
+		GetPrefs("Thread_topology", topology);
+		topology.applyCommandLine(argc, argv);
+		ThreadDispatcher::initialize(topology);
+		AsyncFileReader::initialize();
+
+		AssetBundleBuilder builder(compression);
+		AssimpModelImporter modelImporter;
+		ImageImporter imageImporter;
+
+		// Textures are packed already downscaled to the user's resolution budget
+		ImportSettings importSettings;
+		GetPrefs("Import_settings", importSettings);
+		imageImporter.setImportSettings(importSettings);
+
+		for (const auto& modelFolder : fs::directory_iterator(MODEL_ASSETS_FOLDER))
+		{
+			if (!modelFolder.is_directory()) continue;
+
+			std::string modelName = modelFolder.path().filename().string();
+			for (const auto& file : fs::directory_iterator(modelFolder))
+			{
+				std::string extension = file.path().extension().string();
+				bool isSupported = std::find_if(c_supportedFormats.begin(), c_supportedFormats.end(),
+					[&extension](const char* format) { return extension == format; }) != c_supportedFormats.end();
+				if (file.path().stem() == modelName && isSupported)
+				{
+					std::cout << "Packing model \"" << modelName << "\"" << std::endl;
+					builder.addModel(modelName, *blockingWait(modelImporter.importModel(file.path(), imageImporter, false)));
+					break;
+				}
+			}
+		}
+
+		for (const auto& cubemapFolder : fs::directory_iterator(CUBEMAP_ASSETS_FOLDER))
+		{
+			if (!cubemapFolder.is_directory()) continue;
+
+			std::string cubemapName = cubemapFolder.path().filename().string();
+			std::cout << "Packing cubemap \"" << cubemapName << "\"" << std::endl;
+			builder.addCubemap(cubemapName, *blockingWait(imageImporter.importCubemap(cubemapFolder.path(), false)));
+		}
+
+		builder.write(outputPath);
+		std::cout << "Asset bundle is written to \"" << outputPath.string() << "\"" << std::endl;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "ERROR: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/// <summary>
+/// Adds a texture chunk unless texture with the same content is already added.
+/// Returns the name texture can be referenced by within the bundle.
+/// </summary>
+std::string AssetBundleBuilder::addTexture(const Texture& texture)
+{
+	char name[17];
+	snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(texture.contentHash));
+
+	if (addedTextures.insert(texture.contentHash).second)
+	{
+		BinaryWriter writer;
+		writeTexture(writer, texture);
+		addChunk(AssetBundle::EntryType::TEXTURE, name, writer.release());
+	}
+
+	return name;
+}
+
+void AssetBundleBuilder::addChunk(AssetBundle::EntryType type, const std::string& name, std::vector<uint8_t>&& data)
+{
+	Chunk chunk;
+	chunk.entry.type = type;
+	chunk.entry.name = name;
+	chunk.entry.size = data.size();
+	chunk.entry.compression = compression;
+	chunk.data = AssetBundle::compressChunk(data, chunk.entry.compression);
+	chunk.entry.storedSize = chunk.data.size();
+
+	chunks.push_back(std::move(chunk));
+}
+
+void AssetBundleBuilder::writeTexture(BinaryWriter& writer, const Texture& texture)
+{
+	writer.write(texture.width);
+	writer.write(texture.height);
+	writer.write(texture.contentHash);
+	writer.writeString(texture.name);
+	writer.writeBytes(texture.ptr, texture.size);
+}
\ No newline at end of file
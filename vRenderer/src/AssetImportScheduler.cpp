@@ -0,0 +1,139 @@
+#include "AssetImportScheduler.h"
+
+/// <summary>
+/// Queues work to be run on a worker thread. Work is skipped if token is cancelled before it starts,
+/// and is expected to check the token itself between its stages.
+/// onDropped lets the requester know that work won't run, it is called on a worker thread.
+/// </summary>
+ImportRequestId AssetImportScheduler::schedule(ImportPriority priority, CancellationToken token, Work work, std::function<void()> onDropped)
+{
+	return scheduleDeferred(priority, std::move(token), [work = std::move(work)](const CancellationToken& token, Completion complete) {
+		work(token);
+		complete();
+		}, std::move(onDropped));
+}
+
+/// <summary>
+/// Same as schedule(), but the request only finishes when work's continuation calls the completion it was given.
+/// If work throws, request is completed right away.
+/// </summary>
+ImportRequestId AssetImportScheduler::scheduleDeferred(ImportPriority priority, CancellationToken token, DeferredWork work, std::function<void()> onDropped)
+{
+	ImportRequestId requestId = nextRequestId++;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		requests[requestId] = Request{ priority, token, std::move(work), std::move(onDropped) };
+		queue.insert({ priority, requestId });
+	}
+
+	// Every request gets its own worker slot, but which request runs in it is decided only when the slot is free
+	ThreadDispatcher::instance().worker([this]() { runNext(); });
+
+	return requestId;
+}
+
+/// <summary>
+/// Changes priority of a queued request. Returns false if request has already started or doesn't exist.
+/// </summary>
+bool AssetImportScheduler::setPriority(ImportRequestId requestId, ImportPriority priority)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto it = requests.find(requestId);
+	if (it == requests.end() || it->second.started)
+	{
+		return false;
+	}
+
+	queue.erase({ it->second.priority, requestId });
+	it->second.priority = priority;
+	queue.insert({ priority, requestId });
+	return true;
+}
+
+/// <summary>
+/// Cancels a request. Queued request is dropped right away, running one is stopped at its next stage.
+/// Returns false if request has already finished or doesn't exist.
+/// </summary>
+bool AssetImportScheduler::cancel(ImportRequestId requestId)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto it = requests.find(requestId);
+	if (it == requests.end())
+	{
+		return false;
+	}
+
+	it->second.token.cancel();
+	if (!it->second.started)
+	{
+		// Worker slot of the request is still queued and will find nothing to run, so it is used for the notification
+		if (it->second.onDropped)
+		{
+			ThreadDispatcher::instance().worker(std::move(it->second.onDropped));
+		}
+		queue.erase({ it->second.priority, requestId });
+		requests.erase(it);
+	}
+	return true;
+}
+
+size_t AssetImportScheduler::getQueuedCount() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return queue.size();
+}
+
+void AssetImportScheduler::runNext()
+{
+	ImportRequestId requestId;
+	DeferredWork work;
+	std::function<void()> onDropped;
+	CancellationToken token;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		// Request this slot was created for may have been cancelled meanwhile
+		if (queue.empty())
+		{
+			return;
+		}
+
+		requestId = queue.begin()->second;
+		queue.erase(queue.begin());
+
+		Request& request = requests[requestId];
+		request.started = true;
+		work = std::move(request.work);
+		onDropped = std::move(request.onDropped);
+		token = request.token;
+	}
+
+	if (token.isCancelled())
+	{
+		if (onDropped)
+		{
+			onDropped();
+		}
+		complete(requestId);
+		return;
+	}
+
+	try
+	{
+		work(token, [this, requestId]() { complete(requestId); });
+	}
+	catch (const std::exception& e)
+	{
+		printf("ERROR: Asset import failed. %s\n", e.what());
+		complete(requestId);
+	}
+}
+
+// Request ids are never reused, so completing a request twice is harmless
+void AssetImportScheduler::complete(ImportRequestId requestId)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	requests.erase(requestId);
+}
\ No newline at end of file
@@ -4,11 +4,124 @@ AssetImporter::AssetImporter(IModelAssetImporter* modelImporter, IImageAssetImpo
 {
 	this->modelImporter.reset(modelImporter);
 	this->imageImporter.reset(imageImporter);
-	this->pool = std::make_unique<ThreadPool>(2);
+	this->scheduler = std::make_unique<AssetImportScheduler>();
 }
 
-std::shared_ptr<Model> AssetImporter::importModel(std::string modelName)
+/// <summary>
+/// Changes priority of an import that is still queued. Returns false if it has already started.
+/// </summary>
+bool AssetImporter::setImportPriority(ImportRequestId requestId, ImportPriority priority)
+{
+	return scheduler->setPriority(requestId, priority);
+}
+
+/// <summary>
+/// Cancels an import. Queued import is dropped, running one stops at its next stage.
+/// </summary>
+bool AssetImporter::cancelImport(ImportRequestId requestId)
+{
+	return scheduler->cancel(requestId);
+}
+
+/// <summary>
+/// Suspends coroutine until scheduler gives it a worker slot. Coroutine continues on that worker,
+/// or on the worker notified of the drop if the request got cancelled while queued.
+/// Returned slot keeps the request running, and so cancellable by id, until it is destroyed.
+/// </summary>
+class AssetImporter::ImportSlotAwaiter
+{
+public:
+
+	ImportSlotAwaiter(AssetImportScheduler& scheduler, ImportPriority priority, CancellationToken token) :
+		scheduler(scheduler), priority(priority), token(std::move(token)) {}
+
+	bool await_ready() const noexcept { return token.isCancelled(); }
+
+	void await_suspend(std::coroutine_handle<> handle)
+	{
+		scheduler.scheduleDeferred(priority, token,
+			[this, handle](const CancellationToken&, AssetImportScheduler::Completion complete) {
+				this->complete = std::move(complete);
+				handle.resume();
+			},
+			[handle]() { handle.resume(); });
+	}
+
+	AssetImportScheduler::Slot await_resume()
+	{
+		// Slot is taken before the check, so a request cancelled after it started is still completed
+		AssetImportScheduler::Slot slot(std::move(complete));
+		throwIfCancelled(token);
+		return slot;
+	}
+
+private:
+
+	AssetImportScheduler& scheduler;
+	ImportPriority priority;
+	CancellationToken token;
+	AssetImportScheduler::Completion complete;
+};
+
+AssetImporter::ImportSlotAwaiter AssetImporter::waitForImportSlot(ImportPriority priority, CancellationToken token)
+{
+	return ImportSlotAwaiter(*scheduler, priority, std::move(token));
+}
+
+AsyncTask<std::shared_ptr<Model>> AssetImporter::importModelTask(std::string modelName, ImportPriority priority, CancellationToken token)
+{
+	AssetImportScheduler::Slot slot = co_await waitForImportSlot(priority, token);
+	co_return co_await loadModel(modelName);
+}
+
+AsyncTask<std::shared_ptr<Texture>> AssetImporter::importTextureTask(std::string textureName, TextureRole role, ImportPriority priority, CancellationToken token)
+{
+	AssetImportScheduler::Slot slot = co_await waitForImportSlot(priority, token);
+	co_return co_await loadTexture(textureName, role);
+}
+
+AsyncTask<std::shared_ptr<Cubemap>> AssetImporter::importCubemapTask(std::string cubemapName, ImportPriority priority, CancellationToken token)
+{
+	AssetImportScheduler::Slot slot = co_await waitForImportSlot(priority, token);
+	co_return co_await loadCubemap(cubemapName);
+}
+
+DispatchPriority AssetImporter::getDispatchPriority(ImportPriority priority)
+{
+	return priority == ImportPriority::VISIBLE ? DispatchPriority::NORMAL : DispatchPriority::LOW;
+}
+
+/// <summary>
+/// Applies texture resolution budget to subsequent imports. Already imported textures are kept as they are.
+/// Textures served from a mounted bundle were downscaled when the bundle was built.
+/// </summary>
+void AssetImporter::setImportSettings(const ImportSettings& settings)
+{
+	imageImporter->setImportSettings(settings);
+}
+
+/// <summary>
+/// Mounts an asset bundle. Models and cubemaps present in the bundle are loaded from it
+/// instead of the loose files in assets folder. Texture chunks are named by content hash and
+/// only referenced from model chunks, so standalone texture imports always read loose files.
+/// </summary>
+/// <param name="bundlePath"></param>
+void AssetImporter::mountBundle(std::filesystem::path bundlePath)
 {
+	bundle = std::make_unique<AssetBundle>(bundlePath);
+}
+
+/// <summary>
+/// Imports a model from the mounted bundle or from loose files. File reads are awaited, not waited for,
+/// so the coroutine never blocks a worker on I/O.
+/// </summary>
+AsyncTask<std::shared_ptr<Model>> AssetImporter::loadModel(std::string modelName)
+{
+	if (bundle != nullptr && bundle->contains(AssetBundle::EntryType::MODEL, modelName))
+	{
+		co_return bundle->loadModel(modelName);
+	}
+
 	std::filesystem::path modelFolderPath;
 	for (const auto& modelFolder : std::filesystem::directory_iterator(MODEL_ASSETS_FOLDER))
 	{
@@ -28,12 +141,28 @@ std::shared_ptr<Model> AssetImporter::importModel(std::string modelName)
 		}
 	}
 
-	return modelImporter->importModel(modelFile, *imageImporter, true);
+	co_return co_await modelImporter->importModel(modelFile, *imageImporter, true);
 }
 
-std::shared_ptr<Texture> AssetImporter::importTexture(std::string textureName)
+AsyncTask<std::shared_ptr<Texture>> AssetImporter::loadTexture(std::string textureName, TextureRole role)
 {
-	return imageImporter->importTexture(textureName, true);
+	co_return co_await imageImporter->importTexture(textureName, role, true);
+}
+
+/// <summary>
+/// Imports several textures at once, reading all files before decoding them in parallel.
+/// </summary>
+/// <param name="textureNames"></param>
+/// <returns></returns>
+AsyncTask<std::vector<std::shared_ptr<Texture>>> AssetImporter::loadTextures(std::vector<std::string> textureNames, TextureRole role)
+{
+	std::vector<TextureImportRequest> texturesToImport;
+	for (const std::string& textureName : textureNames)
+	{
+		texturesToImport.push_back({ textureName, role });
+	}
+
+	co_return co_await imageImporter->importTextures(std::move(texturesToImport), true);
 }
 
 /// <summary>
@@ -44,8 +173,36 @@ std::shared_ptr<Texture> AssetImporter::importTexture(std::string textureName)
 /// </summary>
 /// <param name="cubemapName"></param>
 /// <returns></returns>
-std::shared_ptr<Cubemap> AssetImporter::importCubemap(std::string cubemapName)
+AsyncTask<std::shared_ptr<Cubemap>> AssetImporter::loadCubemap(std::string cubemapName)
 {
+	if (bundle != nullptr && bundle->contains(AssetBundle::EntryType::CUBEMAP, cubemapName))
+	{
+		co_return bundle->loadCubemap(cubemapName);
+	}
+
 	std::filesystem::path path = CUBEMAP_ASSETS(cubemapName.c_str());
-	return imageImporter->importCubemap(path, true);
+	co_return co_await imageImporter->importCubemap(path, true);
 }
+
+/// <summary>
+/// Imports a single asset of a batch on its own worker and calls onImported once it is done.
+/// </summary>
+AsyncTask<void> AssetImporter::importAsset(ImportedAsset& asset, CancellationToken token, std::function<void()> onImported)
+{
+	co_await switchToWorker(token);
+
+	switch (asset.request.type)
+	{
+	case AssetRequest::Type::MODEL:
+		asset.model = co_await loadModel(asset.request.name);
+		break;
+	case AssetRequest::Type::TEXTURE:
+		asset.texture = co_await loadTexture(asset.request.name, TextureRole::OTHER);
+		break;
+	case AssetRequest::Type::CUBEMAP:
+		asset.cubemap = co_await loadCubemap(asset.request.name);
+		break;
+	}
+
+	onImported();
+}
\ No newline at end of file
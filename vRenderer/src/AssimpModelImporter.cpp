@@ -1,95 +1,253 @@
 #include "AssimpModelImporter.h"
 
-std::shared_ptr<Model> AssimpModelImporter::importModel(std::filesystem::path modelFilePath, IImageAssetImporter& imageImporter, bool printImportData)
+#include <cstring>
+
+#include "assimp/IOSystem.hpp"
+#include "assimp/MemoryIOWrapper.h"
+
+#include "ThreadDispatcher.h"
+
+/// <summary>
+/// Assimp file system that serves files from memory read by AsyncFileReader.
+/// Files are read in a batch before the import starts. Assimp opens files synchronously,
+/// so any other file it requests is read in place on the importing thread.
+/// </summary>
+class AsyncIOSystem : public Assimp::IOSystem
+{
+public:
+
+	AsyncIOSystem(const std::vector<std::filesystem::path>& filePaths, std::vector<FileData_future>&& reads)
+	{
+		for (size_t i = 0; i < filePaths.size(); i++)
+		{
+			prefetchedFiles[filePaths[i].lexically_normal().string()] = std::move(reads[i]);
+		}
+	}
+
+	bool Exists(const char* pFile) const override
+	{
+		return prefetchedFiles.find(std::filesystem::path(pFile).lexically_normal().string()) != prefetchedFiles.end()
+			|| std::filesystem::exists(pFile);
+	}
+
+	char getOsSeparator() const override
+	{
+		return static_cast<char>(std::filesystem::path::preferred_separator);
+	}
+
+	Assimp::IOStream* Open(const char* pFile, const char* pMode = "rb") override
+	{
+		// Import never writes
+		if (strchr(pMode, 'w') != nullptr || strchr(pMode, 'a') != nullptr)
+		{
+			return nullptr;
+		}
+
+		try
+		{
+			// Prefetched reads are complete by the time import starts, so get() doesn't wait
+			auto it = prefetchedFiles.find(std::filesystem::path(pFile).lexically_normal().string());
+			if (it != prefetchedFiles.end())
+			{
+				FileData data = it->second.get();
+				prefetchedFiles.erase(it);
+				return new BufferIOStream(std::move(data));
+			}
+			return new BufferIOStream(AsyncFileReader::readFileSync(pFile));
+		}
+		catch (const std::runtime_error&)
+		{
+			return nullptr;
+		}
+	}
+
+	void Close(Assimp::IOStream* pFile) override
+	{
+		delete pFile;
+	}
+
+private:
+
+	// Keeps file data alive for the lifetime of the stream reading it
+	struct BufferHolder
+	{
+		FileData data;
+	};
+
+	class BufferIOStream : private BufferHolder, public Assimp::MemoryIOStream
+	{
+	public:
+		BufferIOStream(FileData&& fileData) :
+			BufferHolder{ std::move(fileData) },
+			MemoryIOStream(data.data(), data.size())
+		{
+		}
+	};
+
+	std::unordered_map<std::string, FileData_future> prefetchedFiles;
+};
+
+/// <summary>
+/// Imports a model in stages: model and material files are read first without occupying a worker,
+/// then parsing, texture decoding and mesh conversion run on workers.
+/// </summary>
+AsyncTask<std::shared_ptr<Model>> AssimpModelImporter::importModel(std::filesystem::path modelFilePath, IImageAssetImporter& imageImporter, bool printImportData)
 {
 	// If model is already imported just return it
-	if (importedModelsMap.find(modelFilePath.string()) != importedModelsMap.end())
 	{
-		return importedModelsMap[modelFilePath.string()];
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		if (importedModelsMap.find(modelFilePath.string()) != importedModelsMap.end())
+		{
+			co_return importedModelsMap[modelFilePath.string()];
+		}
+	}
+
+	// Model file is read along with material libraries next to it, since those are requested right after it
+	std::vector<std::filesystem::path> filesToPrefetch = { modelFilePath };
+	for (const auto& file : std::filesystem::directory_iterator(modelFilePath.parent_path()))
+	{
+		if (file.path().extension() == ".mtl")
+		{
+			filesToPrefetch.push_back(file.path());
+		}
 	}
+	std::vector<FileData_future> reads = co_await readFiles(filesToPrefetch);
+	AsyncIOSystem* ioSystem = new AsyncIOSystem(filesToPrefetch, std::move(reads));
 
+	// Importer takes ownership of the IO system
 	Assimp::Importer importer;
+	importer.SetIOHandler(ioSystem);
 	const aiScene* scene = importer.ReadFile(modelFilePath.string(), ASSIMP_PREPROCESS_FLAGS);
-
-	uint32_t meshCount = scene->mNumMeshes;
-	uint32_t materialCount = 0;
-	std::vector<std::unique_ptr<Mesh>> meshes(meshCount);
-	std::vector<std::unique_ptr<Material>> materials(meshCount);
-
-	// Import meshes and textures
-	for (int i = 0; i < scene->mNumMeshes; i++)
+	if (scene == nullptr)
 	{
-		auto meshData = scene->mMeshes[i];
-		std::vector<glm::vec3> vertices(meshData->mNumVertices);
-		std::vector<glm::vec3> normals(meshData->mNumVertices);
-		std::vector<glm::vec2> texCoords(meshData->mNumVertices);
-		std::vector<uint32_t> indices(meshData->mNumFaces * 3);
-		for (int j = 0; j < meshData->mNumVertices; j++)
+		throw std::runtime_error("Failed to import model \"" + modelFilePath.filename().string() + "\": " + importer.GetErrorString());
+	}
+
+	// Read and decode all textures referenced by materials in one batch.
+	// Materials below pick them from the batch result.
+	std::string folderPath = modelFilePath.parent_path().string();
+	auto getTexturePath = [&folderPath](const aiMaterial* mat, aiTextureType type, std::string& outPath) {
+		aiString path;
+		if (mat->GetTexture(type, 0, &path) != aiReturn_SUCCESS)
 		{
-			vertices[j] = glm::vec3(meshData->mVertices[j].x, meshData->mVertices[j].y, meshData->mVertices[j].z);
-			normals[j] = glm::vec3(meshData->mNormals[j].x, meshData->mNormals[j].y, meshData->mNormals[j].z);
-			texCoords[j] = glm::vec2(meshData->mTextureCoords[0][j].x, meshData->mTextureCoords[0][j].y);
+			return false;
 		}
-		for (int j = 0; j < meshData->mNumFaces; j++)
+		outPath = path.C_Str();
+		std::replace(outPath.begin(), outPath.end(), '/', '\\');
+		outPath = folderPath + "\\" + outPath;
+		return true;
+	};
+
+	// Role decides which resolution budget applies to the texture
+	const std::pair<aiTextureType, TextureRole> c_materialTextureTypes[] = {
+		{ aiTextureType_DIFFUSE, TextureRole::DIFFUSE },
+		{ aiTextureType_SPECULAR, TextureRole::SPECULAR },
+		{ aiTextureType_AMBIENT, TextureRole::AMBIENT },
+		{ aiTextureType_EMISSIVE, TextureRole::EMISSION },
+		{ aiTextureType_NORMALS, TextureRole::NORMAL },
+		{ aiTextureType_OPACITY, TextureRole::OPACITY } };
+	std::vector<TextureImportRequest> textureRequests;
+	for (uint32_t i = 0; i < scene->mNumMaterials; i++)
+	{
+		for (const auto& [type, role] : c_materialTextureTypes)
 		{
-			auto face = meshData->mFaces[j];
-			indices[j * 3] = face.mIndices[0] + VERTEX_INDEX_OFFSET;
-			indices[j * 3 + 1] = face.mIndices[1] + VERTEX_INDEX_OFFSET;
-			indices[j * 3 + 2] = face.mIndices[2] + VERTEX_INDEX_OFFSET;
+			std::string texturePath;
+			if (getTexturePath(scene->mMaterials[i], type, texturePath)
+				&& std::find_if(textureRequests.begin(), textureRequests.end(), [&](const TextureImportRequest& request) {
+					return request.role == role && request.path == texturePath; }) == textureRequests.end())
+			{
+				textureRequests.push_back({ texturePath, role });
+			}
 		}
+	}
+	std::vector<std::shared_ptr<Texture>> textures = co_await imageImporter.importTextures(textureRequests, false);
 
-		meshes[i].reset(new Mesh(i, meshData->mName.C_Str(), vertices, indices, texCoords, normals));
+	uint32_t meshCount = scene->mNumMeshes;
+	uint32_t materialCount = 0;
+	std::vector<std::shared_ptr<Mesh>> meshes(meshCount);
+	std::vector<std::unique_ptr<Material>> materials(meshCount);
 
-		// Create a material if one is assigned to the mesh
-		if (meshData->mMaterialIndex >= 0)
+	// Import meshes and materials. Meshes are converted and hashed in parallel,
+	// textures are already imported at this point, so materials only look them up.
+	ThreadDispatcher::instance().parallel_for(0, meshCount, 1, [&](size_t first, size_t last) {
+		for (size_t i = first; i < last; i++)
 		{
-			auto mat = scene->mMaterials[meshData->mMaterialIndex];
-			std::string folderPath = modelFilePath.parent_path().string();
+			auto meshData = scene->mMeshes[i];
+			std::vector<glm::vec3> vertices(meshData->mNumVertices);
+			std::vector<glm::vec3> normals(meshData->mNumVertices);
+			std::vector<glm::vec2> texCoords(meshData->mNumVertices);
+			std::vector<uint32_t> indices(meshData->mNumFaces * 3);
+			for (int j = 0; j < meshData->mNumVertices; j++)
+			{
+				vertices[j] = glm::vec3(meshData->mVertices[j].x, meshData->mVertices[j].y, meshData->mVertices[j].z);
+				normals[j] = glm::vec3(meshData->mNormals[j].x, meshData->mNormals[j].y, meshData->mNormals[j].z);
+				texCoords[j] = glm::vec2(meshData->mTextureCoords[0][j].x, meshData->mTextureCoords[0][j].y);
+			}
+			for (int j = 0; j < meshData->mNumFaces; j++)
+			{
+				auto face = meshData->mFaces[j];
+				indices[j * 3] = face.mIndices[0] + VERTEX_INDEX_OFFSET;
+				indices[j * 3 + 1] = face.mIndices[1] + VERTEX_INDEX_OFFSET;
+				indices[j * 3 + 2] = face.mIndices[2] + VERTEX_INDEX_OFFSET;
+			}
 
-			// Texture loading lambda
-			auto getTexture = [&mat, &folderPath, &imageImporter](aiTextureType type) {
-				aiString path;
-				std::shared_ptr<Texture> texture = nullptr;
-				if (mat->GetTexture(type, 0, &path) == aiReturn_SUCCESS)
-				{
-					std::string s = path.C_Str();
-					std::replace(s.begin(), s.end(), '/', '\\');
-					s = folderPath + "\\" + s;
-					texture = imageImporter.importTexture(s, false);
-				}
-				return texture;
-				};
+			meshes[i] = getSharedMesh(std::make_unique<Mesh>(i, meshData->mName.C_Str(), std::move(vertices), std::move(indices), std::move(texCoords), std::move(normals)));
+
+			// Create a material if one is assigned to the mesh
+			if (meshData->mMaterialIndex >= 0)
+			{
+				auto mat = scene->mMaterials[meshData->mMaterialIndex];
+
+				// Texture loading lambda
+				auto getTexture = [&mat, &getTexturePath, &textureRequests, &textures](aiTextureType type, TextureRole role) {
+					std::string texturePath;
+					std::shared_ptr<Texture> texture = nullptr;
+					if (getTexturePath(mat, type, texturePath))
+					{
+						auto it = std::find_if(textureRequests.begin(), textureRequests.end(), [&](const TextureImportRequest& request) {
+							return request.role == role && request.path == texturePath; });
+						texture = textures[it - textureRequests.begin()];
+					}
+					return texture;
+					};
 			
-			Material* material = new Material(mat->GetName().C_Str());
-
-			material->diffuseTexture = getTexture(aiTextureType_DIFFUSE);
-			material->specularTexture = getTexture(aiTextureType_SPECULAR);
-			material->ambientTexture = getTexture(aiTextureType_AMBIENT);
-			material->emissionMap = getTexture(aiTextureType_EMISSIVE);
-			material->normalMap = getTexture(aiTextureType_NORMALS);
-			material->opacityMap = getTexture(aiTextureType_OPACITY);
-
-			mat->Get(AI_MATKEY_SHININESS, material->shininess);
-			mat->Get(AI_MATKEY_REFRACTI, material->refraction);
-			if (material->opacityMap == nullptr)
-				mat->Get(AI_MATKEY_OPACITY, material->opacity);
-
-			auto getColor = [&](const char* key, uint32_t type, uint32_t idx, glm::vec3& color) {
-				aiColor3D aiColor;
-				mat->Get(key, type, idx, aiColor);
-				color = glm::vec3(aiColor.r, aiColor.g, aiColor.b);
-				};
-
-			if (material->ambientTexture == nullptr)
-				getColor(AI_MATKEY_COLOR_AMBIENT, material->ambientColor);
-			if (material->diffuseTexture == nullptr)
-				getColor(AI_MATKEY_COLOR_DIFFUSE, material->diffuseColor);
-			if (material->specularTexture == nullptr)
-				getColor(AI_MATKEY_COLOR_SPECULAR, material->specularColor);
-			if (material->emissionMap == nullptr)
-				getColor(AI_MATKEY_COLOR_EMISSIVE, material->emmissiveColor);
-
-			materials[i].reset(material);
+				Material* material = new Material(mat->GetName().C_Str());
+
+				material->diffuseTexture = getTexture(aiTextureType_DIFFUSE, TextureRole::DIFFUSE);
+				material->specularTexture = getTexture(aiTextureType_SPECULAR, TextureRole::SPECULAR);
+				material->ambientTexture = getTexture(aiTextureType_AMBIENT, TextureRole::AMBIENT);
+				material->emissionMap = getTexture(aiTextureType_EMISSIVE, TextureRole::EMISSION);
+				material->normalMap = getTexture(aiTextureType_NORMALS, TextureRole::NORMAL);
+				material->opacityMap = getTexture(aiTextureType_OPACITY, TextureRole::OPACITY);
+
+				mat->Get(AI_MATKEY_SHININESS, material->shininess);
+				mat->Get(AI_MATKEY_REFRACTI, material->refraction);
+				if (material->opacityMap == nullptr)
+					mat->Get(AI_MATKEY_OPACITY, material->opacity);
+
+				auto getColor = [&](const char* key, uint32_t type, uint32_t idx, glm::vec3& color) {
+					aiColor3D aiColor;
+					mat->Get(key, type, idx, aiColor);
+					color = glm::vec3(aiColor.r, aiColor.g, aiColor.b);
+					};
+
+				if (material->ambientTexture == nullptr)
+					getColor(AI_MATKEY_COLOR_AMBIENT, material->ambientColor);
+				if (material->diffuseTexture == nullptr)
+					getColor(AI_MATKEY_COLOR_DIFFUSE, material->diffuseColor);
+				if (material->specularTexture == nullptr)
+					getColor(AI_MATKEY_COLOR_SPECULAR, material->specularColor);
+				if (material->emissionMap == nullptr)
+					getColor(AI_MATKEY_COLOR_EMISSIVE, material->emmissiveColor);
+
+				materials[i].reset(material);
+			}
+		}
+		});
+	for (const auto& material : materials)
+	{
+		if (material != nullptr)
+		{
 			materialCount++;
 		}
 	}
@@ -111,7 +269,7 @@ std::shared_ptr<Model> AssimpModelImporter::importModel(std::filesystem::path mo
 	}
 
 	// Assuming GLMaterial has a member 'opacity' (float or similar)
-	auto sortByOpacity = [](std::vector<std::unique_ptr<Mesh>>& meshes, std::vector<std::unique_ptr<Material>>& materials) {
+	auto sortByOpacity = [](std::vector<std::shared_ptr<Mesh>>& meshes, std::vector<std::unique_ptr<Material>>& materials) {
 		// Check if vectors are the same size (1:1 relation)
 		if (meshes.size() != materials.size()) {
 			throw std::runtime_error("Vectors must have the same size for sorting");
@@ -129,7 +287,7 @@ std::shared_ptr<Model> AssimpModelImporter::importModel(std::filesystem::path mo
 		);
 
 		// Apply the sorted indices to both vectors
-		std::vector< std::unique_ptr<Mesh>> sortedMeshes(meshes.size());
+		std::vector< std::shared_ptr<Mesh>> sortedMeshes(meshes.size());
 		std::vector< std::unique_ptr<Material>> sortedMaterials(materials.size());
 		sortedMeshes.reserve(meshes.size());
 		sortedMaterials.reserve(materials.size());
@@ -147,9 +305,29 @@ std::shared_ptr<Model> AssimpModelImporter::importModel(std::filesystem::path mo
 	// Usage:
 	sortByOpacity(meshes, materials);
 
+	std::lock_guard<std::mutex> lock(cacheMutex);
 	uint32_t id = importedModelsMap.size();
 	std::shared_ptr<Model> newModel = std::make_shared<Model>(id, modelFilePath.stem().string(), std::move(meshes), std::move(materials), materialCount);
 	importedModelsMap[modelFilePath.string()] = newModel;
 
-	return newModel;
+	co_return newModel;
+}
+
+/// <summary>
+/// Returns an already imported mesh with identical content if there is one.
+/// Otherwise the provided mesh is registered and returned as shared.
+/// </summary>
+std::shared_ptr<Mesh> AssimpModelImporter::getSharedMesh(std::unique_ptr<Mesh> mesh)
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+
+	auto it = importedMeshesMap.find(mesh->getContentHash());
+	if (it != importedMeshesMap.end())
+	{
+		return it->second;
+	}
+
+	std::shared_ptr<Mesh> sharedMesh = std::move(mesh);
+	importedMeshesMap[sharedMesh->getContentHash()] = sharedMesh;
+	return sharedMesh;
 }
\ No newline at end of file
@@ -0,0 +1,514 @@
+#include "AsyncFileReader.h"
+#include "ThreadDispatcher.h"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <atomic>
+
+#if defined(__linux__) && defined(VRD_ENABLE_IO_URING)
+#define VRD_IO_URING_BACKEND
+#include <deque>
+#include <unordered_set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+static std::runtime_error readError(const std::filesystem::path& filePath)
+{
+	return std::runtime_error("Failed to read file \"" + filePath.string() + "\".");
+}
+
+/// <summary>
+/// Shared by all reads of a batch started with a continuation.
+/// The read that finishes last hands the futures over to a worker thread.
+/// </summary>
+struct AsyncFileReader::BatchContinuation
+{
+	std::vector<FileData_future> futures;
+	std::function<void(std::vector<FileData_future>)> onRead;
+	std::atomic<size_t> pendingCount = 0;
+
+	static void readDone(const std::shared_ptr<BatchContinuation>& continuation)
+	{
+		if (continuation == nullptr || continuation->pendingCount.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		{
+			return;
+		}
+		ThreadDispatcher::instance().worker([continuation]() {
+			continuation->onRead(std::move(continuation->futures));
+			});
+	}
+};
+
+#ifdef VRD_IO_URING_BACKEND
+
+/// <summary>
+/// io_uring based reader. Owns a ring and a thread that feeds it: every iteration all pending reads are
+/// submitted with a single io_uring_enter call, which also waits for at least one completion.
+/// If io_uring_enter fails with a hard error, all requests are failed, the thread stops and submit() refuses further ones.
+/// Raw syscalls are used so the build doesn't depend on liburing.
+/// </summary>
+class AsyncFileReader::IoUringBackend
+{
+public:
+
+	struct Request
+	{
+		std::filesystem::path path;
+		std::promise<FileData> promise;
+		std::shared_ptr<BatchContinuation> continuation;
+		FileData data;
+		int fd = -1;
+		size_t offset = 0;
+	};
+
+	IoUringBackend(uint32_t queueDepth)
+	{
+		io_uring_params params = {};
+		ringFd = static_cast<int>(syscall(__NR_io_uring_setup, queueDepth, &params));
+		if (ringFd < 0)
+		{
+			throw std::runtime_error("io_uring is not available: " + std::string(strerror(errno)));
+		}
+
+		sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+		cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+		if (singleMmap)
+		{
+			sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+		}
+
+		sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+		cqRing = singleMmap ? sqRing : mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+		sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+		sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES));
+		if (sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqes == MAP_FAILED)
+		{
+			close(ringFd);
+			throw std::runtime_error("Failed to map io_uring queues.");
+		}
+
+		uint8_t* sq = static_cast<uint8_t*>(sqRing);
+		sqHead = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+		sqTail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+		sqMask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+		sqArray = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+		sqEntries = params.sq_entries;
+
+		uint8_t* cq = static_cast<uint8_t*>(cqRing);
+		cqHead = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+		cqTail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+		cqMask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+		cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+		thread = std::thread(&IoUringBackend::run, this);
+	}
+
+	~IoUringBackend()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+		}
+		condition.notify_one();
+		thread.join();
+
+		munmap(sqes, sqesSize);
+		if (cqRing != sqRing)
+		{
+			munmap(cqRing, cqRingSize);
+		}
+		munmap(sqRing, sqRingSize);
+		close(ringFd);
+
+		for (Request* request : abandoned)
+		{
+			delete request;
+		}
+	}
+
+	// Returns false if the ring has failed, requests are left to the caller then
+	bool submit(const std::vector<Request*>& requests)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (failed)
+			{
+				return false;
+			}
+			incoming.insert(incoming.end(), requests.begin(), requests.end());
+		}
+		condition.notify_one();
+		return true;
+	}
+
+	bool hasFailed() const
+	{
+		return failed.load(std::memory_order_acquire);
+	}
+
+private:
+
+	int ringFd = -1;
+
+	void* sqRing = nullptr;
+	void* cqRing = nullptr;
+	size_t sqRingSize = 0;
+	size_t cqRingSize = 0;
+	size_t sqesSize = 0;
+
+	uint32_t* sqHead = nullptr;
+	uint32_t* sqTail = nullptr;
+	uint32_t* sqArray = nullptr;
+	uint32_t sqMask = 0;
+	uint32_t sqEntries = 0;
+	io_uring_sqe* sqes = nullptr;
+
+	uint32_t* cqHead = nullptr;
+	uint32_t* cqTail = nullptr;
+	uint32_t cqMask = 0;
+	io_uring_cqe* cqes = nullptr;
+
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::vector<Request*> incoming;
+	bool stop = false;
+	std::atomic<bool> failed = false;
+
+	// Only touched by the ring thread
+	std::unordered_set<Request*> inFlight;
+	// In-flight requests failed after a hard error, kept alive until the ring is closed as the kernel may still write to them
+	std::vector<Request*> abandoned;
+
+	void run()
+	{
+		// Requests ready to be (re)submitted. Reads that complete partially are put back here.
+		std::deque<Request*> pending;
+
+		while (true)
+		{
+			std::vector<Request*> newRequests;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				if (inFlight.empty() && pending.empty())
+				{
+					condition.wait(lock, [this] { return stop || !incoming.empty(); });
+				}
+				if (stop && incoming.empty() && inFlight.empty() && pending.empty())
+				{
+					break;
+				}
+				std::swap(newRequests, incoming);
+			}
+
+			for (Request* request : newRequests)
+			{
+				if (open(*request))
+				{
+					pending.push_back(request);
+				}
+			}
+
+			uint32_t tail = *sqTail;
+			while (!pending.empty() && inFlight.size() < sqEntries)
+			{
+				Request* request = pending.front();
+				pending.pop_front();
+
+				uint32_t index = tail & sqMask;
+				io_uring_sqe& sqe = sqes[index];
+				memset(&sqe, 0, sizeof(sqe));
+				sqe.opcode = IORING_OP_READ;
+				sqe.fd = request->fd;
+				sqe.addr = reinterpret_cast<uint64_t>(request->data.data() + request->offset);
+				sqe.len = static_cast<uint32_t>(std::min<size_t>(request->data.size() - request->offset, 1u << 30));
+				sqe.off = request->offset;
+				sqe.user_data = reinterpret_cast<uint64_t>(request);
+				sqArray[index] = index;
+
+				tail++;
+				inFlight.insert(request);
+			}
+			__atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+
+			if (inFlight.empty())
+			{
+				continue;
+			}
+
+			// Submit everything kernel hasn't consumed yet and wait for at least one completion
+			uint32_t toSubmit = tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+			int result = static_cast<int>(syscall(__NR_io_uring_enter, ringFd, toSubmit, 1, IORING_ENTER_GETEVENTS, nullptr, 0));
+			int error = errno;
+			if (result < 0 && error != EINTR && error != EAGAIN && error != EBUSY)
+			{
+				std::cerr << "io_uring_enter failed: " << strerror(error) << ". Falling back to I/O pool file reads." << std::endl;
+				failAll(pending);
+				return;
+			}
+
+			uint32_t head = *cqHead;
+			uint32_t completedTail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+			while (head != completedTail)
+			{
+				const io_uring_cqe& cqe = cqes[head & cqMask];
+				Request* request = reinterpret_cast<Request*>(cqe.user_data);
+				int bytesRead = cqe.res;
+				head++;
+				inFlight.erase(request);
+
+				if (bytesRead == -EAGAIN || bytesRead == -EINTR)
+				{
+					pending.push_back(request);
+				}
+				else if (bytesRead < 0)
+				{
+					fail(request);
+				}
+				else
+				{
+					request->offset += bytesRead;
+					// Zero bytes read means the file got shorter since it was opened
+					if (bytesRead == 0)
+					{
+						request->data.resize(request->offset);
+					}
+
+					if (request->offset < request->data.size())
+					{
+						pending.push_back(request);
+					}
+					else
+					{
+						complete(request);
+					}
+				}
+			}
+			__atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+		}
+	}
+
+	bool open(Request& request)
+	{
+		request.fd = ::open(request.path.c_str(), O_RDONLY | O_CLOEXEC);
+		struct stat fileStat;
+		if (request.fd < 0 || fstat(request.fd, &fileStat) != 0)
+		{
+			fail(&request);
+			return false;
+		}
+
+		request.data.resize(static_cast<size_t>(fileStat.st_size));
+		if (request.data.empty())
+		{
+			complete(&request);
+			return false;
+		}
+		return true;
+	}
+
+	void complete(Request* request)
+	{
+		close(request->fd);
+		request->promise.set_value(std::move(request->data));
+		BatchContinuation::readDone(request->continuation);
+		delete request;
+	}
+
+	void fail(Request* request)
+	{
+		reject(*request);
+		delete request;
+	}
+
+	void reject(Request& request)
+	{
+		if (request.fd >= 0)
+		{
+			close(request.fd);
+		}
+		request.promise.set_exception(std::make_exception_ptr(readError(request.path)));
+		BatchContinuation::readDone(request.continuation);
+	}
+
+	/// <summary>
+	/// Fails every request the ring holds after a hard error. New requests are refused from now on,
+	/// so callers serve them from the I/O pool instead.
+	/// </summary>
+	void failAll(std::deque<Request*>& pending)
+	{
+		std::vector<Request*> newRequests;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			failed.store(true, std::memory_order_release);
+			std::swap(newRequests, incoming);
+		}
+
+		for (Request* request : newRequests)
+		{
+			fail(request);
+		}
+		for (Request* request : pending)
+		{
+			fail(request);
+		}
+		pending.clear();
+
+		for (Request* request : inFlight)
+		{
+			reject(*request);
+			abandoned.push_back(request);
+		}
+		inFlight.clear();
+	}
+};
+
+#else
+
+// io_uring is not compiled in, I/O pool is always used
+class AsyncFileReader::IoUringBackend {};
+
+#endif
+
+AsyncFileReader::AsyncFileReader()
+{
+#ifdef VRD_IO_URING_BACKEND
+	try
+	{
+		ioUring = std::make_unique<IoUringBackend>(256);
+	}
+	catch (const std::runtime_error& e)
+	{
+		std::cout << e.what() << " Falling back to I/O pool file reads." << std::endl;
+	}
+#endif
+}
+
+AsyncFileReader::~AsyncFileReader() = default;
+
+FileData_future AsyncFileReader::read(const std::filesystem::path& filePath)
+{
+	return std::move(readBatch({ filePath })[0]);
+}
+
+/// <summary>
+/// Starts reading of all provided files at once. Futures are returned in the same order as paths.
+/// </summary>
+std::vector<FileData_future> AsyncFileReader::readBatch(const std::vector<std::filesystem::path>& filePaths)
+{
+	return startReads(filePaths, nullptr);
+}
+
+/// <summary>
+/// Starts reading of all provided files at once and calls onRead on a worker thread once all of them are read.
+/// Futures are passed in the same order as paths and are ready, so get() never blocks.
+/// </summary>
+void AsyncFileReader::readBatch(const std::vector<std::filesystem::path>& filePaths, std::function<void(std::vector<FileData_future>)> onRead)
+{
+	auto continuation = std::make_shared<BatchContinuation>();
+	continuation->onRead = std::move(onRead);
+	// Extra count keeps reads that finish right away from running the continuation before futures are stored
+	continuation->pendingCount = filePaths.size() + 1;
+	continuation->futures = startReads(filePaths, continuation);
+	BatchContinuation::readDone(continuation);
+}
+
+std::vector<FileData_future> AsyncFileReader::startReads(const std::vector<std::filesystem::path>& filePaths, const std::shared_ptr<BatchContinuation>& continuation)
+{
+	std::vector<FileData_future> futures;
+	futures.reserve(filePaths.size());
+
+#ifdef VRD_IO_URING_BACKEND
+	if (ioUring != nullptr && !ioUring->hasFailed())
+	{
+		std::vector<IoUringBackend::Request*> requests;
+		requests.reserve(filePaths.size());
+		for (const auto& filePath : filePaths)
+		{
+			auto* request = new IoUringBackend::Request();
+			request->path = filePath;
+			request->continuation = continuation;
+			futures.push_back(request->promise.get_future());
+			requests.push_back(request);
+		}
+		if (ioUring->submit(requests))
+		{
+			return futures;
+		}
+
+		// Ring has failed meanwhile
+		for (IoUringBackend::Request* request : requests)
+		{
+			readOnIoPool(std::move(request->promise), request->path, continuation);
+			delete request;
+		}
+		return futures;
+	}
+#endif
+
+	for (const auto& filePath : filePaths)
+	{
+		std::promise<FileData> promise;
+		futures.push_back(promise.get_future());
+		readOnIoPool(std::move(promise), filePath, continuation);
+	}
+	return futures;
+}
+
+void AsyncFileReader::readOnIoPool(std::promise<FileData>&& promise, const std::filesystem::path& filePath, const std::shared_ptr<BatchContinuation>& continuation)
+{
+	auto sharedPromise = std::make_shared<std::promise<FileData>>(std::move(promise));
+	ThreadDispatcher::instance().io([sharedPromise, filePath, continuation]() {
+		try
+		{
+			sharedPromise->set_value(readFileSync(filePath));
+		}
+		catch (...)
+		{
+			sharedPromise->set_exception(std::current_exception());
+		}
+		BatchContinuation::readDone(continuation);
+		});
+}
+
+bool AsyncFileReader::isIoUringEnabled() const
+{
+#ifdef VRD_IO_URING_BACKEND
+	return ioUring != nullptr && !ioUring->hasFailed();
+#else
+	return ioUring != nullptr;
+#endif
+}
+
+FileData AsyncFileReader::readFileSync(const std::filesystem::path& filePath)
+{
+	std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+	{
+		throw readError(filePath);
+	}
+
+	size_t fileSize = static_cast<size_t>(file.tellg());
+	FileData data(fileSize);
+
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(data.data()), fileSize);
+	if (!file)
+	{
+		throw readError(filePath);
+	}
+
+	return data;
+}
\ No newline at end of file
@@ -48,6 +48,11 @@ glm::vec3 BaseCamera::getPosition() const
 	return position;
 }
 
+glm::vec3 BaseCamera::getTarget() const
+{
+	return target;
+}
+
 glm::mat4 BaseCamera::getProjectionMatrix() const
 {
 	glm::mat4 projectionMat = glm::perspective(glm::radians((float)fovAngles), (float)viewportWidth / (float)viewportHeight, znear, zfar);
@@ -61,6 +66,20 @@ glm::mat4 BaseCamera::getViewMatrix() const
 	return glm::lookAt(position, target, up);
 }
 
+Frustum BaseCamera::getFrustum() const
+{
+	return Frustum::fromViewProjection(getProjectionMatrix() * getViewMatrix());
+}
+
+Ray BaseCamera::getViewRay(glm::vec2 viewportPoint) const
+{
+	// Flipped projection has NDC y pointing down, like the viewport
+	glm::vec2 ndc(viewportPoint.x * 2.0f - 1.0f, flipY ? viewportPoint.y * 2.0f - 1.0f : 1.0f - viewportPoint.y * 2.0f);
+	// Far plane is at NDC depth 1 for both clip space depth conventions
+	glm::vec4 farPoint = glm::inverse(getProjectionMatrix() * getViewMatrix()) * glm::vec4(ndc, 1.0f, 1.0f);
+	return { position, glm::normalize(glm::vec3(farPoint) / farPoint.w - position) };
+}
+
 void BaseCamera::recalculateDirectionVectors()
 {
 	forward = glm::normalize(target - position);
@@ -0,0 +1,83 @@
+#include "FrustumCuller.h"
+#include "ThreadDispatcher.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VRD_CULLER_SSE2
+#include <emmintrin.h>
+#endif
+
+// Below this many spheres culling runs on the calling thread
+static constexpr size_t c_parallelCullThreshold = 8192;
+static constexpr size_t c_spheresPerTask = 4096;
+
+/// <summary>
+/// Each task culls its own range into a separate list, lists are concatenated in range order.
+/// </summary>
+void FrustumCuller::cull(const glm::vec4* spheres, size_t count, const Frustum& frustum, std::vector<uint32_t>& visible)
+{
+	visible.clear();
+	if (count < c_parallelCullThreshold)
+	{
+		cullRange(spheres, 0, count, frustum, visible);
+		return;
+	}
+
+	std::vector<std::vector<uint32_t>> rangeVisible((count + c_spheresPerTask - 1) / c_spheresPerTask);
+	ThreadDispatcher::instance().parallel_for(0, count, c_spheresPerTask, [&](size_t first, size_t last) {
+		cullRange(spheres, first, last, frustum, rangeVisible[first / c_spheresPerTask]);
+		});
+	for (const std::vector<uint32_t>& range : rangeVisible)
+	{
+		visible.insert(visible.end(), range.begin(), range.end());
+	}
+}
+
+void FrustumCuller::cullRange(const glm::vec4* spheres, size_t first, size_t last, const Frustum& frustum, std::vector<uint32_t>& visible)
+{
+	size_t i = first;
+#ifdef VRD_CULLER_SSE2
+	__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+	for (int p = 0; p < 6; p++)
+	{
+		planeX[p] = _mm_set1_ps(frustum.planes[p].x);
+		planeY[p] = _mm_set1_ps(frustum.planes[p].y);
+		planeZ[p] = _mm_set1_ps(frustum.planes[p].z);
+		planeW[p] = _mm_set1_ps(frustum.planes[p].w);
+	}
+
+	for (; i + 4 <= last; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(&spheres[i].x);
+		__m128 y = _mm_loadu_ps(&spheres[i + 1].x);
+		__m128 z = _mm_loadu_ps(&spheres[i + 2].x);
+		__m128 radius = _mm_loadu_ps(&spheres[i + 3].x);
+		_MM_TRANSPOSE4_PS(x, y, z, radius);
+		__m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), radius);
+
+		// Lane is culled once its sphere is fully behind any of the planes
+		__m128 outside = _mm_setzero_ps();
+		for (int p = 0; p < 6; p++)
+		{
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], x), _mm_mul_ps(planeY[p], y)),
+				_mm_add_ps(_mm_mul_ps(planeZ[p], z), planeW[p]));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negativeRadius));
+		}
+
+		int insideMask = ~_mm_movemask_ps(outside) & 0xF;
+		for (uint32_t lane = 0; insideMask != 0; lane++, insideMask >>= 1)
+		{
+			if (insideMask & 1)
+			{
+				visible.push_back(static_cast<uint32_t>(i + lane));
+			}
+		}
+	}
+#endif
+	for (; i < last; i++)
+	{
+		if (frustum.intersects(spheres[i]))
+		{
+			visible.push_back(static_cast<uint32_t>(i));
+		}
+	}
+}
\ No newline at end of file
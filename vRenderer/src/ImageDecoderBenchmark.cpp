@@ -0,0 +1,118 @@
+#include "ImageDecoderBenchmark.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <filesystem>
+#include <algorithm>
+
+#include "AssetImporter.h"
+#include "AsyncFileReader.h"
+#include "ImageDecoders.h"
+
+int ImageDecoderBenchmark::runFromCommandLine(int argc, char* argv[])
+{
+	namespace fs = std::filesystem;
+
+	fs::path folder = ASSETS_FOLDER;
+	int iterations = 5;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--iterations" && i + 1 < argc)
+		{
+			iterations = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (arg == "--bench-decoders" && i + 1 < argc && argv[i + 1][0] != '-')
+		{
+			folder = argv[++i];
+		}
+	}
+
+	// Encoded files are loaded up front, so only decoding is measured
+	ImageDecoderRegistry registry;
+	std::vector<FileData> files[static_cast<size_t>(ImageFormat::COUNT)];
+	try
+	{
+		for (const auto& entry : fs::recursive_directory_iterator(folder))
+		{
+			std::string extension = entry.path().extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+			if (!entry.is_regular_file() || std::find(c_supportedExtensions.begin(), c_supportedExtensions.end(), extension) == c_supportedExtensions.end())
+			{
+				continue;
+			}
+
+			FileData data = AsyncFileReader::readFileSync(entry.path());
+			ImageFormat format = ImageDecoderRegistry::detectFormat(data.data(), data.size());
+			files[static_cast<size_t>(format)].push_back(std::move(data));
+		}
+	}
+	catch (const std::exception& e)
+	{
+		printf("ERROR: %s\n", e.what());
+		return EXIT_FAILURE;
+	}
+
+	// Without optional backends only stb_image gets measured, which is easy to miss in the table below
+	printf("Optional decoder backends:\n");
+	for (const OptionalImageDecoder& backend : c_optionalImageDecoders)
+	{
+		printf("  %-16s %s\n", backend.name, backend.compiledIn ? "compiled in" : "not compiled in, see ImageDecoders.props");
+	}
+	printf("\n");
+
+	printf("%-6s %-16s %8s %12s %12s %12s\n", "Format", "Decoder", "Images", "ms/image", "MB/s (in)", "MPix/s");
+	for (size_t f = 0; f < static_cast<size_t>(ImageFormat::COUNT); f++)
+	{
+		if (files[f].empty()) continue;
+
+		ImageFormat format = static_cast<ImageFormat>(f);
+		std::vector<const IImageDecoder*> decoders;
+		for (const auto& decoder : registry.getDecoders(format))
+		{
+			decoders.push_back(decoder.get());
+		}
+		decoders.push_back(&registry.getFallbackDecoder());
+
+		size_t encodedBytes = 0;
+		for (const auto& data : files[f])
+		{
+			encodedBytes += data.size();
+		}
+
+		for (const IImageDecoder* decoder : decoders)
+		{
+			uint64_t pixels = 0;
+			size_t failures = 0;
+			auto start = std::chrono::high_resolution_clock::now();
+			for (int i = 0; i < iterations; i++)
+			{
+				for (const auto& data : files[f])
+				{
+					Texture texture;
+					if (decoder->decode(data.data(), data.size(), texture))
+					{
+						pixels += static_cast<uint64_t>(texture.width) * texture.height;
+					}
+					else
+					{
+						failures++;
+					}
+				}
+			}
+			double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+			size_t decodedImages = files[f].size() * iterations;
+			printf("%-6s %-16s %8zu %12.2f %12.1f %12.1f%s\n",
+				ImageDecoderRegistry::getFormatName(format), decoder->getName(), files[f].size(),
+				seconds * 1000.0 / decodedImages,
+				encodedBytes * iterations / seconds / (1024.0 * 1024.0),
+				pixels / seconds / 1e6,
+				failures > 0 ? " (some images failed to decode)" : "");
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
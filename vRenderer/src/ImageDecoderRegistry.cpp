@@ -0,0 +1,72 @@
+#include "ImageDecoderRegistry.h"
+#include "ImageDecoders.h"
+
+#include <cstring>
+
+ImageDecoderRegistry::ImageDecoderRegistry()
+{
+	fallbackDecoder = std::make_shared<StbImageDecoder>();
+
+#ifdef VRD_WITH_TURBOJPEG
+	registerDecoder(ImageFormat::JPEG, std::make_shared<TurboJpegDecoder>());
+#endif
+#ifdef VRD_WITH_SPNG
+	registerDecoder(ImageFormat::PNG, std::make_shared<SpngDecoder>());
+#endif
+}
+
+void ImageDecoderRegistry::registerDecoder(ImageFormat format, std::shared_ptr<IImageDecoder> decoder)
+{
+	decoders[static_cast<size_t>(format)].push_back(std::move(decoder));
+}
+
+bool ImageDecoderRegistry::decode(const uint8_t* data, size_t size, Texture& outTexture) const
+{
+	for (const auto& decoder : getDecoders(detectFormat(data, size)))
+	{
+		if (decoder->decode(data, size, outTexture))
+		{
+			return true;
+		}
+	}
+	return fallbackDecoder->decode(data, size, outTexture);
+}
+
+const std::vector<std::shared_ptr<IImageDecoder>>& ImageDecoderRegistry::getDecoders(ImageFormat format) const
+{
+	return decoders[static_cast<size_t>(format)];
+}
+
+const IImageDecoder& ImageDecoderRegistry::getFallbackDecoder() const
+{
+	return *fallbackDecoder;
+}
+
+/// <summary>
+/// Detects image format by its signature.
+/// </summary>
+ImageFormat ImageDecoderRegistry::detectFormat(const uint8_t* data, size_t size)
+{
+	static const uint8_t c_jpegSignature[] = { 0xFF, 0xD8, 0xFF };
+	static const uint8_t c_pngSignature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+	if (size >= sizeof(c_jpegSignature) && memcmp(data, c_jpegSignature, sizeof(c_jpegSignature)) == 0)
+	{
+		return ImageFormat::JPEG;
+	}
+	if (size >= sizeof(c_pngSignature) && memcmp(data, c_pngSignature, sizeof(c_pngSignature)) == 0)
+	{
+		return ImageFormat::PNG;
+	}
+	return ImageFormat::OTHER;
+}
+
+const char* ImageDecoderRegistry::getFormatName(ImageFormat format)
+{
+	switch (format)
+	{
+	case ImageFormat::JPEG: return "JPEG";
+	case ImageFormat::PNG: return "PNG";
+	default: return "Other";
+	}
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "ImageDecoders.h"
+
+#include <cstdlib>
+
+#include "stb_image.h"
+
+#ifdef VRD_WITH_TURBOJPEG
+#include <turbojpeg.h>
+#endif
+
+#ifdef VRD_WITH_SPNG
+#include <spng.h>
+#endif
+
+static bool allocatePixels(uint32_t width, uint32_t height, Texture& outTexture)
+{
+	outTexture.width = width;
+	outTexture.height = height;
+	outTexture.size = width * height * 4;
+	outTexture.ptr = static_cast<uint8_t*>(malloc(outTexture.size));
+	return outTexture.ptr != nullptr;
+}
+
+static void releasePixels(Texture& outTexture)
+{
+	free(outTexture.ptr);
+	outTexture.ptr = nullptr;
+	outTexture.width = outTexture.height = outTexture.size = 0;
+}
+
+bool StbImageDecoder::decode(const uint8_t* data, size_t size, Texture& outTexture) const
+{
+	int width, height, channels;
+	stbi_uc* image = stbi_load_from_memory(data, static_cast<int>(size), &width, &height, &channels, STBI_rgb_alpha);
+	if (!image)
+	{
+		return false;
+	}
+
+	outTexture.ptr = static_cast<uint8_t*>(image);
+	outTexture.width = static_cast<uint32_t>(width);
+	outTexture.height = static_cast<uint32_t>(height);
+	outTexture.size = static_cast<uint32_t>(width * height * 4);
+	return true;
+}
+
+#ifdef VRD_WITH_TURBOJPEG
+bool TurboJpegDecoder::decode(const uint8_t* data, size_t size, Texture& outTexture) const
+{
+	// TurboJPEG handles are not thread safe, so every thread gets its own
+	struct Handle
+	{
+		tjhandle handle = tjInitDecompress();
+		~Handle() { if (handle) tjDestroy(handle); }
+	};
+	thread_local Handle decompressor;
+	if (decompressor.handle == nullptr)
+	{
+		return false;
+	}
+
+	int width, height, subsampling, colorspace;
+	if (tjDecompressHeader3(decompressor.handle, data, static_cast<unsigned long>(size), &width, &height, &subsampling, &colorspace) != 0)
+	{
+		return false;
+	}
+
+	if (!allocatePixels(static_cast<uint32_t>(width), static_cast<uint32_t>(height), outTexture))
+	{
+		return false;
+	}
+
+	if (tjDecompress2(decompressor.handle, data, static_cast<unsigned long>(size), outTexture.ptr, width, 0, height, TJPF_RGBA, TJFLAG_FASTDCT) != 0)
+	{
+		releasePixels(outTexture);
+		return false;
+	}
+	return true;
+}
+#endif
+
+#ifdef VRD_WITH_SPNG
+bool SpngDecoder::decode(const uint8_t* data, size_t size, Texture& outTexture) const
+{
+	spng_ctx* context = spng_ctx_new(0);
+	if (context == nullptr)
+	{
+		return false;
+	}
+
+	spng_ihdr header;
+	size_t decodedSize;
+	bool success = spng_set_png_buffer(context, data, size) == 0
+		&& spng_get_ihdr(context, &header) == 0
+		&& spng_decoded_image_size(context, SPNG_FMT_RGBA8, &decodedSize) == 0
+		&& allocatePixels(header.width, header.height, outTexture);
+
+	if (success && spng_decode_image(context, outTexture.ptr, decodedSize, SPNG_FMT_RGBA8, SPNG_DECODE_TRNS) != 0)
+	{
+		releasePixels(outTexture);
+		success = false;
+	}
+
+	spng_ctx_free(context);
+	return success;
+}
+#endif
\ No newline at end of file
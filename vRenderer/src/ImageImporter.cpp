@@ -0,0 +1,245 @@
+#include "ImageImporter.h"
+#include "HashUtils.h"
+#include "TextureResampler.h"
+
+AsyncTask<std::shared_ptr<Texture>> ImageImporter::importTexture(std::filesystem::path textureFilePath, TextureRole role, bool printImportData)
+{
+	std::vector<TextureImportRequest> requests = { { textureFilePath, role } };
+	std::vector<std::shared_ptr<Texture>> textures = co_await importTextures(std::move(requests), printImportData);
+	co_return textures[0];
+}
+
+/// <summary>
+/// Imports several textures at once. Reads of all files are issued up front,
+/// and once they are done textures are decoded in parallel on workers.
+/// </summary>
+AsyncTask<std::vector<std::shared_ptr<Texture>>> ImageImporter::importTextures(std::vector<TextureImportRequest> requests, bool printImportData)
+{
+	std::vector<std::shared_ptr<Texture>> textures(requests.size());
+
+	std::vector<uint32_t> maxSizes(requests.size());
+	std::vector<std::filesystem::path> pathsToRead;
+	std::vector<size_t> indicesToRead;
+	for (size_t i = 0; i < requests.size(); i++)
+	{
+		maxSizes[i] = getMaxTextureSize(requests[i].role);
+		textures[i] = getImportedTexture(requests[i].path, maxSizes[i]);
+		if (textures[i] == nullptr)
+		{
+			pathsToRead.push_back(requests[i].path);
+			indicesToRead.push_back(i);
+		}
+	}
+	if (pathsToRead.empty())
+	{
+		co_return textures;
+	}
+
+	std::vector<FileData_future> reads = co_await readFiles(pathsToRead);
+	ThreadDispatcher::instance().parallel_for(0, reads.size(), 1, [&](size_t first, size_t last) {
+		for (size_t i = first; i < last; i++)
+		{
+			uint32_t maxSize = maxSizes[indicesToRead[i]];
+			std::shared_ptr<Texture> texture = std::make_shared<Texture>();
+			decodeTexture(reads[i].get(), pathsToRead[i], maxSize, *texture);
+
+			textures[indicesToRead[i]] = registerTexture(pathsToRead[i], maxSize, texture, printImportData);
+		}
+		});
+
+	co_return textures;
+}
+
+AsyncTask<std::shared_ptr<Cubemap>> ImageImporter::importCubemap(std::filesystem::path cubemapFolderPath, bool printImportData)
+{
+	namespace fs = std::filesystem;
+
+	// All faces share the budget, so they stay of equal size after downscaling
+	uint32_t maxSize = getMaxTextureSize(TextureRole::CUBEMAP);
+	std::string cacheKey = getCacheKey(cubemapFolderPath, maxSize);
+
+	// If cubemap is already imported just return it
+	{
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		if (importedCubemapsMap.find(cacheKey) != importedCubemapsMap.end())
+		{
+			if (printImportData)
+			{
+				std::cout << "Cubemap \"" << cubemapFolderPath.filename().string() << "\" is already imported, sharing it." << std::endl;
+			}
+			co_return importedCubemapsMap[cacheKey];
+		}
+	}
+
+	// Assert requested cubemap.
+	try
+	{
+		bool faces[6] = { false };
+		for (auto& dirIt : fs::directory_iterator(cubemapFolderPath))
+		{
+			const fs::path& path = dirIt.path();
+
+			const auto& itExt = std::find(c_supportedExtensions.begin(), c_supportedExtensions.end(), path.extension().string());
+			if (itExt == c_supportedExtensions.end())
+			{
+				throw std::runtime_error("Image imported doesn't support provided image extension.");
+			}
+
+			const auto& itFace = std::find(c_cubemapFaces.begin(), c_cubemapFaces.end(), path.stem().string());
+			if (itFace != c_cubemapFaces.end())
+			{
+				int index = std::distance(c_cubemapFaces.begin(), itFace);
+				if (faces[index] != true)
+				{
+					faces[index] = true;
+				}
+				else
+				{
+					throw std::runtime_error("Duplicated face image of a cubemap is detected during import");
+				}
+			}
+		}
+
+		for (int i = 0; i < 6; ++i)
+		{
+			if (!faces[i])
+			{
+				throw std::runtime_error("Some of cubemap faces weren't found duting import");
+			}
+		}
+	}
+	catch (const std::exception& e)
+	{
+		std::string error_message = "Assertion fail on " + cubemapFolderPath.string() + "cubemap import. " + e.what();
+		throw std::runtime_error(error_message);
+	}
+
+	// Import the cubemap if assertion succeded
+	// All faces are read at once and then decoded in parallel
+	std::vector<fs::path> facePaths;
+	for (auto& dirIt : fs::directory_iterator(cubemapFolderPath))
+	{
+		facePaths.push_back(dirIt.path());
+	}
+	std::vector<FileData_future> reads = co_await readFiles(facePaths);
+
+	std::vector<Texture> faceTextures(facePaths.size());
+	ThreadDispatcher::instance().parallel_for(0, facePaths.size(), 1, [&](size_t first, size_t last) {
+		for (size_t i = first; i < last; i++)
+		{
+			decodeTexture(reads[i].get(), facePaths[i], maxSize, faceTextures[i]);
+		}
+		});
+
+	std::shared_ptr<Cubemap> cubemap = std::make_shared<Cubemap>();
+	for (size_t i = 0; i < facePaths.size(); i++)
+	{
+		const fs::path& facePath = facePaths[i];
+		Texture& texture = faceTextures[i];
+		if (printImportData)
+		{
+			std::cout << "Cubemap \"" << cubemapFolderPath.filename().string() << "\" face " << facePath.filename().string() << " imported: " << texture.width << "x" << texture.height << std::endl;
+		}
+		if (facePath.stem() == "back")
+		{
+			cubemap->back = std::move(texture);
+		}
+		else if (facePath.stem() == "front")
+		{
+			cubemap->front = std::move(texture);
+		}
+		else if (facePath.stem() == "top")
+		{
+			cubemap->top = std::move(texture);
+		}
+		else if (facePath.stem() == "bottom")
+		{
+			cubemap->bottom = std::move(texture);
+		}
+		else if (facePath.stem() == "left")
+		{
+			cubemap->left = std::move(texture);
+		}
+		else if (facePath.stem() == "right")
+		{
+			cubemap->right = std::move(texture);
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	importedCubemapsMap[cacheKey] = cubemap;
+
+	co_return cubemap;
+}
+
+void ImageImporter::setImportSettings(const ImportSettings& settings)
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	importSettings = settings;
+}
+
+uint32_t ImageImporter::getMaxTextureSize(TextureRole role)
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	return importSettings.getMaxTextureSize(role);
+}
+
+std::string ImageImporter::getCacheKey(const std::filesystem::path& filePath, uint32_t maxSize)
+{
+	return filePath.string() + "@" + std::to_string(maxSize);
+}
+
+std::shared_ptr<Texture> ImageImporter::getImportedTexture(const std::filesystem::path& textureFilePath, uint32_t maxSize)
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	auto it = importedTexturesMap.find(getCacheKey(textureFilePath, maxSize));
+	return it != importedTexturesMap.end() ? it->second : nullptr;
+}
+
+/// <summary>
+/// Adds decoded texture to the cache and returns the instance that should be used by the caller.
+/// </summary>
+std::shared_ptr<Texture> ImageImporter::registerTexture(const std::filesystem::path& textureFilePath, uint32_t maxSize, std::shared_ptr<Texture> texture, bool printImportData)
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+
+	// Same image may be stored under a different path (e.g. copied into several model folders).
+	// In this case decoded data is dropped and already imported instance is shared instead.
+	auto it = importedTexturesByHash.find(texture->contentHash);
+	if (it != importedTexturesByHash.end())
+	{
+		if (printImportData)
+		{
+			std::cout << "Texture \"" << textureFilePath.filename().string() << "\" is identical to \"" << it->second->name << "\", sharing it." << std::endl;
+		}
+		texture = it->second;
+	}
+	else
+	{
+		importedTexturesByHash[texture->contentHash] = texture;
+	}
+
+	importedTexturesMap[getCacheKey(textureFilePath, maxSize)] = texture;
+
+	return texture;
+}
+
+/// <summary>
+/// Decodes texture and downscales it to fit into maxSize x maxSize (0 means no limit).
+/// Content hash is computed on the final data, so equal images imported with equal budgets are still shared.
+/// </summary>
+void ImageImporter::decodeTexture(const FileData& fileData, const std::filesystem::path& textureFilePath, uint32_t maxSize, Texture& outTexture)
+{
+	if (!decoderRegistry.decode(fileData.data(), fileData.size(), outTexture))
+	{
+		throw std::runtime_error("Failed to load texture \"" + textureFilePath.filename().string() + "\".");
+	}
+
+	outTexture.name = textureFilePath.stem().string();
+
+	TextureResampler::downscaleToFit(outTexture, maxSize);
+
+	// Extent is chained into the hash to distinguish images with equal data but different layout
+	uint64_t extent = (static_cast<uint64_t>(outTexture.width) << 32) | outTexture.height;
+	outTexture.contentHash = HashUtils::xxh64(outTexture.ptr, outTexture.size, extent);
+}
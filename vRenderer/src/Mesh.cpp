@@ -1,12 +1,21 @@
 #include "Mesh.h"
+#include "HashUtils.h"
 
 Mesh::Mesh(int id, const char* name, std::vector<glm::vec3> vertices, std::vector<uint32_t> indices,
     std::vector<glm::vec2> texCoords, std::vector<glm::vec3> normals) : id(id), name(name)
 {
-    this->vertices = vertices;
-    this->indices = indices;
-    this->texCoords = texCoords;
-    this->normals = normals;
+    this->vertices = std::move(vertices);
+    this->indices = std::move(indices);
+    this->texCoords = std::move(texCoords);
+    this->normals = std::move(normals);
+
+    // Chain hashes of every attribute stream so that meshes are only equal if all of their data is.
+    uint64_t hash = HashUtils::xxh64(this->vertices);
+    hash = HashUtils::xxh64(this->normals, hash);
+    hash = HashUtils::xxh64(this->texCoords, hash);
+    this->contentHash = HashUtils::xxh64(this->indices, hash);
+
+    computeBounds();
 }
 
 const std::vector<glm::vec3>& Mesh::getVertices() const
@@ -27,4 +36,40 @@ const std::vector<glm::vec3>& Mesh::getNormals() const
 const std::vector<uint32_t>& Mesh::getIndices() const
 {
     return this->indices;
+}
+
+uint64_t Mesh::getContentHash() const
+{
+    return this->contentHash;
+}
+
+const BoundingBox& Mesh::getBoundingBox() const
+{
+    return this->boundingBox;
+}
+
+const BoundingSphere& Mesh::getBoundingSphere() const
+{
+    return this->boundingSphere;
+}
+
+/// <summary>
+/// Sphere is centered in the box and reaches the farthest vertex, which is usually tighter than the box diagonal.
+/// </summary>
+void Mesh::computeBounds()
+{
+    for (const glm::vec3& vertex : vertices)
+    {
+        boundingBox.expand(vertex);
+    }
+    if (boundingBox.isEmpty()) return;
+
+    boundingSphere.center = boundingBox.getCenter();
+    float radiusSquared = 0.0f;
+    for (const glm::vec3& vertex : vertices)
+    {
+        glm::vec3 offset = vertex - boundingSphere.center;
+        radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+    }
+    boundingSphere.radius = std::sqrt(radiusSquared);
 }
\ No newline at end of file
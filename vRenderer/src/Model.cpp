@@ -1,13 +1,28 @@
 #include "Model.h"
 #include "utils.h"
 
-Model::Model(uint32_t id, std::string name, std::vector<std::unique_ptr<Mesh>>&& meshes, std::vector<std::unique_ptr<Material>>&& materials, uint32_t materialCount) :
+Model::Model(uint32_t id, std::string name, std::vector<std::shared_ptr<Mesh>>&& meshes, std::vector<std::unique_ptr<Material>>&& materials, uint32_t materialCount) :
 	ISceneInstanceTemplate(id, name)	
 {
 	this->meshCount = meshes.size();
 	this->meshes = std::move(meshes);
 	this->materials = std::move(materials);
 	this->materialCount = materialCount;
+
+	// Sphere around the box of all meshes, grown to contain every mesh sphere
+	for (const auto& mesh : this->meshes)
+	{
+		boundingBox.expand(mesh->getBoundingBox());
+	}
+	if (!boundingBox.isEmpty())
+	{
+		boundingSphere.center = boundingBox.getCenter();
+		for (const auto& mesh : this->meshes)
+		{
+			const BoundingSphere& meshSphere = mesh->getBoundingSphere();
+			boundingSphere.radius = std::max(boundingSphere.radius, glm::length(meshSphere.center - boundingSphere.center) + meshSphere.radius);
+		}
+	}
 }
 
 uint32_t Model::getMeshCount() const
@@ -25,7 +40,7 @@ std::string Model::getName()
 	return this->name;
 }
 
-const std::vector<std::unique_ptr<Mesh>>& Model::getMeshes() const
+const std::vector<std::shared_ptr<Mesh>>& Model::getMeshes() const
 {
 	return this->meshes;
 }
@@ -33,4 +48,14 @@ const std::vector<std::unique_ptr<Mesh>>& Model::getMeshes() const
 const std::vector<std::unique_ptr<Material>>& Model::getMaterials() const
 {
 	return this->materials;
+}
+
+const BoundingBox& Model::getBoundingBox() const
+{
+	return this->boundingBox;
+}
+
+const BoundingSphere& Model::getBoundingSphere() const
+{
+	return this->boundingSphere;
 }
\ No newline at end of file
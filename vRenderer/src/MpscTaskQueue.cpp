@@ -0,0 +1,169 @@
+#include "MpscTaskQueue.h"
+
+#include <algorithm>
+
+// Weight of the latest task in the average queue age
+static constexpr float c_ageSmoothing = 0.05f;
+
+MpscTaskQueue::MpscTaskQueue(size_t capacity)
+{
+	static_assert(sizeof(Slot) == 64, "Ring slot is expected to take a single cache line.");
+
+	size_t size = 2;
+	while (size < capacity)
+	{
+		size *= 2;
+	}
+
+	slots.reset(new Slot[size]);
+	mask = size - 1;
+	for (size_t i = 0; i < size; i++)
+	{
+		slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+size_t MpscTaskQueue::process(Clock::time_point deadline, size_t minTaskCount)
+{
+	size_t processedCount = 0;
+	stats.maxAgeMs = 0.0f;
+	bool deadlinePassed = deadline != Clock::time_point::max() && Clock::now() >= deadline;
+
+	// Everything claimed before this point may be run now. Slots claimed but not yet written are left for the next call.
+	size_t end = enqueuePosition.load(std::memory_order_acquire);
+
+	// Overflowed tasks of a producer are newer than its tasks in the ring, so overflow is only taken once the ring is empty.
+	// Until then producers keep pushing to overflow, so none of them can get a task into the ring ahead of its overflowed ones.
+	// Overflow is taken only here, so tasks overflowing while this call runs are left for the next one.
+	if (overflowSpareIndex == overflowSpare.size() && overflowActive.load(std::memory_order_acquire))
+	{
+		std::lock_guard<std::mutex> lock(overflowMutex);
+		if (dequeuePosition == enqueuePosition.load(std::memory_order_acquire))
+		{
+			std::swap(overflow, overflowSpare);
+			overflowActive.store(false, std::memory_order_release);
+		}
+	}
+
+	// Taken overflow is older than anything in the ring
+	if (runOverflowSpare(deadline, minTaskCount, processedCount))
+	{
+		Task task;
+		Clock::time_point pushTime;
+		while (dequeuePosition != end && (processedCount < minTaskCount || Clock::now() < deadline) && tryPop(task, pushTime))
+		{
+			runTask(task, pushTime);
+			processedCount++;
+		}
+	}
+
+	stats.processedCount += processedCount;
+	stats.overflowPushCount = overflowPushCount.load(std::memory_order_relaxed);
+	stats.pendingCount = enqueuePosition.load(std::memory_order_relaxed) - dequeuePosition + (overflowSpare.size() - overflowSpareIndex);
+	if (overflowActive.load(std::memory_order_acquire))
+	{
+		std::lock_guard<std::mutex> lock(overflowMutex);
+		stats.pendingCount += overflow.size();
+	}
+	if (deadlinePassed && (processedCount > 0 || stats.pendingCount > 0))
+	{
+		stats.starvedCallCount++;
+	}
+
+	return processedCount;
+}
+
+const MpscTaskQueue::Stats& MpscTaskQueue::getStats() const
+{
+	return stats;
+}
+
+bool MpscTaskQueue::tryPushToRing(Task& task, Clock::time_point pushTime)
+{
+	size_t position = enqueuePosition.load(std::memory_order_relaxed);
+	Slot* slot;
+	while (true)
+	{
+		slot = &slots[position & mask];
+		size_t sequence = slot->sequence.load(std::memory_order_acquire);
+		intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+		if (difference == 0)
+		{
+			if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (difference < 0)
+		{
+			// Slot from the previous lap hasn't been consumed yet, ring is full
+			return false;
+		}
+		else
+		{
+			position = enqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	slot->task = std::move(task);
+	slot->pushTime = pushTime;
+	slot->sequence.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+void MpscTaskQueue::pushToOverflow(Task& task, Clock::time_point pushTime)
+{
+	std::lock_guard<std::mutex> lock(overflowMutex);
+	overflow.push_back({ std::move(task), pushTime });
+	overflowActive.store(true, std::memory_order_release);
+	overflowPushCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool MpscTaskQueue::tryPop(Task& outTask, Clock::time_point& outPushTime)
+{
+	Slot& slot = slots[dequeuePosition & mask];
+	if (slot.sequence.load(std::memory_order_acquire) != dequeuePosition + 1)
+	{
+		return false;
+	}
+
+	outTask = std::move(slot.task);
+	outPushTime = slot.pushTime;
+	// Slot becomes available to producers on the next lap
+	slot.sequence.store(dequeuePosition + mask + 1, std::memory_order_release);
+	dequeuePosition++;
+	return true;
+}
+
+/// <summary>
+/// Runs tasks of the taken overflow. Returns false if deadline was reached before all of them were run.
+/// Deadline is only checked once minTaskCount tasks were run by the current call.
+/// </summary>
+bool MpscTaskQueue::runOverflowSpare(Clock::time_point deadline, size_t minTaskCount, size_t& processedCount)
+{
+	while (overflowSpareIndex < overflowSpare.size())
+	{
+		if (processedCount >= minTaskCount && Clock::now() >= deadline)
+		{
+			return false;
+		}
+
+		OverflowTask& overflowTask = overflowSpare[overflowSpareIndex++];
+		runTask(overflowTask.task, overflowTask.pushTime);
+		processedCount++;
+	}
+
+	overflowSpare.clear();
+	overflowSpareIndex = 0;
+	return true;
+}
+
+void MpscTaskQueue::runTask(Task& task, Clock::time_point pushTime)
+{
+	float ageMs = std::chrono::duration<float, std::milli>(Clock::now() - pushTime).count();
+	stats.maxAgeMs = std::max(stats.maxAgeMs, ageMs);
+	stats.averageAgeMs += (ageMs - stats.averageAgeMs) * c_ageSmoothing;
+
+	task();
+	task.reset();
+}
\ No newline at end of file
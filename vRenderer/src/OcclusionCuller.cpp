@@ -0,0 +1,532 @@
+#include "OcclusionCuller.h"
+#include "ThreadDispatcher.h"
+#include "geometry_settings.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VRD_OCCLUSION_SSE2
+#include <emmintrin.h>
+#endif
+
+// Vertices nearer than this are clipped away, keeps projected coordinates finite
+static constexpr float c_minClipW = 1e-2f;
+// Radius to distance ratio of a mesh sphere to be considered as an occluder
+static constexpr float c_minOccluderSize = 0.1f;
+// There are no coarse LODs to rasterize instead, so detailed meshes are not used as occluders
+static constexpr size_t c_maxMeshTriangles = 16384;
+static constexpr size_t c_maxFrameTriangles = 32768;
+// Rows rasterized by a single task, multiple of the tile size
+static constexpr int c_bandHeight = 16;
+// Below this many spheres testing runs on the calling thread
+static constexpr size_t c_parallelTestThreshold = 4096;
+static constexpr size_t c_spheresPerTask = 2048;
+static constexpr uint32_t c_noNeighbour = UINT32_MAX;
+static constexpr uint32_t c_allEdges = 7;
+
+// Rounding of non-negative (ceil) and not less than -1 (floor) pixel coordinates without a library call
+static int pixelCeil(float value)
+{
+	int truncated = static_cast<int>(value);
+	return truncated + (static_cast<float>(truncated) < value);
+}
+
+static int pixelFloor(float value)
+{
+	return static_cast<int>(value + 1.0f) - 1;
+}
+
+OcclusionCuller::OcclusionCuller(int width, int height)
+{
+	this->width = std::max(c_tileSize, (width + c_tileSize - 1) / c_tileSize * c_tileSize);
+	this->height = std::max(c_tileSize, (height + c_tileSize - 1) / c_tileSize * c_tileSize);
+	tilesX = this->width / c_tileSize;
+	tilesY = this->height / c_tileSize;
+
+	depth.assign(static_cast<size_t>(this->width) * this->height, 0.0f);
+	tileDepth.assign(static_cast<size_t>(tilesX) * tilesY, 0.0f);
+	viewProjection = glm::mat4(1.0f);
+	depthRow = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	clipExtent = glm::vec4(1.0f);
+}
+
+void OcclusionCuller::begin(const glm::mat4& viewProjection)
+{
+	this->viewProjection = viewProjection;
+	depthRow = glm::vec4(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+	clipExtent = glm::abs(viewProjection[0]) + glm::abs(viewProjection[1]) + glm::abs(viewProjection[2]);
+	candidates.clear();
+	occluderCount = 0;
+	triangleCount = 0;
+}
+
+void OcclusionCuller::addOccluder(const Mesh& mesh, const glm::mat4& transform, const glm::vec4& worldSphere)
+{
+	size_t meshTriangles = mesh.getIndices().size() / 3;
+	if (meshTriangles == 0 || meshTriangles > c_maxMeshTriangles) return;
+
+	float distance = glm::dot(glm::vec3(depthRow), glm::vec3(worldSphere)) + depthRow.w;
+	float screenSize = worldSphere.w / std::max(distance, c_minClipW);
+	if (screenSize < c_minOccluderSize) return;
+
+	candidates.push_back({ &mesh, transform, screenSize, nullptr });
+}
+
+/// <summary>
+/// Largest candidates on screen are taken first until the triangle budget is spent.
+/// Triangles of each occluder are set up in parallel, then horizontal bands are rasterized in parallel,
+/// every band reading all triangles but writing only its own rows and tiles.
+/// </summary>
+void OcclusionCuller::rasterize()
+{
+	std::sort(candidates.begin(), candidates.end(), [](const Occluder& a, const Occluder& b) { return a.screenSize > b.screenSize; });
+
+	occluderCount = 0;
+	triangleCount = 0;
+	for (size_t i = 0; i < candidates.size(); i++)
+	{
+		size_t meshTriangles = candidates[i].mesh->getIndices().size() / 3;
+		if (triangleCount + meshTriangles > c_maxFrameTriangles) continue;
+
+		triangleCount += meshTriangles;
+		candidates[occluderCount++] = candidates[i];
+	}
+	candidates.resize(occluderCount);
+	if (occluderCount == 0) return;
+
+	// Adjacency depends only on geometry, so it is found once per mesh, the first time it becomes an occluder
+	for (Occluder& occluder : candidates)
+	{
+		auto it = edgeNeighbours.find(occluder.mesh->getContentHash());
+		if (it == edgeNeighbours.end())
+		{
+			it = edgeNeighbours.emplace(occluder.mesh->getContentHash(), findEdgeNeighbours(*occluder.mesh)).first;
+		}
+		occluder.edgeNeighbours = &it->second;
+	}
+
+	if (occluderTriangles.size() < occluderCount)
+	{
+		occluderTriangles.resize(occluderCount);
+	}
+
+	ThreadDispatcher& dispatcher = ThreadDispatcher::instance();
+	dispatcher.parallel_for(0, occluderCount, 1, [this](size_t first, size_t last) {
+		for (size_t i = first; i < last; i++)
+		{
+			setupTriangles(candidates[i], occluderTriangles[i]);
+		}
+		});
+
+	size_t bandCount = (height + c_bandHeight - 1) / c_bandHeight;
+	dispatcher.parallel_for(0, bandCount, 1, [this](size_t first, size_t last) {
+		for (size_t band = first; band < last; band++)
+		{
+			int firstRow = static_cast<int>(band) * c_bandHeight;
+			rasterizeBand(firstRow, std::min(height, firstRow + c_bandHeight));
+		}
+		});
+}
+
+void OcclusionCuller::cull(const glm::vec4* spheres, std::vector<uint32_t>& visible) const
+{
+	if (occluderCount == 0) return;
+
+	if (visible.size() < c_parallelTestThreshold)
+	{
+		visible.erase(std::remove_if(visible.begin(), visible.end(), [this, spheres](uint32_t i) { return isOccluded(spheres[i]); }), visible.end());
+		return;
+	}
+
+	std::vector<uint8_t> occluded(visible.size());
+	ThreadDispatcher::instance().parallel_for(0, visible.size(), c_spheresPerTask, [&](size_t first, size_t last) {
+		for (size_t i = first; i < last; i++)
+		{
+			occluded[i] = isOccluded(spheres[visible[i]]);
+		}
+		});
+
+	size_t visibleCount = 0;
+	for (size_t i = 0; i < visible.size(); i++)
+	{
+		if (!occluded[i]) visible[visibleCount++] = visible[i];
+	}
+	visible.resize(visibleCount);
+}
+
+/// <summary>
+/// Sphere is occluded if its nearest point is behind the farthest depth of every tile its screen rectangle touches.
+/// Spheres reaching behind the camera are always visible.
+/// </summary>
+bool OcclusionCuller::isOccluded(const glm::vec4& sphere) const
+{
+	if (occluderCount == 0) return false;
+
+	// Clip coordinates of the box around the sphere lie within center +- radius * extent
+	glm::vec4 center = viewProjection * glm::vec4(glm::vec3(sphere), 1.0f);
+	glm::vec4 minClip = center - clipExtent * sphere.w;
+	glm::vec4 maxClip = center + clipExtent * sphere.w;
+	if (minClip.w < c_minClipW) return false;
+
+	// With w positive, x / w is largest for the largest x and the smallest w if x is positive, the largest w otherwise
+	glm::vec2 minPoint(minClip.x / (minClip.x < 0.0f ? minClip.w : maxClip.w), minClip.y / (minClip.y < 0.0f ? minClip.w : maxClip.w));
+	glm::vec2 maxPoint(maxClip.x / (maxClip.x > 0.0f ? minClip.w : maxClip.w), maxClip.y / (maxClip.y > 0.0f ? minClip.w : maxClip.w));
+	float nearestW = center.w - sphere.w * glm::length(glm::vec3(depthRow));
+
+	glm::vec2 size(static_cast<float>(width), static_cast<float>(height));
+	minPoint = (minPoint * 0.5f + 0.5f) * size;
+	maxPoint = (maxPoint * 0.5f + 0.5f) * size;
+	if (maxPoint.x < 0.0f || maxPoint.y < 0.0f || minPoint.x >= size.x || minPoint.y >= size.y) return false;
+
+	minPoint = glm::max(minPoint, glm::vec2(0.0f));
+	maxPoint = glm::min(maxPoint, size - 1.0f);
+	int firstTileX = static_cast<int>(minPoint.x) / c_tileSize;
+	int firstTileY = static_cast<int>(minPoint.y) / c_tileSize;
+	int lastTileX = static_cast<int>(maxPoint.x) / c_tileSize;
+	int lastTileY = static_cast<int>(maxPoint.y) / c_tileSize;
+
+	float sphereDepth = 1.0f / nearestW;
+	for (int tileY = firstTileY; tileY <= lastTileY; tileY++)
+	{
+		const float* tiles = tileDepth.data() + static_cast<size_t>(tileY) * tilesX;
+		int tileX = firstTileX;
+#ifdef VRD_OCCLUSION_SSE2
+		__m128 sphereDepth4 = _mm_set1_ps(sphereDepth);
+		for (; tileX + 4 <= lastTileX + 1; tileX += 4)
+		{
+			if (_mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(tiles + tileX), sphereDepth4)) != 0) return false;
+		}
+#endif
+		for (; tileX <= lastTileX; tileX++)
+		{
+			if (tiles[tileX] <= sphereDepth) return false;
+		}
+	}
+	return true;
+}
+
+/// <summary>
+/// Pairs up triangle edges with the same end points. Vertices are matched by position, not by index,
+/// since imported meshes split vertices along texture seams, which would otherwise become borders.
+/// </summary>
+std::vector<uint32_t> OcclusionCuller::findEdgeNeighbours(const Mesh& mesh)
+{
+	const std::vector<glm::vec3>& vertices = mesh.getVertices();
+	const std::vector<uint32_t>& indices = mesh.getIndices();
+	size_t triangleCount = indices.size() / 3;
+
+	struct PositionHash
+	{
+		size_t operator()(const glm::vec3& p) const
+		{
+			return std::hash<float>()(p.x) ^ (std::hash<float>()(p.y) << 1) ^ (std::hash<float>()(p.z) << 2);
+		}
+	};
+	std::unordered_map<glm::vec3, uint32_t, PositionHash> positionIds;
+	positionIds.reserve(vertices.size());
+	std::vector<uint32_t> positionId(vertices.size());
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		positionId[i] = positionIds.emplace(vertices[i], static_cast<uint32_t>(positionIds.size())).first->second;
+	}
+
+	// Edges sorted by their end points, edges of a manifold surface come in pairs
+	struct Edge
+	{
+		uint64_t key;
+		uint32_t halfEdge;
+	};
+	std::vector<Edge> edges;
+	edges.reserve(triangleCount * 3);
+	for (size_t triangle = 0; triangle < triangleCount; triangle++)
+	{
+		for (uint32_t edge = 0; edge < 3; edge++)
+		{
+			uint32_t from = indices[triangle * 3 + edge] - VERTEX_INDEX_OFFSET;
+			uint32_t to = indices[triangle * 3 + (edge + 1) % 3] - VERTEX_INDEX_OFFSET;
+			if (from >= vertices.size() || to >= vertices.size()) continue;
+
+			uint64_t a = positionId[from];
+			uint64_t b = positionId[to];
+			if (a == b) continue;
+			edges.push_back({ std::min(a, b) << 32 | std::max(a, b), static_cast<uint32_t>(triangle * 3 + edge) });
+		}
+	}
+	std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) { return a.key < b.key; });
+
+	std::vector<uint32_t> neighbours(triangleCount * 3, c_noNeighbour);
+	for (size_t first = 0; first < edges.size();)
+	{
+		size_t last = first + 1;
+		while (last < edges.size() && edges[last].key == edges[first].key) last++;
+		if (last - first == 2)
+		{
+			neighbours[edges[first].halfEdge] = edges[first + 1].halfEdge;
+			neighbours[edges[first + 1].halfEdge] = edges[first].halfEdge;
+		}
+		first = last;
+	}
+	return neighbours;
+}
+
+/// <summary>
+/// Transforms mesh to clip space and clips triangles crossing the near plane.
+/// Triangles entirely outside of one of the side planes are dropped before clipping.
+/// </summary>
+void OcclusionCuller::setupTriangles(const Occluder& occluder, std::vector<ScreenTriangle>& triangles) const
+{
+	triangles.clear();
+
+	const std::vector<glm::vec3>& vertices = occluder.mesh->getVertices();
+	const std::vector<uint32_t>& indices = occluder.mesh->getIndices();
+	glm::mat4 clipMatrix = viewProjection * occluder.transform;
+
+	// Vertices are projected once, not once per triangle sharing them
+	thread_local std::vector<glm::vec4> clipVertices;
+	thread_local std::vector<glm::vec3> screenVertices;
+	clipVertices.resize(vertices.size());
+	screenVertices.resize(vertices.size());
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		clipVertices[i] = clipMatrix * glm::vec4(vertices[i], 1.0f);
+		if (clipVertices[i].w >= c_minClipW)
+		{
+			screenVertices[i] = toScreen(clipVertices[i]);
+		}
+	}
+
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		// Imported indices are shifted by VERTEX_INDEX_OFFSET
+		uint32_t index[3] = { indices[i] - VERTEX_INDEX_OFFSET, indices[i + 1] - VERTEX_INDEX_OFFSET, indices[i + 2] - VERTEX_INDEX_OFFSET };
+		if (index[0] >= clipVertices.size() || index[1] >= clipVertices.size() || index[2] >= clipVertices.size()) continue;
+
+		const glm::vec4* polygon[3] = { &clipVertices[index[0]], &clipVertices[index[1]], &clipVertices[index[2]] };
+
+		bool outside = false;
+		for (int axis = 0; axis < 2 && !outside; axis++)
+		{
+			outside = ((*polygon[0])[axis] > polygon[0]->w && (*polygon[1])[axis] > polygon[1]->w && (*polygon[2])[axis] > polygon[2]->w) ||
+				((*polygon[0])[axis] < -polygon[0]->w && (*polygon[1])[axis] < -polygon[1]->w && (*polygon[2])[axis] < -polygon[2]->w);
+		}
+		if (outside) continue;
+
+		int behind = (polygon[0]->w < c_minClipW) + (polygon[1]->w < c_minClipW) + (polygon[2]->w < c_minClipW);
+		if (behind == 0)
+		{
+			// Edge is sampled at pixel centers only if the neighbour continues the surface on its other side on screen,
+			// otherwise there may be empty space or a farther surface right behind it
+			uint32_t conservativeEdges = 0;
+			for (int edge = 0; edge < 3; edge++)
+			{
+				const glm::vec3& from = screenVertices[index[edge]];
+				const glm::vec3& to = screenVertices[index[(edge + 1) % 3]];
+				const glm::vec3& opposite = screenVertices[index[(edge + 2) % 3]];
+
+				bool continued = false;
+				uint32_t neighbour = (*occluder.edgeNeighbours)[i / 3 * 3 + edge];
+				if (neighbour != c_noNeighbour)
+				{
+					uint32_t neighbourOpposite = indices[neighbour / 3 * 3 + (neighbour % 3 + 2) % 3] - VERTEX_INDEX_OFFSET;
+					if (neighbourOpposite < clipVertices.size() && clipVertices[neighbourOpposite].w >= c_minClipW)
+					{
+						const glm::vec3& other = screenVertices[neighbourOpposite];
+						float side = (to.x - from.x) * (opposite.y - from.y) - (to.y - from.y) * (opposite.x - from.x);
+						float otherSide = (to.x - from.x) * (other.y - from.y) - (to.y - from.y) * (other.x - from.x);
+						// Same threshold as for degenerate triangles, which are never rasterized
+						continued = (side > 0.0f) != (otherSide > 0.0f) && std::abs(otherSide) > 1e-6f;
+					}
+				}
+				conservativeEdges |= continued ? 0 : 1u << edge;
+			}
+			addScreenTriangle(screenVertices[index[0]], screenVertices[index[1]], screenVertices[index[2]], conservativeEdges, triangles);
+			continue;
+		}
+		if (behind == 3) continue;
+
+		// Clip against w = c_minClipW, one vertex behind gives a quad, two give a triangle
+		glm::vec3 clipped[4];
+		int clippedCount = 0;
+		for (int v = 0; v < 3; v++)
+		{
+			const glm::vec4& current = *polygon[v];
+			const glm::vec4& next = *polygon[(v + 1) % 3];
+			if (current.w >= c_minClipW) clipped[clippedCount++] = screenVertices[index[v]];
+			if ((current.w >= c_minClipW) != (next.w >= c_minClipW))
+			{
+				float t = (c_minClipW - current.w) / (next.w - current.w);
+				clipped[clippedCount++] = toScreen(current + (next - current) * t);
+			}
+		}
+		// Clipped triangles are near the camera and large on screen, only the diagonal splitting a quad is sampled at centers
+		if (clippedCount == 4)
+		{
+			addScreenTriangle(clipped[0], clipped[1], clipped[2], 0b011, triangles);
+			addScreenTriangle(clipped[0], clipped[2], clipped[3], 0b110, triangles);
+		}
+		else
+		{
+			addScreenTriangle(clipped[0], clipped[1], clipped[2], c_allEdges, triangles);
+		}
+	}
+}
+
+glm::vec3 OcclusionCuller::toScreen(const glm::vec4& clip) const
+{
+	float inverseW = 1.0f / clip.w;
+	return glm::vec3((clip.x * inverseW * 0.5f + 0.5f) * width, (clip.y * inverseW * 0.5f + 0.5f) * height, inverseW);
+}
+
+/// <summary>
+/// Computes edge functions and the depth plane once, so bands sharing the triangle only evaluate them.
+/// </summary>
+void OcclusionCuller::addScreenTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, uint32_t conservativeEdges, std::vector<ScreenTriangle>& triangles) const
+{
+	float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+	if (!(std::abs(area) > 1e-6f)) return;
+
+	// Pixel centers within the bounding rectangle, triangles between pixel centers cover nothing
+	float minX = std::min({ a.x, b.x, c.x });
+	float maxX = std::max({ a.x, b.x, c.x });
+	float minY = std::min({ a.y, b.y, c.y });
+	float maxY = std::max({ a.y, b.y, c.y });
+	if (maxX < 0.0f || minX > width || maxY < 0.0f || minY > height) return;
+
+	ScreenTriangle triangle;
+	triangle.minX = pixelCeil(std::max(minX - 0.5f, 0.0f));
+	triangle.maxX = pixelFloor(std::min(maxX - 0.5f, width - 1.0f));
+	triangle.minY = pixelCeil(std::max(minY - 0.5f, 0.0f));
+	triangle.maxY = pixelFloor(std::min(maxY - 0.5f, height - 1.0f));
+	if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) return;
+
+	// Occluders are drawn from both sides, winding is only made consistent for edge functions.
+	// Reversed order a, c, b walks edges ca, bc, ab.
+	const glm::vec3* v[3] = { &a, area > 0.0f ? &b : &c, area > 0.0f ? &c : &b };
+	const int edgeBits[3] = { area > 0.0f ? 0 : 2, 1, area > 0.0f ? 2 : 0 };
+	area = std::abs(area);
+	for (int i = 0; i < 3; i++)
+	{
+		const glm::vec3& from = *v[i];
+		const glm::vec3& to = *v[(i + 1) % 3];
+		triangle.edgeA[i] = from.y - to.y;
+		triangle.edgeB[i] = to.x - from.x;
+		triangle.edgeC[i] = -(triangle.edgeA[i] * from.x + triangle.edgeB[i] * from.y);
+		// Moved inwards by the largest change of the edge function within half a pixel,
+		// so testing pixel center tells whether the whole pixel is inside
+		if (conservativeEdges & (1u << edgeBits[i]))
+		{
+			triangle.edgeC[i] -= 0.5f * (std::abs(triangle.edgeA[i]) + std::abs(triangle.edgeB[i]));
+		}
+	}
+
+	const glm::vec3& v0 = *v[0];
+	const glm::vec3& v1 = *v[1];
+	const glm::vec3& v2 = *v[2];
+	triangle.depthX = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+	triangle.depthY = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) / area;
+	// Farthest depth within a pixel is stored, not the one at its center
+	triangle.depthC = v0.z - triangle.depthX * v0.x - triangle.depthY * v0.y - 0.5f * (std::abs(triangle.depthX) + std::abs(triangle.depthY));
+
+	triangles.push_back(triangle);
+}
+
+void OcclusionCuller::rasterizeBand(int firstRow, int lastRow)
+{
+	std::fill(depth.begin() + static_cast<size_t>(firstRow) * width, depth.begin() + static_cast<size_t>(lastRow) * width, 0.0f);
+
+	for (size_t i = 0; i < occluderCount; i++)
+	{
+		for (const ScreenTriangle& triangle : occluderTriangles[i])
+		{
+			if (triangle.maxY < firstRow || triangle.minY >= lastRow) continue;
+			rasterizeTriangle(triangle, firstRow, lastRow);
+		}
+	}
+
+	for (int tileY = firstRow / c_tileSize; tileY < lastRow / c_tileSize; tileY++)
+	{
+		for (int tileX = 0; tileX < tilesX; tileX++)
+		{
+			float farthest = FLT_MAX;
+			for (int y = 0; y < c_tileSize; y++)
+			{
+				const float* row = depth.data() + static_cast<size_t>(tileY * c_tileSize + y) * width + tileX * c_tileSize;
+				for (int x = 0; x < c_tileSize; x++)
+				{
+					farthest = std::min(farthest, row[x]);
+				}
+			}
+			tileDepth[static_cast<size_t>(tileY) * tilesX + tileX] = farthest;
+		}
+	}
+}
+
+/// <summary>
+/// Evaluates edge functions and the depth plane at pixel centers, keeps the nearest depth where all edges are non-negative.
+/// Conservative edges are shifted inwards by setup, so along them only pixels lying entirely inside are written.
+/// </summary>
+void OcclusionCuller::rasterizeTriangle(const ScreenTriangle& triangle, int firstRow, int lastRow)
+{
+	const float* edgeA = triangle.edgeA;
+	const float* edgeB = triangle.edgeB;
+	const float* edgeC = triangle.edgeC;
+	float depthX = triangle.depthX;
+	float depthY = triangle.depthY;
+	float depthC = triangle.depthC;
+
+	int minX = triangle.minX;
+	int maxX = triangle.maxX;
+	int minY = std::max(triangle.minY, firstRow);
+	int maxY = std::min(triangle.maxY, lastRow - 1);
+
+#ifdef VRD_OCCLUSION_SSE2
+	// Whole groups of 4 pixels, width is a multiple of 4, so groups never cross the row end
+	int firstGroup = minX & ~3;
+	__m128 laneOffset = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+	__m128 a0 = _mm_set1_ps(edgeA[0]), a1 = _mm_set1_ps(edgeA[1]), a2 = _mm_set1_ps(edgeA[2]);
+	__m128 zx = _mm_set1_ps(depthX);
+	__m128 zero = _mm_setzero_ps();
+	for (int y = minY; y <= maxY; y++)
+	{
+		float centerY = y + 0.5f;
+		__m128 rowEdge0 = _mm_set1_ps(edgeB[0] * centerY + edgeC[0]);
+		__m128 rowEdge1 = _mm_set1_ps(edgeB[1] * centerY + edgeC[1]);
+		__m128 rowEdge2 = _mm_set1_ps(edgeB[2] * centerY + edgeC[2]);
+		__m128 rowDepth = _mm_set1_ps(depthY * centerY + depthC);
+		float* row = depth.data() + static_cast<size_t>(y) * width;
+
+		for (int group = firstGroup; group <= maxX; group += 4)
+		{
+			__m128 centerX = _mm_add_ps(_mm_set1_ps(static_cast<float>(group)), laneOffset);
+			__m128 inside = _mm_and_ps(
+				_mm_and_ps(_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a0, centerX), rowEdge0), zero),
+					_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a1, centerX), rowEdge1), zero)),
+				_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a2, centerX), rowEdge2), zero));
+			if (_mm_movemask_ps(inside) == 0) continue;
+
+			__m128 previous = _mm_loadu_ps(row + group);
+			__m128 nearest = _mm_max_ps(previous, _mm_add_ps(_mm_mul_ps(zx, centerX), rowDepth));
+			_mm_storeu_ps(row + group, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, previous)));
+		}
+	}
+#else
+	for (int y = minY; y <= maxY; y++)
+	{
+		float centerY = y + 0.5f;
+		float* row = depth.data() + static_cast<size_t>(y) * width;
+		for (int column = minX; column <= maxX; column++)
+		{
+			float centerX = column + 0.5f;
+			bool inside = true;
+			for (int i = 0; i < 3; i++)
+			{
+				inside = inside && edgeA[i] * centerX + edgeB[i] * centerY + edgeC[i] >= 0.0f;
+			}
+			if (inside)
+			{
+				row[column] = std::max(row[column], depthX * centerX + depthY * centerY + depthC);
+			}
+		}
+	}
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,578 @@
+#include "SceneBvh.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VRD_BVH_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace VRD::Scene
+{
+	// Deep enough for 4 children per level of a tree halving ranges over 2^32 instances
+	static constexpr int c_stackSize = 128;
+
+	struct SceneBvh::BuildState
+	{
+		const SceneGraph* scene;
+		// Morton code of the centroid in high 32 bits, dense index in low 32 bits, sorted once
+		std::vector<uint64_t> refs;
+		// By dense index
+		std::vector<BoundingBox> boxes;
+	};
+
+	// Spreads lower 10 bits of value so that there are 2 zero bits between each of them
+	static uint32_t spreadBits(uint32_t value)
+	{
+		value = (value | (value << 16)) & 0x030000FF;
+		value = (value | (value << 8)) & 0x0300F00F;
+		value = (value | (value << 4)) & 0x030C30C3;
+		value = (value | (value << 2)) & 0x09249249;
+		return value;
+	}
+
+	// 30 bit Morton code of point normalized to 0..1 within the scene bounds
+	static uint32_t mortonCode(const glm::vec3& normalized)
+	{
+		glm::uvec3 cell = glm::uvec3(glm::clamp(normalized * 1024.0f, glm::vec3(0.0f), glm::vec3(1023.0f)));
+		return (spreadBits(cell.x) << 2) | (spreadBits(cell.y) << 1) | spreadBits(cell.z);
+	}
+
+	struct TraversalEntry
+	{
+		uint32_t node;
+		// Ray entry distance or squared distance to the child box, depending on the query
+		float distance;
+	};
+
+	void BvhNode::setBox(int slot, const BoundingBox& box)
+	{
+		minX[slot] = box.min.x;
+		minY[slot] = box.min.y;
+		minZ[slot] = box.min.z;
+		maxX[slot] = box.max.x;
+		maxY[slot] = box.max.y;
+		maxZ[slot] = box.max.z;
+	}
+
+	BoundingBox BvhNode::getBox(int slot) const
+	{
+		return { glm::vec3(minX[slot], minY[slot], minZ[slot]), glm::vec3(maxX[slot], maxY[slot], maxZ[slot]) };
+	}
+
+	static BoundingBox getNodeBounds(const BvhNode& node);
+
+	// Scalar tests of a single box, used for leaf instances and where SSE2 isn't available
+
+	static bool intersectRay(const BoundingBox& box, const glm::vec3& origin, const glm::vec3& invDirection, float maxDistance, float& distance)
+	{
+		if (box.isEmpty()) return false;
+
+		glm::vec3 t1 = (box.min - origin) * invDirection;
+		glm::vec3 t2 = (box.max - origin) * invDirection;
+		glm::vec3 tNear = glm::min(t1, t2);
+		glm::vec3 tFar = glm::max(t1, t2);
+		float entry = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+		float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+		distance = entry;
+		return entry <= exit;
+	}
+
+	static bool intersectFrustum(const BoundingBox& box, const Frustum& frustum)
+	{
+		if (box.isEmpty()) return false;
+
+		// Box is outside if its corner farthest along the plane normal is behind the plane
+		for (const glm::vec4& plane : frustum.planes)
+		{
+			glm::vec3 corner(plane.x >= 0.0f ? box.max.x : box.min.x, plane.y >= 0.0f ? box.max.y : box.min.y, plane.z >= 0.0f ? box.max.z : box.min.z);
+			if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) return false;
+		}
+		return true;
+	}
+
+	static bool intersectBox(const BoundingBox& box, const BoundingBox& other)
+	{
+		return !box.isEmpty() && glm::all(glm::lessThanEqual(box.min, other.max)) && glm::all(glm::greaterThanEqual(box.max, other.min));
+	}
+
+	static float distanceSquared(const BoundingBox& box, const glm::vec3& point)
+	{
+		if (box.isEmpty()) return FLT_MAX;
+
+		glm::vec3 offset = glm::max(glm::max(box.min - point, point - box.max), glm::vec3(0.0f));
+		return glm::dot(offset, offset);
+	}
+
+	// Tests of all 4 child boxes of a node. Each returns a mask with a bit set for every child passing the test.
+
+#ifdef VRD_BVH_SSE2
+	static inline __m128 nonEmptyMask(const BvhNode& node)
+	{
+		return _mm_and_ps(_mm_and_ps(_mm_cmple_ps(_mm_load_ps(node.minX), _mm_load_ps(node.maxX)),
+			_mm_cmple_ps(_mm_load_ps(node.minY), _mm_load_ps(node.maxY))),
+			_mm_cmple_ps(_mm_load_ps(node.minZ), _mm_load_ps(node.maxZ)));
+	}
+
+	static int intersectRay(const BvhNode& node, const glm::vec3& origin, const glm::vec3& invDirection, float maxDistance, float* distances)
+	{
+		__m128 ox = _mm_set1_ps(origin.x), oy = _mm_set1_ps(origin.y), oz = _mm_set1_ps(origin.z);
+		__m128 ix = _mm_set1_ps(invDirection.x), iy = _mm_set1_ps(invDirection.y), iz = _mm_set1_ps(invDirection.z);
+
+		__m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minX), ox), ix);
+		__m128 t2x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxX), ox), ix);
+		__m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minY), oy), iy);
+		__m128 t2y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxY), oy), iy);
+		__m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minZ), oz), iz);
+		__m128 t2z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxZ), oz), iz);
+
+		__m128 entry = _mm_max_ps(_mm_max_ps(_mm_min_ps(t1x, t2x), _mm_min_ps(t1y, t2y)), _mm_max_ps(_mm_min_ps(t1z, t2z), _mm_setzero_ps()));
+		__m128 exit = _mm_min_ps(_mm_min_ps(_mm_max_ps(t1x, t2x), _mm_max_ps(t1y, t2y)), _mm_min_ps(_mm_max_ps(t1z, t2z), _mm_set1_ps(maxDistance)));
+		_mm_storeu_ps(distances, entry);
+		return _mm_movemask_ps(_mm_and_ps(_mm_cmple_ps(entry, exit), nonEmptyMask(node)));
+	}
+
+	static int intersectFrustum(const BvhNode& node, const Frustum& frustum)
+	{
+		__m128 minX = _mm_load_ps(node.minX), minY = _mm_load_ps(node.minY), minZ = _mm_load_ps(node.minZ);
+		__m128 maxX = _mm_load_ps(node.maxX), maxY = _mm_load_ps(node.maxY), maxZ = _mm_load_ps(node.maxZ);
+
+		__m128 outside = _mm_setzero_ps();
+		for (const glm::vec4& plane : frustum.planes)
+		{
+			__m128 x = plane.x >= 0.0f ? maxX : minX;
+			__m128 y = plane.y >= 0.0f ? maxY : minY;
+			__m128 z = plane.z >= 0.0f ? maxZ : minZ;
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)), _mm_mul_ps(y, _mm_set1_ps(plane.y))),
+				_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+		}
+		return _mm_movemask_ps(_mm_andnot_ps(outside, nonEmptyMask(node)));
+	}
+
+	static int intersectBox(const BvhNode& node, const BoundingBox& box)
+	{
+		__m128 overlap = _mm_and_ps(_mm_cmple_ps(_mm_load_ps(node.minX), _mm_set1_ps(box.max.x)), _mm_cmpge_ps(_mm_load_ps(node.maxX), _mm_set1_ps(box.min.x)));
+		overlap = _mm_and_ps(overlap, _mm_and_ps(_mm_cmple_ps(_mm_load_ps(node.minY), _mm_set1_ps(box.max.y)), _mm_cmpge_ps(_mm_load_ps(node.maxY), _mm_set1_ps(box.min.y))));
+		overlap = _mm_and_ps(overlap, _mm_and_ps(_mm_cmple_ps(_mm_load_ps(node.minZ), _mm_set1_ps(box.max.z)), _mm_cmpge_ps(_mm_load_ps(node.maxZ), _mm_set1_ps(box.min.z))));
+		return _mm_movemask_ps(_mm_and_ps(overlap, nonEmptyMask(node)));
+	}
+
+	static int distanceSquared(const BvhNode& node, const glm::vec3& point, float maxDistanceSquared, float* distances)
+	{
+		__m128 zero = _mm_setzero_ps();
+		__m128 px = _mm_set1_ps(point.x), py = _mm_set1_ps(point.y), pz = _mm_set1_ps(point.z);
+		__m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(node.minX), px), _mm_sub_ps(px, _mm_load_ps(node.maxX))), zero);
+		__m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(node.minY), py), _mm_sub_ps(py, _mm_load_ps(node.maxY))), zero);
+		__m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(node.minZ), pz), _mm_sub_ps(pz, _mm_load_ps(node.maxZ))), zero);
+		__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+		_mm_storeu_ps(distances, distance);
+		return _mm_movemask_ps(_mm_and_ps(_mm_cmplt_ps(distance, _mm_set1_ps(maxDistanceSquared)), nonEmptyMask(node)));
+	}
+#else
+	static int intersectRay(const BvhNode& node, const glm::vec3& origin, const glm::vec3& invDirection, float maxDistance, float* distances)
+	{
+		int mask = 0;
+		for (int slot = 0; slot < 4; slot++)
+		{
+			if (intersectRay(node.getBox(slot), origin, invDirection, maxDistance, distances[slot])) mask |= 1 << slot;
+		}
+		return mask;
+	}
+
+	static int intersectFrustum(const BvhNode& node, const Frustum& frustum)
+	{
+		int mask = 0;
+		for (int slot = 0; slot < 4; slot++)
+		{
+			if (intersectFrustum(node.getBox(slot), frustum)) mask |= 1 << slot;
+		}
+		return mask;
+	}
+
+	static int intersectBox(const BvhNode& node, const BoundingBox& box)
+	{
+		int mask = 0;
+		for (int slot = 0; slot < 4; slot++)
+		{
+			if (intersectBox(node.getBox(slot), box)) mask |= 1 << slot;
+		}
+		return mask;
+	}
+
+	static int distanceSquared(const BvhNode& node, const glm::vec3& point, float maxDistanceSquared, float* distances)
+	{
+		int mask = 0;
+		for (int slot = 0; slot < 4; slot++)
+		{
+			distances[slot] = distanceSquared(node.getBox(slot), point);
+			if (distances[slot] < maxDistanceSquared) mask |= 1 << slot;
+		}
+		return mask;
+	}
+#endif
+
+	// Pushes children so that the closest one is popped first
+	static void pushSorted(TraversalEntry* children, int count, TraversalEntry* stack, int& top)
+	{
+		std::sort(children, children + count, [](const TraversalEntry& a, const TraversalEntry& b) { return a.distance > b.distance; });
+		for (int i = 0; i < count; i++)
+		{
+			stack[top++] = children[i];
+		}
+	}
+
+	BoundingBox SceneBvh::transformBox(const BoundingBox& box, const glm::mat4& matrix)
+	{
+		if (box.isEmpty()) return box;
+
+		glm::vec3 center = glm::vec3(matrix * glm::vec4(box.getCenter(), 1.0f));
+		glm::vec3 extent = (box.max - box.min) * 0.5f;
+		glm::vec3 worldExtent = glm::abs(glm::vec3(matrix[0])) * extent.x + glm::abs(glm::vec3(matrix[1])) * extent.y + glm::abs(glm::vec3(matrix[2])) * extent.z;
+		return { center - worldExtent, center + worldExtent };
+	}
+
+	void SceneBvh::build(const SceneGraph& scene)
+	{
+		clear();
+		size_t count = scene.getInstanceCount();
+		if (count == 0) return;
+
+		BuildState state;
+		state.scene = &scene;
+		state.refs.resize(count);
+		state.boxes.resize(count);
+
+		const auto& models = scene.getModels();
+		const auto& worldMatrices = scene.getWorldMatrices();
+		std::vector<glm::vec3> centroids(count);
+		BoundingBox centroidBounds;
+		for (size_t i = 0; i < count; i++)
+		{
+			state.boxes[i] = transformBox(models[i]->getBoundingBox(), worldMatrices[i]);
+			centroids[i] = state.boxes[i].isEmpty() ? glm::vec3(worldMatrices[i][3]) : state.boxes[i].getCenter();
+			centroidBounds.expand(centroids[i]);
+		}
+
+		glm::vec3 scale = 1.0f / glm::max(centroidBounds.max - centroidBounds.min, glm::vec3(FLT_MIN));
+		for (size_t i = 0; i < count; i++)
+		{
+			uint64_t code = mortonCode((centroids[i] - centroidBounds.min) * scale);
+			state.refs[i] = (code << 32) | i;
+		}
+		std::sort(state.refs.begin(), state.refs.end());
+
+		instances.reserve(count);
+		boxes.reserve(count);
+		owners.reserve(count);
+		nodes.reserve(count / 2 + 1);
+		buildNode(UINT32_MAX, 0, static_cast<uint32_t>(count), state);
+		dirtyNodes.assign(nodes.size(), 0);
+
+		uint32_t slotCount = 0;
+		for (InstanceHandle instance : instances)
+		{
+			slotCount = std::max(slotCount, instance.index + 1);
+		}
+		positions.assign(slotCount, UINT32_MAX);
+		for (uint32_t i = 0; i < instances.size(); i++)
+		{
+			positions[instances[i].index] = i;
+		}
+	}
+
+	/// <summary>
+	/// Splits range of Morton sorted instances in halves, then splits halves that are still larger than a leaf.
+	/// Halves of a range along the Z curve are spatially coherent, resulting 2 to 4 ranges become leaves or child nodes.
+	/// </summary>
+	uint32_t SceneBvh::buildNode(uint32_t parent, uint32_t first, uint32_t last, BuildState& state)
+	{
+		uint32_t nodeIndex = static_cast<uint32_t>(nodes.size());
+		nodes.emplace_back();
+		parents.push_back(parent);
+
+		auto split = [](uint32_t first, uint32_t last) { return first + (last - first) / 2; };
+
+		uint32_t ranges[5];
+		uint32_t rangeCount = 0;
+		ranges[rangeCount++] = first;
+		if (last - first > c_leafSize)
+		{
+			uint32_t middle = split(first, last);
+			if (middle - first > c_leafSize) ranges[rangeCount++] = split(first, middle);
+			ranges[rangeCount++] = middle;
+			if (last - middle > c_leafSize) ranges[rangeCount++] = split(middle, last);
+		}
+		ranges[rangeCount] = last;
+
+		for (int slot = 0; slot < 4; slot++)
+		{
+			BoundingBox box;
+			uint32_t child = UINT32_MAX;
+			uint32_t count = 0;
+			if (slot < static_cast<int>(rangeCount))
+			{
+				uint32_t rangeFirst = ranges[slot];
+				uint32_t rangeLast = ranges[slot + 1];
+				if (rangeLast - rangeFirst <= c_leafSize)
+				{
+					child = static_cast<uint32_t>(instances.size());
+					count = rangeLast - rangeFirst;
+					for (uint32_t i = rangeFirst; i < rangeLast; i++)
+					{
+						uint32_t ref = static_cast<uint32_t>(state.refs[i]);
+						instances.push_back(state.scene->getHandle(ref));
+						boxes.push_back(state.boxes[ref]);
+						owners.push_back(nodeIndex);
+						box.expand(state.boxes[ref]);
+					}
+				}
+				else
+				{
+					child = buildNode(nodeIndex, rangeFirst, rangeLast, state);
+					box = getNodeBounds(nodes[child]);
+				}
+			}
+
+			// Recursion may have reallocated nodes
+			BvhNode& node = nodes[nodeIndex];
+			node.setBox(slot, box);
+			node.child[slot] = child;
+			node.count[slot] = count;
+		}
+		return nodeIndex;
+	}
+
+	void SceneBvh::refit(const SceneGraph& scene, const std::vector<InstanceHandle>& updated)
+	{
+		if (nodes.empty()) return;
+
+		bool changed = false;
+		for (InstanceHandle handle : updated)
+		{
+			if (handle.index >= positions.size() || !scene.isValid(handle)) continue;
+
+			uint32_t position = positions[handle.index];
+			if (position == UINT32_MAX || instances[position] != handle) continue;
+
+			uint32_t denseIndex = scene.getDenseIndex(handle);
+			boxes[position] = transformBox(scene.getModels()[denseIndex]->getBoundingBox(), scene.getWorldMatrices()[denseIndex]);
+			// Ancestors of a dirty node are already dirty
+			for (uint32_t node = owners[position]; node != UINT32_MAX && !dirtyNodes[node]; node = parents[node])
+			{
+				dirtyNodes[node] = 1;
+			}
+			changed = true;
+		}
+		if (!changed) return;
+
+		// Children always follow their parent, so reverse order refits bottom up
+		for (size_t i = nodes.size(); i-- > 0;)
+		{
+			if (dirtyNodes[i])
+			{
+				refitNode(static_cast<uint32_t>(i));
+				dirtyNodes[i] = 0;
+			}
+		}
+	}
+
+	void SceneBvh::refitNode(uint32_t nodeIndex)
+	{
+		BvhNode& node = nodes[nodeIndex];
+		for (int slot = 0; slot < 4; slot++)
+		{
+			BoundingBox box;
+			if (node.count[slot] > 0)
+			{
+				for (uint32_t i = node.child[slot]; i < node.child[slot] + node.count[slot]; i++)
+				{
+					box.expand(boxes[i]);
+				}
+			}
+			else if (node.isInner(slot))
+			{
+				box = getNodeBounds(nodes[node.child[slot]]);
+			}
+			node.setBox(slot, box);
+		}
+	}
+
+	void SceneBvh::clear()
+	{
+		nodes.clear();
+		parents.clear();
+		dirtyNodes.clear();
+		instances.clear();
+		boxes.clear();
+		owners.clear();
+		positions.clear();
+	}
+
+	bool SceneBvh::raycast(const Ray& ray, RayHit& hit, float maxDistance) const
+	{
+		if (nodes.empty()) return false;
+
+		glm::vec3 invDirection = 1.0f / ray.direction;
+		float closest = maxDistance;
+		InstanceHandle closestInstance;
+
+		TraversalEntry stack[c_stackSize];
+		int top = 0;
+		stack[top++] = { 0, 0.0f };
+		while (top > 0)
+		{
+			TraversalEntry entry = stack[--top];
+			if (entry.distance > closest) continue;
+
+			const BvhNode& node = nodes[entry.node];
+			float distances[4];
+			int mask = intersectRay(node, ray.origin, invDirection, closest, distances);
+
+			TraversalEntry children[4];
+			int childCount = 0;
+			for (int slot = 0; slot < 4; slot++)
+			{
+				if (!(mask & (1 << slot))) continue;
+
+				if (node.isInner(slot))
+				{
+					children[childCount++] = { node.child[slot], distances[slot] };
+					continue;
+				}
+				for (uint32_t i = node.child[slot]; i < node.child[slot] + node.count[slot]; i++)
+				{
+					float distance;
+					if (intersectRay(boxes[i], ray.origin, invDirection, closest, distance) && distance < closest)
+					{
+						closest = distance;
+						closestInstance = instances[i];
+					}
+				}
+			}
+			pushSorted(children, childCount, stack, top);
+		}
+
+		if (!closestInstance.isValid()) return false;
+
+		hit.instance = closestInstance;
+		hit.distance = closest;
+		return true;
+	}
+
+	void SceneBvh::queryFrustum(const Frustum& frustum, std::vector<InstanceHandle>& result) const
+	{
+		if (nodes.empty()) return;
+
+		uint32_t stack[c_stackSize];
+		int top = 0;
+		stack[top++] = 0;
+		while (top > 0)
+		{
+			const BvhNode& node = nodes[stack[--top]];
+			int mask = intersectFrustum(node, frustum);
+			for (int slot = 0; slot < 4; slot++)
+			{
+				if (!(mask & (1 << slot))) continue;
+
+				if (node.isInner(slot))
+				{
+					stack[top++] = node.child[slot];
+					continue;
+				}
+				for (uint32_t i = node.child[slot]; i < node.child[slot] + node.count[slot]; i++)
+				{
+					if (intersectFrustum(boxes[i], frustum)) result.push_back(instances[i]);
+				}
+			}
+		}
+	}
+
+	void SceneBvh::queryBox(const BoundingBox& box, std::vector<InstanceHandle>& result) const
+	{
+		if (nodes.empty() || box.isEmpty()) return;
+
+		uint32_t stack[c_stackSize];
+		int top = 0;
+		stack[top++] = 0;
+		while (top > 0)
+		{
+			const BvhNode& node = nodes[stack[--top]];
+			int mask = intersectBox(node, box);
+			for (int slot = 0; slot < 4; slot++)
+			{
+				if (!(mask & (1 << slot))) continue;
+
+				if (node.isInner(slot))
+				{
+					stack[top++] = node.child[slot];
+					continue;
+				}
+				for (uint32_t i = node.child[slot]; i < node.child[slot] + node.count[slot]; i++)
+				{
+					if (intersectBox(boxes[i], box)) result.push_back(instances[i]);
+				}
+			}
+		}
+	}
+
+	InstanceHandle SceneBvh::findNearest(const glm::vec3& point, float maxDistance) const
+	{
+		InstanceHandle nearest;
+		if (nodes.empty()) return nearest;
+
+		float best = maxDistance < FLT_MAX ? maxDistance * maxDistance : FLT_MAX;
+		TraversalEntry stack[c_stackSize];
+		int top = 0;
+		stack[top++] = { 0, 0.0f };
+		while (top > 0)
+		{
+			TraversalEntry entry = stack[--top];
+			if (entry.distance >= best) continue;
+
+			const BvhNode& node = nodes[entry.node];
+			float distances[4];
+			int mask = distanceSquared(node, point, best, distances);
+
+			TraversalEntry children[4];
+			int childCount = 0;
+			for (int slot = 0; slot < 4; slot++)
+			{
+				if (!(mask & (1 << slot))) continue;
+
+				if (node.isInner(slot))
+				{
+					children[childCount++] = { node.child[slot], distances[slot] };
+					continue;
+				}
+				for (uint32_t i = node.child[slot]; i < node.child[slot] + node.count[slot]; i++)
+				{
+					float distance = distanceSquared(boxes[i], point);
+					if (distance < best)
+					{
+						best = distance;
+						nearest = instances[i];
+					}
+				}
+			}
+			pushSorted(children, childCount, stack, top);
+		}
+		return nearest;
+	}
+
+	BoundingBox SceneBvh::getBounds() const
+	{
+		return nodes.empty() ? BoundingBox() : getNodeBounds(nodes[0]);
+	}
+
+	static BoundingBox getNodeBounds(const BvhNode& node)
+	{
+		BoundingBox bounds;
+		for (int slot = 0; slot < 4; slot++)
+		{
+			BoundingBox box = node.getBox(slot);
+			if (!box.isEmpty()) bounds.expand(box);
+		}
+		return bounds;
+	}
+}
\ No newline at end of file
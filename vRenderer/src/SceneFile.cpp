@@ -0,0 +1,218 @@
+#include "SceneFile.h"
+#include "MappedFile.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace VRD::Scene
+{
+	SceneLight SceneLight::fromLight(const Light& light)
+	{
+		SceneLight record;
+		record.type = static_cast<uint32_t>(light.type);
+		record.constant = light.constant;
+		record.linear = light.linear;
+		record.quadratic = light.quadratic;
+		record.color = light.color;
+		record.position = light.position;
+		record.direction = light.direction;
+		record.cutOff = light.cutOff;
+		record.outerCutOff = light.outerCutOff;
+		return record;
+	}
+
+	void SceneLight::apply(Light& light) const
+	{
+		light.type = static_cast<Light::Type>(type);
+		light.constant = constant;
+		light.linear = linear;
+		light.quadratic = quadratic;
+		light.color = color;
+		light.position = position;
+		light.direction = direction;
+		light.cutOff = cutOff;
+		light.outerCutOff = outerCutOff;
+	}
+
+	void SceneData::captureInstances(const SceneGraph& scene)
+	{
+		size_t count = scene.getInstanceCount();
+		const auto& models = scene.getModels();
+		const auto& parents = scene.getParents();
+		const auto& flags = scene.getFlags();
+
+		modelNames.clear();
+		instanceModels.resize(count);
+		instanceParents.resize(count);
+		instanceFlags.resize(count);
+
+		// Instances of the same model share one template, so the table is keyed by it
+		std::unordered_map<const Model*, uint32_t> modelIndices;
+		for (size_t i = 0; i < count; i++)
+		{
+			auto [it, inserted] = modelIndices.try_emplace(models[i].get(), static_cast<uint32_t>(modelNames.size()));
+			if (inserted)
+			{
+				modelNames.push_back(models[i]->name);
+			}
+			instanceModels[i] = it->second;
+			instanceParents[i] = parents[i].isValid() ? scene.getDenseIndex(parents[i]) : UINT32_MAX;
+			// Dirty state is runtime only, transforms are stored as position, rotation and scale
+			instanceFlags[i] = flags[i] & ~INSTANCE_TRANSFORM_DIRTY;
+		}
+
+		positions = scene.getPositions();
+		rotations = scene.getRotations();
+		scales = scene.getScales();
+	}
+
+	/// <summary>
+	/// Writes scene into a temporary file next to the target and replaces the target with it,
+	/// so a failed save never leaves a truncated scene behind.
+	/// </summary>
+	void SceneFile::save(const std::filesystem::path& scenePath, const SceneData& scene, AssetBundle::Compression compression)
+	{
+		std::vector<uint8_t> payload = serialize(scene);
+		std::vector<uint8_t> stored = AssetBundle::compressChunk(payload, compression);
+
+		Header header = {};
+		memcpy(header.magic, MAGIC, sizeof(header.magic));
+		header.version = VERSION;
+		header.compression = compression;
+		header.instanceCount = static_cast<uint32_t>(scene.getInstanceCount());
+		header.storedSize = stored.size();
+		header.size = payload.size();
+
+		std::filesystem::path tempPath = scenePath;
+		tempPath += ".tmp";
+		{
+			std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+			if (!out)
+			{
+				throw std::runtime_error("Failed to open \"" + tempPath.string() + "\" for writing.");
+			}
+			out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			out.write(reinterpret_cast<const char*>(stored.data()), stored.size());
+			if (!out)
+			{
+				throw std::runtime_error("Failed to write scene \"" + scenePath.string() + "\".");
+			}
+		}
+		std::filesystem::rename(tempPath, scenePath);
+	}
+
+	SceneData SceneFile::load(const std::filesystem::path& scenePath)
+	{
+		MappedFile file(scenePath);
+
+		BinaryReader reader(file.data(), file.size());
+		Header header = reader.read<Header>();
+		if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION)
+		{
+			throw std::runtime_error("\"" + scenePath.string() + "\" is not a scene file or its version is not supported.");
+		}
+		if (header.storedSize != reader.remaining())
+		{
+			throw std::runtime_error("Scene file \"" + scenePath.string() + "\" is truncated.");
+		}
+		if (header.size > AssetBundle::getMaxDecompressedSize(header.compression, header.storedSize))
+		{
+			throw std::runtime_error("Scene file \"" + scenePath.string() + "\" is corrupted.");
+		}
+
+		AssetBundle::Entry entry;
+		entry.compression = header.compression;
+		entry.storedSize = header.storedSize;
+		entry.size = header.size;
+		entry.name = scenePath.string();
+		std::vector<uint8_t> payload = AssetBundle::decompressChunk(file.data() + sizeof(Header), entry);
+
+		SceneData scene = deserialize(payload.data(), payload.size());
+		if (scene.getInstanceCount() != header.instanceCount)
+		{
+			throw std::runtime_error("Scene file \"" + scenePath.string() + "\" is corrupted.");
+		}
+		return scene;
+	}
+
+	std::vector<uint8_t> SceneFile::serialize(const SceneData& scene)
+	{
+		BinaryWriter writer;
+
+		writer.write(static_cast<uint32_t>(scene.modelNames.size()));
+		for (const std::string& modelName : scene.modelNames)
+		{
+			writer.writeString(modelName);
+		}
+		writer.writeString(scene.skyboxName);
+
+		// Order should match the one in deserialize
+		writer.writeVector(scene.instanceModels);
+		writer.writeVector(scene.instanceParents);
+		writer.writeVector(scene.positions);
+		writer.writeVector(scene.rotations);
+		writer.writeVector(scene.scales);
+		writer.writeVector(scene.instanceFlags);
+
+		writer.writeVector(scene.lights);
+		writer.write(scene.camera);
+
+		return writer.release();
+	}
+
+	SceneData SceneFile::deserialize(const uint8_t* data, size_t size)
+	{
+		BinaryReader reader(data, size);
+		SceneData scene;
+
+		uint32_t modelCount = reader.read<uint32_t>();
+		if (modelCount > reader.remaining() / sizeof(uint32_t))
+		{
+			throw std::runtime_error("Binary data is truncated or corrupted.");
+		}
+		scene.modelNames.resize(modelCount);
+		for (std::string& modelName : scene.modelNames)
+		{
+			modelName = reader.readString();
+		}
+		scene.skyboxName = reader.readString();
+
+		scene.instanceModels = reader.readVector<uint32_t>();
+		scene.instanceParents = reader.readVector<uint32_t>();
+		scene.positions = reader.readVector<glm::vec3>();
+		scene.rotations = reader.readVector<glm::vec3>();
+		scene.scales = reader.readVector<glm::vec3>();
+		scene.instanceFlags = reader.readVector<uint8_t>();
+
+		scene.lights = reader.readVector<SceneLight>();
+		scene.camera = reader.read<SceneCamera>();
+
+		size_t count = scene.getInstanceCount();
+		if (scene.instanceParents.size() != count || scene.positions.size() != count || scene.rotations.size() != count ||
+			scene.scales.size() != count || scene.instanceFlags.size() != count)
+		{
+			throw std::runtime_error("Scene instance attributes have mismatched sizes.");
+		}
+		for (size_t i = 0; i < count; i++)
+		{
+			if (scene.instanceModels[i] >= modelCount || (scene.instanceParents[i] != UINT32_MAX && scene.instanceParents[i] >= count))
+			{
+				throw std::runtime_error("Scene instance references a missing model or parent.");
+			}
+		}
+		for (const SceneLight& light : scene.lights)
+		{
+			if (light.type > Light::SPOT)
+			{
+				throw std::runtime_error("Scene light has an unknown type.");
+			}
+		}
+		if (scene.camera.type > CameraType::FPV)
+		{
+			throw std::runtime_error("Scene camera has an unknown type.");
+		}
+
+		return scene;
+	}
+}
\ No newline at end of file
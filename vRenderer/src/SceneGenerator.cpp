@@ -0,0 +1,160 @@
+#include "SceneGenerator.h"
+
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+
+namespace VRD::Scene
+{
+	bool SceneGenerator::Settings::applyCommandLine(int argc, char* argv[])
+	{
+		bool requested = false;
+		for (int i = 1; i < argc; i++)
+		{
+			std::string arg = argv[i];
+			if (arg == "--generate-scene" && i + 1 < argc)
+			{
+				instanceCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+				requested = true;
+			}
+			else if (arg == "--scene-distribution" && i + 1 < argc)
+			{
+				std::string value = argv[++i];
+				if (value == "grid") distribution = Distribution::GRID;
+				else if (value == "random") distribution = Distribution::RANDOM;
+				else if (value == "clustered") distribution = Distribution::CLUSTERED;
+				else throw std::runtime_error("Unknown scene distribution \"" + value + "\".");
+			}
+			else if (arg == "--scene-lights" && i + 1 < argc)
+			{
+				lightCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+			}
+			else if (arg == "--scene-models" && i + 1 < argc)
+			{
+				modelNames.clear();
+				std::stringstream names(argv[++i]);
+				std::string name;
+				while (std::getline(names, name, ','))
+				{
+					if (!name.empty()) modelNames.push_back(name);
+				}
+			}
+			else if (arg == "--scene-extent" && i + 1 < argc)
+			{
+				extent = std::stof(argv[++i]);
+			}
+			else if (arg == "--scene-seed" && i + 1 < argc)
+			{
+				seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+			}
+		}
+		return requested;
+	}
+
+	SceneData SceneGenerator::generate(const Settings& settings)
+	{
+		uint32_t count = std::min(settings.instanceCount, c_maxInstanceCount);
+		uint32_t modelCount = static_cast<uint32_t>(settings.modelNames.size());
+		if (count > 0 && modelCount == 0)
+		{
+			throw std::runtime_error("Scene generator has no models to instance.");
+		}
+
+		// Only the engine is fully specified by the standard, distributions are not,
+		// so values are derived from raw engine output to get the same scene on every platform
+		std::mt19937 rng(settings.seed);
+		auto uniform = [&rng](float min, float max) {
+			return min + (max - min) * static_cast<float>(rng() >> 8) * (1.0f / 16777216.0f);
+		};
+		// Argument evaluation order is unspecified, so every draw is a separate statement
+		auto uniformVec3 = [&uniform](glm::vec3 min, glm::vec3 max) {
+			glm::vec3 value;
+			value.x = uniform(min.x, max.x);
+			value.y = uniform(min.y, max.y);
+			value.z = uniform(min.z, max.z);
+			return value;
+		};
+		auto gaussian = [&uniform]() {
+			// Box-Muller transform
+			float u = std::max(uniform(0.0f, 1.0f), 1e-7f);
+			float v = uniform(0.0f, 1.0f);
+			return std::sqrt(-2.0f * std::log(u)) * std::cos(6.2831853f * v);
+		};
+
+		SceneData scene;
+		scene.modelNames = settings.modelNames;
+		scene.instanceModels.resize(count);
+		scene.instanceParents.assign(count, UINT32_MAX);
+		scene.positions.resize(count);
+		scene.rotations.assign(count, glm::vec3(0.0f));
+		scene.scales.assign(count, glm::vec3(1.0f));
+		scene.instanceFlags.assign(count, INSTANCE_VISIBLE);
+
+		float extent = std::max(settings.extent, 0.0f);
+		std::vector<glm::vec3> clusterCenters(std::max(settings.clusterCount, 1u));
+		if (settings.distribution == Distribution::CLUSTERED)
+		{
+			for (glm::vec3& center : clusterCenters)
+			{
+				center = uniformVec3(glm::vec3(-extent, 0.0f, -extent), glm::vec3(extent, 0.0f, extent));
+			}
+		}
+
+		uint32_t gridSide = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+		float gridSpacing = gridSide > 1 ? 2.0f * extent / (gridSide - 1) : 0.0f;
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			switch (settings.distribution)
+			{
+			case Distribution::GRID:
+				scene.instanceModels[i] = i % modelCount;
+				scene.positions[i] = glm::vec3(-extent + (i % gridSide) * gridSpacing, 0.0f, -extent + (i / gridSide) * gridSpacing);
+				break;
+			case Distribution::RANDOM:
+				scene.instanceModels[i] = rng() % modelCount;
+				scene.positions[i] = uniformVec3(glm::vec3(-extent, 0.0f, -extent), glm::vec3(extent, extent * 0.25f, extent));
+				break;
+			case Distribution::CLUSTERED:
+			{
+				scene.instanceModels[i] = rng() % modelCount;
+				const glm::vec3& center = clusterCenters[rng() % clusterCenters.size()];
+				float x = gaussian();
+				float y = gaussian();
+				float z = gaussian();
+				scene.positions[i] = center + glm::vec3(x, std::abs(y), z) * settings.clusterRadius;
+				break;
+			}
+			}
+
+			if (settings.randomizeTransforms && settings.distribution != Distribution::GRID)
+			{
+				scene.rotations[i].y = uniform(0.0f, 360.0f);
+				scene.scales[i] = glm::vec3(uniform(0.5f, 1.5f));
+			}
+		}
+
+		// Directional light first so the scene is lit with any number of point lights
+		for (uint32_t i = 0; i < settings.lightCount; i++)
+		{
+			Light light(0, i == 0 ? Light::DIRECTIONAL : Light::POINT);
+			light.direction = glm::normalize(glm::vec3(-0.3f, -1.0f, -0.2f));
+			if (i > 0)
+			{
+				light.position = uniformVec3(glm::vec3(-extent, 2.0f, -extent), glm::vec3(extent, 2.0f + extent * 0.25f, extent));
+				light.color = uniformVec3(glm::vec3(0.5f), glm::vec3(1.0f));
+			}
+			scene.lights.push_back(SceneLight::fromLight(light));
+		}
+
+		// Whole area in view
+		float viewDistance = std::max(extent, 5.0f);
+		scene.camera.type = CameraType::ORBIT;
+		scene.camera.position = glm::vec3(0.0f, viewDistance * 0.75f, viewDistance * 1.5f);
+		scene.camera.target = glm::vec3(0.0f);
+
+		return scene;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,490 @@
+#include "SceneGraph.h"
+#include "TransformKernel.h"
+#include "ThreadDispatcher.h"
+
+#include <cmath>
+#include <mutex>
+#include <stdexcept>
+
+namespace VRD::Scene
+{
+	// Below this many instances matrices are computed on the calling thread
+	static constexpr size_t c_parallelTransformThreshold = 4096;
+	static constexpr size_t c_transformsPerTask = 2048;
+
+	// Runs batch(first, last) over [0, count), split between workers for large batches
+	template<typename Batch>
+	static void forEachBatch(size_t count, Batch batch)
+	{
+		if (count < c_parallelTransformThreshold)
+		{
+			batch(size_t(0), count);
+			return;
+		}
+		ThreadDispatcher::instance().parallel_for(0, count, c_transformsPerTask, batch);
+	}
+
+	InstanceHandle SceneGraph::addInstance(std::shared_ptr<const Model> model)
+	{
+		std::string name = model->name + " (ModelInstance #" + std::to_string(global_nextId) + ")";
+		return emplace(std::move(model), std::move(name), glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(1.0f));
+	}
+
+	InstanceHandle SceneGraph::addInstance(std::shared_ptr<const Model> model, const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale)
+	{
+		std::string name = model->name + " (ModelInstance #" + std::to_string(global_nextId) + ")";
+		return emplace(std::move(model), std::move(name), position, rotation, scale);
+	}
+
+	InstanceHandle SceneGraph::cloneInstance(InstanceHandle handle)
+	{
+		uint32_t source = getDenseIndex(handle);
+		// Attributes are copied before emplace, which may reallocate the arrays
+		glm::vec3 position = positions[source];
+		glm::vec3 rotation = rotations[source];
+		glm::vec3 scale = scales[source];
+		InstanceHandle parent = parents[source];
+		InstanceHandle clone = emplace(models[source], names[source] + " Copy", position, rotation, scale);
+		if (parent.isValid())
+		{
+			link(clone, parent);
+			markDirty(dense(clone));
+		}
+		return clone;
+	}
+
+	/// <summary>
+	/// Removes instance by moving the last one into its place. Returns false if handle is no longer valid.
+	/// </summary>
+	bool SceneGraph::deleteInstance(InstanceHandle handle)
+	{
+		if (!isValid(handle)) return false;
+
+		journal.destroyed.push_back(handle);
+
+		InstanceHandle parent = parents[dense(handle)];
+		while (firstChildren[dense(handle)].isValid())
+		{
+			InstanceHandle child = firstChildren[dense(handle)];
+			unlink(child);
+			if (parent.isValid())
+			{
+				link(child, parent);
+			}
+			markDirty(dense(child));
+		}
+		unlink(handle);
+
+		uint32_t removed = slots[handle.index].denseIndex;
+		uint32_t last = static_cast<uint32_t>(handles.size() - 1);
+		if (removed != last)
+		{
+			handles[removed] = handles[last];
+			ids[removed] = ids[last];
+			positions[removed] = positions[last];
+			rotations[removed] = rotations[last];
+			scales[removed] = scales[last];
+			parents[removed] = parents[last];
+			firstChildren[removed] = firstChildren[last];
+			nextSiblings[removed] = nextSiblings[last];
+			previousSiblings[removed] = previousSiblings[last];
+			localMatrices[removed] = localMatrices[last];
+			worldMatrices[removed] = worldMatrices[last];
+			normalMatrices[removed] = normalMatrices[last];
+			models[removed] = std::move(models[last]);
+			flags[removed] = flags[last];
+			names[removed] = std::move(names[last]);
+			slots[handles[removed].index].denseIndex = removed;
+		}
+
+		handles.pop_back();
+		ids.pop_back();
+		positions.pop_back();
+		rotations.pop_back();
+		scales.pop_back();
+		parents.pop_back();
+		firstChildren.pop_back();
+		nextSiblings.pop_back();
+		previousSiblings.pop_back();
+		localMatrices.pop_back();
+		worldMatrices.pop_back();
+		normalMatrices.pop_back();
+		models.pop_back();
+		flags.pop_back();
+		names.pop_back();
+
+		slots[handle.index].generation++;
+		freeSlots.push_back(handle.index);
+		return true;
+	}
+
+	bool SceneGraph::setParent(InstanceHandle handle, InstanceHandle parent)
+	{
+		uint32_t index = getDenseIndex(handle);
+		if (parent.isValid())
+		{
+			for (InstanceHandle ancestor = parent; ancestor.isValid(); ancestor = parents[getDenseIndex(ancestor)])
+			{
+				if (ancestor == handle) return false;
+			}
+		}
+
+		if (parents[index] == parent) return true;
+
+		unlink(handle);
+		if (parent.isValid())
+		{
+			link(handle, parent);
+		}
+		markDirty(index);
+		return true;
+	}
+
+	InstanceHandle SceneGraph::getParent(InstanceHandle handle) const
+	{
+		return parents[getDenseIndex(handle)];
+	}
+
+	InstanceHandle SceneGraph::getFirstChild(InstanceHandle handle) const
+	{
+		return firstChildren[getDenseIndex(handle)];
+	}
+
+	InstanceHandle SceneGraph::getNextSibling(InstanceHandle handle) const
+	{
+		return nextSiblings[getDenseIndex(handle)];
+	}
+
+	bool SceneGraph::isValid(InstanceHandle handle) const
+	{
+		return handle.index < slots.size() && slots[handle.index].generation == handle.generation;
+	}
+
+	size_t SceneGraph::getInstanceCount() const
+	{
+		return handles.size();
+	}
+
+	void SceneGraph::reserve(size_t instanceCount)
+	{
+		slots.reserve(instanceCount);
+		handles.reserve(instanceCount);
+		ids.reserve(instanceCount);
+		positions.reserve(instanceCount);
+		rotations.reserve(instanceCount);
+		scales.reserve(instanceCount);
+		parents.reserve(instanceCount);
+		firstChildren.reserve(instanceCount);
+		nextSiblings.reserve(instanceCount);
+		previousSiblings.reserve(instanceCount);
+		localMatrices.reserve(instanceCount);
+		worldMatrices.reserve(instanceCount);
+		normalMatrices.reserve(instanceCount);
+		models.reserve(instanceCount);
+		flags.reserve(instanceCount);
+		names.reserve(instanceCount);
+	}
+
+	uint32_t SceneGraph::getDenseIndex(InstanceHandle handle) const
+	{
+		if (!isValid(handle))
+		{
+			throw std::runtime_error("Scene instance handle is no longer valid.");
+		}
+		return slots[handle.index].denseIndex;
+	}
+
+	InstanceHandle SceneGraph::getHandle(uint32_t denseIndex) const
+	{
+		return handles[denseIndex];
+	}
+
+	uint32_t SceneGraph::getId(InstanceHandle handle) const
+	{
+		return ids[getDenseIndex(handle)];
+	}
+
+	const std::string& SceneGraph::getName(InstanceHandle handle) const
+	{
+		return names[getDenseIndex(handle)];
+	}
+
+	const std::shared_ptr<const Model>& SceneGraph::getModel(InstanceHandle handle) const
+	{
+		return models[getDenseIndex(handle)];
+	}
+
+	ModelInstance SceneGraph::getModelInstance(InstanceHandle handle) const
+	{
+		uint32_t index = getDenseIndex(handle);
+		return ModelInstance(ids[index], handles[index], models[index]);
+	}
+
+	const glm::vec3& SceneGraph::getPosition(InstanceHandle handle) const
+	{
+		return positions[getDenseIndex(handle)];
+	}
+
+	const glm::vec3& SceneGraph::getRotation(InstanceHandle handle) const
+	{
+		return rotations[getDenseIndex(handle)];
+	}
+
+	const glm::vec3& SceneGraph::getScale(InstanceHandle handle) const
+	{
+		return scales[getDenseIndex(handle)];
+	}
+
+	void SceneGraph::setTransform(InstanceHandle handle, const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale)
+	{
+		uint32_t index = getDenseIndex(handle);
+		positions[index] = position;
+		rotations[index] = rotation;
+		scales[index] = scale;
+		markDirty(index);
+	}
+
+	const glm::mat4& SceneGraph::getLocalMatrix(InstanceHandle handle) const
+	{
+		return localMatrices[getDenseIndex(handle)];
+	}
+
+	const glm::mat4& SceneGraph::getWorldMatrix(InstanceHandle handle) const
+	{
+		return worldMatrices[getDenseIndex(handle)];
+	}
+
+	const glm::mat4& SceneGraph::getNormalMatrix(InstanceHandle handle) const
+	{
+		return normalMatrices[getDenseIndex(handle)];
+	}
+
+	uint8_t SceneGraph::getFlags(InstanceHandle handle) const
+	{
+		return flags[getDenseIndex(handle)];
+	}
+
+	bool SceneGraph::isVisible(InstanceHandle handle) const
+	{
+		return flags[getDenseIndex(handle)] & INSTANCE_VISIBLE;
+	}
+
+	void SceneGraph::setVisible(InstanceHandle handle, bool visible)
+	{
+		uint32_t index = getDenseIndex(handle);
+		uint8_t& instanceFlags = flags[index];
+		if (static_cast<bool>(instanceFlags & INSTANCE_VISIBLE) == visible) return;
+
+		instanceFlags = visible ? (instanceFlags | INSTANCE_VISIBLE) : (instanceFlags & ~INSTANCE_VISIBLE);
+		journal.visibilityChanged.push_back(handles[index]);
+		journal.visible.push_back(visible);
+	}
+
+	/// <summary>
+	/// Runs in three passes: local matrices of changed instances, world matrices down the changed subtrees
+	/// and normal matrices of everything that got a new world matrix. Local and normal passes are batched
+	/// by TransformKernel; subtrees don't overlap, so world pass of large batches is split between workers by subtree root.
+	/// </summary>
+	size_t SceneGraph::updateTransforms(std::vector<InstanceHandle>* updated)
+	{
+		changedIndices.clear();
+		rootIndices.clear();
+		for (InstanceHandle handle : dirtyInstances)
+		{
+			if (!isValid(handle) || !(flags[dense(handle)] & INSTANCE_TRANSFORM_DIRTY)) continue;
+
+			changedIndices.push_back(dense(handle));
+			bool ancestorDirty = false;
+			for (InstanceHandle ancestor = parents[dense(handle)]; ancestor.isValid() && !ancestorDirty; ancestor = parents[dense(ancestor)])
+			{
+				ancestorDirty = flags[dense(ancestor)] & INSTANCE_TRANSFORM_DIRTY;
+			}
+			if (!ancestorDirty)
+			{
+				rootIndices.push_back(dense(handle));
+			}
+		}
+		dirtyInstances.clear();
+
+		forEachBatch(changedIndices.size(), [this](size_t first, size_t last) {
+			TransformKernel::composeLocal(positions.data(), rotations.data(), scales.data(),
+				changedIndices.data() + first, last - first, localMatrices.data());
+			});
+		for (uint32_t index : changedIndices)
+		{
+			flags[index] &= ~INSTANCE_TRANSFORM_DIRTY;
+		}
+
+		updatedIndices.clear();
+		if (changedIndices.size() < c_parallelTransformThreshold)
+		{
+			for (uint32_t root : rootIndices)
+			{
+				updateSubtree(root, updatedIndices);
+			}
+		}
+		else
+		{
+			std::mutex mutex;
+			ThreadDispatcher::instance().parallel_for(0, rootIndices.size(), 0, [&](size_t first, size_t last) {
+				std::vector<uint32_t> rangeUpdated;
+				for (size_t i = first; i < last; i++)
+				{
+					updateSubtree(rootIndices[i], rangeUpdated);
+				}
+				std::lock_guard<std::mutex> lock(mutex);
+				updatedIndices.insert(updatedIndices.end(), rangeUpdated.begin(), rangeUpdated.end());
+				});
+		}
+
+		forEachBatch(updatedIndices.size(), [this](size_t first, size_t last) {
+			TransformKernel::computeNormals(worldMatrices.data(), updatedIndices.data() + first, last - first, normalMatrices.data());
+			});
+
+		size_t journalOffset = journal.transformed.size();
+		journal.transformed.resize(journalOffset + updatedIndices.size());
+		journal.worldMatrices.resize(journalOffset + updatedIndices.size());
+		journal.normalMatrices.resize(journalOffset + updatedIndices.size());
+		forEachBatch(updatedIndices.size(), [this, journalOffset](size_t first, size_t last) {
+			for (size_t i = first; i < last; i++)
+			{
+				uint32_t index = updatedIndices[i];
+				journal.transformed[journalOffset + i] = handles[index];
+				journal.worldMatrices[journalOffset + i] = worldMatrices[index];
+				journal.normalMatrices[journalOffset + i] = normalMatrices[index];
+			}
+			});
+
+		if (updated != nullptr)
+		{
+			for (uint32_t index : updatedIndices)
+			{
+				updated->push_back(handles[index]);
+			}
+		}
+		return updatedIndices.size();
+	}
+
+	void SceneGraph::updateSubtree(uint32_t root, std::vector<uint32_t>& updated)
+	{
+		// Depth first walk over sibling links, world matrix of the parent is always updated before its children
+		uint32_t index = root;
+		while (true)
+		{
+			worldMatrices[index] = parents[index].isValid() ?
+				TransformKernel::multiply(worldMatrices[dense(parents[index])], localMatrices[index]) : localMatrices[index];
+			updated.push_back(index);
+
+			if (firstChildren[index].isValid())
+			{
+				index = dense(firstChildren[index]);
+				continue;
+			}
+
+			// Climb up until a node with a next sibling, without leaving the subtree
+			while (index != root && !nextSiblings[index].isValid())
+			{
+				index = dense(parents[index]);
+			}
+			if (index == root) break;
+			index = dense(nextSiblings[index]);
+		}
+	}
+
+	InstanceHandle SceneGraph::emplace(std::shared_ptr<const Model> model, std::string name,
+		const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale)
+	{
+		uint32_t slotIndex;
+		if (!freeSlots.empty())
+		{
+			slotIndex = freeSlots.back();
+			freeSlots.pop_back();
+		}
+		else
+		{
+			slotIndex = static_cast<uint32_t>(slots.size());
+			slots.push_back({});
+		}
+
+		uint32_t index = static_cast<uint32_t>(handles.size());
+		slots[slotIndex].denseIndex = index;
+		InstanceHandle handle = { slotIndex, slots[slotIndex].generation };
+		glm::mat4 localMatrix = TransformKernel::compose(position, rotation, scale);
+		glm::mat4 normalMatrix = TransformKernel::normalMatrix(localMatrix);
+		uint32_t id = global_nextId++;
+
+		// New instance is a root until linked, so its world matrix is already known
+		journal.created.emplace_back(id, handle, model);
+		journal.transformed.push_back(handle);
+		journal.worldMatrices.push_back(localMatrix);
+		journal.normalMatrices.push_back(normalMatrix);
+
+		handles.push_back(handle);
+		ids.push_back(id);
+		positions.push_back(position);
+		rotations.push_back(rotation);
+		scales.push_back(scale);
+		parents.push_back({});
+		firstChildren.push_back({});
+		nextSiblings.push_back({});
+		previousSiblings.push_back({});
+		localMatrices.push_back(localMatrix);
+		worldMatrices.push_back(localMatrix);
+		normalMatrices.push_back(normalMatrix);
+		models.push_back(std::move(model));
+		flags.push_back(INSTANCE_VISIBLE);
+		names.push_back(std::move(name));
+		return handle;
+	}
+
+	void SceneGraph::markDirty(uint32_t denseIndex)
+	{
+		if (flags[denseIndex] & INSTANCE_TRANSFORM_DIRTY) return;
+
+		flags[denseIndex] |= INSTANCE_TRANSFORM_DIRTY;
+		dirtyInstances.push_back(handles[denseIndex]);
+	}
+
+	// Adds instance as the first child of parent
+	void SceneGraph::link(InstanceHandle handle, InstanceHandle parent)
+	{
+		uint32_t index = dense(handle);
+		uint32_t parentIndex = dense(parent);
+		InstanceHandle oldFirst = firstChildren[parentIndex];
+
+		parents[index] = parent;
+		previousSiblings[index] = {};
+		nextSiblings[index] = oldFirst;
+		if (oldFirst.isValid())
+		{
+			previousSiblings[dense(oldFirst)] = handle;
+		}
+		firstChildren[parentIndex] = handle;
+	}
+
+	void SceneGraph::unlink(InstanceHandle handle)
+	{
+		uint32_t index = dense(handle);
+		InstanceHandle parent = parents[index];
+		if (!parent.isValid()) return;
+
+		InstanceHandle previous = previousSiblings[index];
+		InstanceHandle next = nextSiblings[index];
+		if (previous.isValid())
+		{
+			nextSiblings[dense(previous)] = next;
+		}
+		else
+		{
+			firstChildren[dense(parent)] = next;
+		}
+		if (next.isValid())
+		{
+			previousSiblings[dense(next)] = previous;
+		}
+
+		parents[index] = {};
+		previousSiblings[index] = {};
+		nextSiblings[index] = {};
+	}
+}
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include "TaskGraph.h"
+
+#include <chrono>
+#include <stdexcept>
+
+static constexpr TaskGraph::TaskId c_invalidTask = UINT32_MAX;
+
+std::shared_ptr<TaskGraph> TaskGraph::create()
+{
+	return std::shared_ptr<TaskGraph>(new TaskGraph());
+}
+
+TaskGraph::TaskId TaskGraph::addNode(Work work, Affinity affinity, DispatchPriority priority)
+{
+	if (started)
+	{
+		throw std::runtime_error("Tasks can't be added to a graph that is already running.");
+	}
+
+	Node& node = nodes.emplace_back();
+	node.work = std::move(work);
+	node.affinity = affinity;
+	node.priority = priority;
+	return static_cast<TaskId>(nodes.size() - 1);
+}
+
+void TaskGraph::addDependency(TaskId task, TaskId dependency)
+{
+	if (started)
+	{
+		throw std::runtime_error("Dependencies can't be added to a graph that is already running.");
+	}
+	if (task >= nodes.size() || dependency >= nodes.size() || task == dependency)
+	{
+		throw std::runtime_error("Invalid task graph dependency.");
+	}
+
+	nodes[dependency].successors.push_back(task);
+	nodes[task].pendingDependencies++;
+}
+
+void TaskGraph::run()
+{
+	if (started.exchange(true))
+	{
+		throw std::runtime_error("Task graph is already running.");
+	}
+	validate();
+
+	unfinishedCount = static_cast<uint32_t>(nodes.size());
+	if (nodes.empty())
+	{
+		finishedCondition.notify_all();
+		return;
+	}
+
+	// Roots are collected before scheduling any of them, since scheduled tasks start changing dependency counters right away
+	std::vector<TaskId> roots;
+	for (TaskId i = 0; i < nodes.size(); i++)
+	{
+		if (nodes[i].pendingDependencies == 0)
+		{
+			roots.push_back(i);
+		}
+	}
+	for (TaskId root : roots)
+	{
+		schedule(root);
+	}
+}
+
+void TaskGraph::wait()
+{
+	while (!isFinished())
+	{
+		if (!ThreadDispatcher::instance().tryRunWorkerTask())
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			finishedCondition.wait_for(lock, std::chrono::milliseconds(1), [this]() { return isFinished(); });
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (exception)
+	{
+		std::rethrow_exception(exception);
+	}
+}
+
+bool TaskGraph::isFinished() const
+{
+	return started && unfinishedCount.load(std::memory_order_acquire) == 0;
+}
+
+/// <summary>
+/// Checks that every task is reachable by topological traversal, otherwise graph has a cycle and would never finish.
+/// </summary>
+void TaskGraph::validate() const
+{
+	std::vector<uint32_t> dependencyCounts(nodes.size());
+	std::vector<TaskId> ready;
+	for (TaskId i = 0; i < nodes.size(); i++)
+	{
+		dependencyCounts[i] = nodes[i].pendingDependencies;
+		if (dependencyCounts[i] == 0)
+		{
+			ready.push_back(i);
+		}
+	}
+
+	size_t visitedCount = 0;
+	while (!ready.empty())
+	{
+		TaskId task = ready.back();
+		ready.pop_back();
+		visitedCount++;
+		for (TaskId successor : nodes[task].successors)
+		{
+			if (--dependencyCounts[successor] == 0)
+			{
+				ready.push_back(successor);
+			}
+		}
+	}
+
+	if (visitedCount != nodes.size())
+	{
+		throw std::runtime_error("Task graph has a dependency cycle.");
+	}
+}
+
+void TaskGraph::schedule(TaskId task)
+{
+	auto self = shared_from_this();
+	if (nodes[task].affinity == Affinity::MAIN)
+	{
+		ThreadDispatcher::instance().main(nodes[task].priority, [self, task]() { self->execute(task); });
+	}
+	else
+	{
+		ThreadDispatcher::instance().worker([self, task]() { self->execute(task); });
+	}
+}
+
+/// <summary>
+/// Runs a task and releases its successors. One successor that may run on the same thread
+/// is continued right away instead of going through the queue.
+/// </summary>
+void TaskGraph::execute(TaskId task)
+{
+	while (task != c_invalidTask)
+	{
+		Node& node = nodes[task];
+		if (!failed.load(std::memory_order_relaxed))
+		{
+			try
+			{
+				node.work();
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (!exception)
+				{
+					exception = std::current_exception();
+				}
+				failed = true;
+			}
+		}
+		node.work.reset();
+
+		TaskId next = c_invalidTask;
+		for (TaskId successor : node.successors)
+		{
+			if (nodes[successor].pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				if (next == c_invalidTask && node.affinity == Affinity::WORKER && nodes[successor].affinity == Affinity::WORKER)
+				{
+					next = successor;
+				}
+				else
+				{
+					schedule(successor);
+				}
+			}
+		}
+
+		if (unfinishedCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			finishedCondition.notify_all();
+		}
+
+		task = next;
+	}
+}
\ No newline at end of file
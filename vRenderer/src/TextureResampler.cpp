@@ -0,0 +1,123 @@
+#include "TextureResampler.h"
+#include "ThreadDispatcher.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VRD_RESAMPLER_SSE2
+#include <emmintrin.h>
+#endif
+
+// Rows of the downscaled image processed by a single task. Smaller images are processed on the calling thread.
+static constexpr uint32_t c_rowsPerTask = 64;
+
+/// <summary>
+/// Halves texture extent until it fits into maxSize x maxSize. Aspect ratio is preserved.
+/// Content hash is recomputed by the caller, since downscaled data differs from the decoded one.
+/// </summary>
+bool TextureResampler::downscaleToFit(Texture& texture, uint32_t maxSize)
+{
+	if (maxSize == 0 || texture.ptr == nullptr || (texture.width <= maxSize && texture.height <= maxSize))
+	{
+		return false;
+	}
+
+	while (texture.width > maxSize || texture.height > maxSize)
+	{
+		uint32_t width = std::max(texture.width / 2, 1u);
+		uint32_t height = std::max(texture.height / 2, 1u);
+		uint32_t size = width * height * 4;
+
+		uint8_t* downscaled = static_cast<uint8_t*>(malloc(size));
+		if (downscaled == nullptr)
+		{
+			throw std::runtime_error("Failed to allocate memory for downscaled texture \"" + texture.name + "\".");
+		}
+		halve(texture.ptr, texture.width, texture.height, downscaled);
+
+		free(texture.ptr);
+		texture.ptr = downscaled;
+		texture.width = width;
+		texture.height = height;
+		texture.size = size;
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Box filters RGBA8 image into one of half its width and height.
+/// Destination must hold max(srcWidth / 2, 1) * max(srcHeight / 2, 1) pixels.
+/// </summary>
+void TextureResampler::halve(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst)
+{
+	uint32_t dstHeight = std::max(srcHeight / 2, 1u);
+
+	if (dstHeight <= c_rowsPerTask)
+	{
+		halveRows(src, srcWidth, srcHeight, dst, 0, dstHeight);
+		return;
+	}
+
+	ThreadDispatcher::instance().parallel_for(0, dstHeight, c_rowsPerTask, [=](size_t firstRow, size_t lastRow) {
+		halveRows(src, srcWidth, srcHeight, dst, static_cast<uint32_t>(firstRow), static_cast<uint32_t>(lastRow));
+		});
+}
+
+void TextureResampler::halveRows(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst, uint32_t firstRow, uint32_t lastRow)
+{
+	uint32_t dstWidth = std::max(srcWidth / 2, 1u);
+	size_t srcStride = static_cast<size_t>(srcWidth) * 4;
+	size_t dstStride = static_cast<size_t>(dstWidth) * 4;
+
+	for (uint32_t y = firstRow; y < lastRow; y++)
+	{
+		// Odd trailing row/column is dropped, same as for mip maps. 1 pixel wide/high sources are averaged with themselves.
+		const uint8_t* row0 = src + static_cast<size_t>(2 * y) * srcStride;
+		const uint8_t* row1 = src + static_cast<size_t>(std::min(2 * y + 1, srcHeight - 1)) * srcStride;
+		uint8_t* dstRow = dst + y * dstStride;
+
+		uint32_t x = 0;
+
+#ifdef VRD_RESAMPLER_SSE2
+		// 4 destination pixels per iteration: 8 source pixels from each of the two rows.
+		// Pixels are widened to 16 bit lanes and summed, so the result is rounded exactly like the scalar path below.
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i rounding = _mm_set1_epi16(2);
+		for (; x + 4 <= srcWidth / 2; x += 4)
+		{
+			__m128i top0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+			__m128i top1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8 + 16));
+			__m128i bottom0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+			__m128i bottom1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8 + 16));
+
+			// Vertical sums of source pixel pairs (0, 1), (2, 3), (4, 5) and (6, 7)
+			__m128i vertical01 = _mm_add_epi16(_mm_unpacklo_epi8(top0, zero), _mm_unpacklo_epi8(bottom0, zero));
+			__m128i vertical23 = _mm_add_epi16(_mm_unpackhi_epi8(top0, zero), _mm_unpackhi_epi8(bottom0, zero));
+			__m128i vertical45 = _mm_add_epi16(_mm_unpacklo_epi8(top1, zero), _mm_unpacklo_epi8(bottom1, zero));
+			__m128i vertical67 = _mm_add_epi16(_mm_unpackhi_epi8(top1, zero), _mm_unpackhi_epi8(bottom1, zero));
+
+			// Even pixels are added to odd ones, giving destination pixels (0, 1) and (2, 3)
+			__m128i sum01 = _mm_add_epi16(_mm_unpacklo_epi64(vertical01, vertical23), _mm_unpackhi_epi64(vertical01, vertical23));
+			__m128i sum23 = _mm_add_epi16(_mm_unpacklo_epi64(vertical45, vertical67), _mm_unpackhi_epi64(vertical45, vertical67));
+
+			sum01 = _mm_srli_epi16(_mm_add_epi16(sum01, rounding), 2);
+			sum23 = _mm_srli_epi16(_mm_add_epi16(sum23, rounding), 2);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dstRow + x * 4), _mm_packus_epi16(sum01, sum23));
+		}
+#endif
+
+		for (; x < dstWidth; x++)
+		{
+			uint32_t x0 = 2 * x;
+			uint32_t x1 = std::min(2 * x + 1, srcWidth - 1);
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				uint32_t sum = row0[x0 * 4 + c] + row0[x1 * 4 + c] + row1[x0 * 4 + c] + row1[x1 * 4 + c];
+				dstRow[x * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+			}
+		}
+	}
+}
\ No newline at end of file
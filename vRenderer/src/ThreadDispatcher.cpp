@@ -1,30 +1,86 @@
 #include "ThreadDispatcher.h"
 
-ThreadDispatcher::ThreadDispatcher()
+ThreadDispatcher::ThreadDispatcher(const ThreadTopology& topology)
 {
-    // Allocate the number of threads equal to the number of logical CPU cores
-    workerPool = std::make_unique<ThreadPool>(std::thread::hardware_concurrency());
+    bool pinCpuThreads = topology.pinCpuThreads;
+    workerPool = std::make_unique<WorkStealingPool>(topology.getCpuThreadCount(), [pinCpuThreads](uint32_t index) {
+        ThreadTopology::setupCurrentThread("vrd-cpu-" + std::to_string(index), pinCpuThreads ? static_cast<int32_t>(index) : -1);
+        });
+    ioPool = std::make_unique<WorkStealingPool>(topology.getIoThreadCount(), [](uint32_t index) {
+        ThreadTopology::setupCurrentThread("vrd-io-" + std::to_string(index));
+        });
+
+    cpuMetricsBase = workerPool->getMetrics();
+    ioMetricsBase = ioPool->getMetrics();
+}
+
+/// <summary>
+/// Runs tasks dispatched to main thread, higher priorities first. Tasks dispatched while processing are run on the next call.
+/// Once the budget is spent, remaining tasks wait for the next call, so a burst of completions is spread across frames.
+/// Every non-empty queue runs at least one task per call, so higher priorities can't starve lower ones indefinitely.
+/// </summary>
+void ThreadDispatcher::process(float budgetMs)
+{
+    using Clock = MpscTaskQueue::Clock;
+    Clock::time_point deadline = budgetMs > 0.0f
+        ? Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float, std::milli>(budgetMs))
+        : Clock::time_point::max();
+
+    // Queues reached after the deadline run a single task and count the call as starved
+    for (MpscTaskQueue& queue : mainQueues)
+    {
+        queue.process(deadline, 1);
+    }
+}
+
+const MpscTaskQueue::Stats& ThreadDispatcher::getMainQueueStats(DispatchPriority priority) const
+{
+    return mainQueues[static_cast<size_t>(priority)].getStats();
 }
 
-void ThreadDispatcher::process()
+/// <summary>
+/// Pool metrics are turned into per-window deltas, so utilization and latencies reflect recent load rather than the whole run.
+/// </summary>
+const ThreadingMetrics& ThreadDispatcher::getMetrics(float windowMs)
 {
-    std::queue<Task> tasks;
+    PoolMetrics cpu = workerPool->getMetrics();
+    float elapsedMs = std::chrono::duration<float, std::milli>(cpu.sampleTime - cpuMetricsBase.sampleTime).count();
+    if (elapsedMs < windowMs)
     {
-        std::lock_guard<std::mutex> lock(queueMutex);
-        std::swap(tasks, taskQueue);
+        return metrics;
     }
 
-    while (!tasks.empty()) 
+    PoolMetrics io = ioPool->getMetrics();
+    metrics.cpu = cpu;
+    metrics.cpu.subtract(cpuMetricsBase);
+    metrics.io = io;
+    metrics.io.subtract(ioMetricsBase);
+    for (size_t i = 0; i < static_cast<size_t>(DispatchPriority::COUNT); i++)
     {
-        Task task = tasks.front();
-        tasks.pop();
-        task.function(task.data);
+        metrics.main[i] = mainQueues[i].getStats();
     }
+    metrics.windowMs = elapsedMs;
+
+    cpuMetricsBase = std::move(cpu);
+    ioMetricsBase = std::move(io);
+    return metrics;
+}
+
+bool ThreadDispatcher::tryRunWorkerTask()
+{
+    return workerPool->tryRunPendingTask();
 }
 
-// Add a task to the main thread dispatcher
-void ThreadDispatcher::dispatch_main_internal(void (*function)(void*), void* data)
+uint32_t ThreadDispatcher::getWorkerCount() const
 {
-    std::lock_guard<std::mutex> lock(queueMutex);
-    taskQueue.push({ function, data });
+    return workerPool->getThreadCount();
+}
+
+size_t ThreadDispatcher::getGrainSize(size_t count, size_t grainSize) const
+{
+    if (grainSize > 0) return grainSize;
+
+    // Several ranges per worker to balance uneven ranges
+    size_t rangeCount = static_cast<size_t>(getWorkerCount() + 1) * 4;
+    return std::max<size_t>((count + rangeCount - 1) / rangeCount, 1);
 }
\ No newline at end of file
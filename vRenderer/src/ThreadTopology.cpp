@@ -0,0 +1,64 @@
+#include "ThreadTopology.h"
+
+#include <thread>
+#include <algorithm>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+void ThreadTopology::applyCommandLine(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--cpu-threads" && i + 1 < argc)
+		{
+			cpuThreadCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (arg == "--io-threads" && i + 1 < argc)
+		{
+			ioThreadCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (arg == "--pin-threads")
+		{
+			pinCpuThreads = true;
+		}
+	}
+}
+
+uint32_t ThreadTopology::getCpuThreadCount() const
+{
+	return cpuThreadCount > 0 ? cpuThreadCount : std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+uint32_t ThreadTopology::getIoThreadCount() const
+{
+	return std::max(ioThreadCount, 1u);
+}
+
+void ThreadTopology::setupCurrentThread(const std::string& name, int32_t core)
+{
+#ifdef _WIN32
+	std::wstring wideName(name.begin(), name.end());
+	SetThreadDescription(GetCurrentThread(), wideName.c_str());
+	if (core >= 0)
+	{
+		SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << (core % (sizeof(DWORD_PTR) * 8)));
+	}
+#else
+	// Linux limits thread names to 15 characters
+	pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+	if (core >= 0)
+	{
+		cpu_set_t cpuSet;
+		CPU_ZERO(&cpuSet);
+		CPU_SET(core % CPU_SETSIZE, &cpuSet);
+		pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+	}
+#endif
+}
\ No newline at end of file
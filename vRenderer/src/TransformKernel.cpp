@@ -0,0 +1,229 @@
+#include "TransformKernel.h"
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VRD_TRANSFORM_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace VRD::Scene
+{
+#ifdef VRD_TRANSFORM_SSE2
+	/// <summary>
+	/// Sine and cosine of 4 angles (radians). Argument is reduced to [-pi/4, pi/4] by multiples of pi/2
+	/// and evaluated with minimax polynomials (Cephes sinf/cosf), error is within a few ulp for |x| < 8192.
+	/// </summary>
+	static inline void sincos4(__m128 x, __m128& sine, __m128& cosine)
+	{
+		// pi/2 split in three parts, so that j * part is exact for the first two
+		const __m128 c_halfPi1 = _mm_set1_ps(1.5703125f);
+		const __m128 c_halfPi2 = _mm_set1_ps(4.837512969970703125e-4f);
+		const __m128 c_halfPi3 = _mm_set1_ps(7.54978995489188216e-8f);
+
+		__m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(0.63661977236758134f)));
+		__m128 j = _mm_cvtepi32_ps(quadrant);
+		__m128 r = _mm_sub_ps(x, _mm_mul_ps(j, c_halfPi1));
+		r = _mm_sub_ps(r, _mm_mul_ps(j, c_halfPi2));
+		r = _mm_sub_ps(r, _mm_mul_ps(j, c_halfPi3));
+		__m128 r2 = _mm_mul_ps(r, r);
+
+		__m128 sinPoly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-1.9515295891e-4f), r2), _mm_set1_ps(8.3321608736e-3f));
+		sinPoly = _mm_add_ps(_mm_mul_ps(sinPoly, r2), _mm_set1_ps(-1.6666654611e-1f));
+		sinPoly = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sinPoly, r2), r), r);
+
+		__m128 cosPoly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.443315711809948e-5f), r2), _mm_set1_ps(-1.388731625493765e-3f));
+		cosPoly = _mm_add_ps(_mm_mul_ps(cosPoly, r2), _mm_set1_ps(4.166664568298827e-2f));
+		cosPoly = _mm_mul_ps(_mm_mul_ps(cosPoly, r2), r2);
+		cosPoly = _mm_add_ps(_mm_sub_ps(cosPoly, _mm_mul_ps(r2, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+
+		// Odd quadrants swap sine and cosine, quadrants 2 and 3 negate sine, 1 and 2 negate cosine
+		const __m128i one = _mm_set1_epi32(1);
+		const __m128i two = _mm_set1_epi32(2);
+		__m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+		__m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+		__m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+
+		sine = _mm_or_ps(_mm_and_ps(swap, cosPoly), _mm_andnot_ps(swap, sinPoly));
+		cosine = _mm_or_ps(_mm_and_ps(swap, sinPoly), _mm_andnot_ps(swap, cosPoly));
+		sine = _mm_xor_ps(sine, sinSign);
+		cosine = _mm_xor_ps(cosine, cosSign);
+	}
+
+	// Transposes 4 registers holding one matrix column element per lane into the columns of 4 matrices
+	static inline void storeColumn(__m128 x, __m128 y, __m128 z, __m128 w, glm::mat4* matrices, const uint32_t* indices, int column)
+	{
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+		_mm_storeu_ps(&matrices[indices[0]][column][0], x);
+		_mm_storeu_ps(&matrices[indices[1]][column][0], y);
+		_mm_storeu_ps(&matrices[indices[2]][column][0], z);
+		_mm_storeu_ps(&matrices[indices[3]][column][0], w);
+	}
+
+	// Inverse of storeColumn: x, y, z and w of the given column of 4 matrices
+	static inline void loadColumn(const glm::mat4* matrices, const uint32_t* indices, int column, __m128& x, __m128& y, __m128& z, __m128& w)
+	{
+		x = _mm_loadu_ps(&matrices[indices[0]][column][0]);
+		y = _mm_loadu_ps(&matrices[indices[1]][column][0]);
+		z = _mm_loadu_ps(&matrices[indices[2]][column][0]);
+		w = _mm_loadu_ps(&matrices[indices[3]][column][0]);
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+	}
+
+	static inline __m128 gather(const glm::vec3* values, const uint32_t* indices, int component)
+	{
+		return _mm_setr_ps(values[indices[0]][component], values[indices[1]][component],
+			values[indices[2]][component], values[indices[3]][component]);
+	}
+#endif
+
+	void TransformKernel::composeLocal(const glm::vec3* positions, const glm::vec3* rotations, const glm::vec3* scales,
+		const uint32_t* indices, size_t count, glm::mat4* locals)
+	{
+		size_t i = 0;
+#ifdef VRD_TRANSFORM_SSE2
+		const __m128 toRadians = _mm_set1_ps(0.01745329251994329577f);
+		const __m128 zero = _mm_setzero_ps();
+		for (; i + 4 <= count; i += 4)
+		{
+			const uint32_t* lanes = indices + i;
+
+			__m128 sx, cx, sy, cy, sz, cz;
+			sincos4(_mm_mul_ps(gather(rotations, lanes, 0), toRadians), sx, cx);
+			sincos4(_mm_mul_ps(gather(rotations, lanes, 1), toRadians), sy, cy);
+			sincos4(_mm_mul_ps(gather(rotations, lanes, 2), toRadians), sz, cz);
+
+			__m128 scaleX = gather(scales, lanes, 0);
+			__m128 scaleY = gather(scales, lanes, 1);
+			__m128 scaleZ = gather(scales, lanes, 2);
+
+			__m128 sysx = _mm_mul_ps(sy, sx);
+			__m128 sycx = _mm_mul_ps(sy, cx);
+
+			storeColumn(
+				_mm_mul_ps(_mm_mul_ps(cz, cy), scaleX),
+				_mm_mul_ps(_mm_mul_ps(sz, cy), scaleX),
+				_mm_mul_ps(_mm_sub_ps(zero, sy), scaleX),
+				zero, locals, lanes, 0);
+			storeColumn(
+				_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(cz, sysx), _mm_mul_ps(sz, cx)), scaleY),
+				_mm_mul_ps(_mm_add_ps(_mm_mul_ps(sz, sysx), _mm_mul_ps(cz, cx)), scaleY),
+				_mm_mul_ps(_mm_mul_ps(cy, sx), scaleY),
+				zero, locals, lanes, 1);
+			storeColumn(
+				_mm_mul_ps(_mm_add_ps(_mm_mul_ps(cz, sycx), _mm_mul_ps(sz, sx)), scaleZ),
+				_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(sz, sycx), _mm_mul_ps(cz, sx)), scaleZ),
+				_mm_mul_ps(_mm_mul_ps(cy, cx), scaleZ),
+				zero, locals, lanes, 2);
+			storeColumn(gather(positions, lanes, 0), gather(positions, lanes, 1), gather(positions, lanes, 2),
+				_mm_set1_ps(1.0f), locals, lanes, 3);
+		}
+#endif
+		for (; i < count; i++)
+		{
+			uint32_t index = indices[i];
+			locals[index] = compose(positions[index], rotations[index], scales[index]);
+		}
+	}
+
+	void TransformKernel::computeNormals(const glm::mat4* worlds, const uint32_t* indices, size_t count, glm::mat4* normals)
+	{
+		size_t i = 0;
+#ifdef VRD_TRANSFORM_SSE2
+		const __m128 zero = _mm_setzero_ps();
+		for (; i + 4 <= count; i += 4)
+		{
+			const uint32_t* lanes = indices + i;
+
+			__m128 ax, ay, az, bx, by, bz, cx, cy, cz, unused;
+			loadColumn(worlds, lanes, 0, ax, ay, az, unused);
+			loadColumn(worlds, lanes, 1, bx, by, bz, unused);
+			loadColumn(worlds, lanes, 2, cx, cy, cz, unused);
+
+			// Inverse transpose of [a b c] is [b x c, c x a, a x b] / det
+			__m128 nax = _mm_sub_ps(_mm_mul_ps(by, cz), _mm_mul_ps(bz, cy));
+			__m128 nay = _mm_sub_ps(_mm_mul_ps(bz, cx), _mm_mul_ps(bx, cz));
+			__m128 naz = _mm_sub_ps(_mm_mul_ps(bx, cy), _mm_mul_ps(by, cx));
+			__m128 nbx = _mm_sub_ps(_mm_mul_ps(cy, az), _mm_mul_ps(cz, ay));
+			__m128 nby = _mm_sub_ps(_mm_mul_ps(cz, ax), _mm_mul_ps(cx, az));
+			__m128 nbz = _mm_sub_ps(_mm_mul_ps(cx, ay), _mm_mul_ps(cy, ax));
+			__m128 ncx = _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by));
+			__m128 ncy = _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz));
+			__m128 ncz = _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx));
+
+			__m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, nax), _mm_mul_ps(ay, nay)), _mm_mul_ps(az, naz));
+			// Degenerate (zero scale) transforms get a zero normal matrix instead of infinities
+			__m128 invDet = _mm_and_ps(_mm_cmpneq_ps(det, zero), _mm_div_ps(_mm_set1_ps(1.0f), det));
+
+			storeColumn(_mm_mul_ps(nax, invDet), _mm_mul_ps(nay, invDet), _mm_mul_ps(naz, invDet), zero, normals, lanes, 0);
+			storeColumn(_mm_mul_ps(nbx, invDet), _mm_mul_ps(nby, invDet), _mm_mul_ps(nbz, invDet), zero, normals, lanes, 1);
+			storeColumn(_mm_mul_ps(ncx, invDet), _mm_mul_ps(ncy, invDet), _mm_mul_ps(ncz, invDet), zero, normals, lanes, 2);
+			const __m128 w = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+			for (int lane = 0; lane < 4; lane++)
+			{
+				_mm_storeu_ps(&normals[lanes[lane]][3][0], w);
+			}
+		}
+#endif
+		for (; i < count; i++)
+		{
+			normals[indices[i]] = normalMatrix(worlds[indices[i]]);
+		}
+	}
+
+	/// <summary>
+	/// Same matrix as translate * rotateZ * rotateY * rotateX * scale, written out to skip the four matrix products.
+	/// </summary>
+	glm::mat4 TransformKernel::compose(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale)
+	{
+		glm::vec3 radians = glm::radians(rotation);
+		float sx = std::sin(radians.x), cx = std::cos(radians.x);
+		float sy = std::sin(radians.y), cy = std::cos(radians.y);
+		float sz = std::sin(radians.z), cz = std::cos(radians.z);
+
+		glm::mat4 m;
+		m[0] = glm::vec4(cz * cy, sz * cy, -sy, 0.0f) * scale.x;
+		m[1] = glm::vec4(cz * sy * sx - sz * cx, sz * sy * sx + cz * cx, cy * sx, 0.0f) * scale.y;
+		m[2] = glm::vec4(cz * sy * cx + sz * sx, sz * sy * cx - cz * sx, cy * cx, 0.0f) * scale.z;
+		m[3] = glm::vec4(position, 1.0f);
+		return m;
+	}
+
+	glm::mat4 TransformKernel::normalMatrix(const glm::mat4& world)
+	{
+		glm::vec3 a(world[0]), b(world[1]), c(world[2]);
+		glm::vec3 na = glm::cross(b, c);
+		float det = glm::dot(a, na);
+		float invDet = det != 0.0f ? 1.0f / det : 0.0f;
+
+		glm::mat4 m(0.0f);
+		m[0] = glm::vec4(na * invDet, 0.0f);
+		m[1] = glm::vec4(glm::cross(c, a) * invDet, 0.0f);
+		m[2] = glm::vec4(glm::cross(a, b) * invDet, 0.0f);
+		m[3] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		return m;
+	}
+
+	glm::mat4 TransformKernel::multiply(const glm::mat4& a, const glm::mat4& b)
+	{
+#ifdef VRD_TRANSFORM_SSE2
+		__m128 a0 = _mm_loadu_ps(&a[0][0]);
+		__m128 a1 = _mm_loadu_ps(&a[1][0]);
+		__m128 a2 = _mm_loadu_ps(&a[2][0]);
+		__m128 a3 = _mm_loadu_ps(&a[3][0]);
+
+		glm::mat4 m;
+		for (int column = 0; column < 4; column++)
+		{
+			__m128 result = _mm_mul_ps(a0, _mm_set1_ps(b[column][0]));
+			result = _mm_add_ps(result, _mm_mul_ps(a1, _mm_set1_ps(b[column][1])));
+			result = _mm_add_ps(result, _mm_mul_ps(a2, _mm_set1_ps(b[column][2])));
+			result = _mm_add_ps(result, _mm_mul_ps(a3, _mm_set1_ps(b[column][3])));
+			_mm_storeu_ps(&m[column][0], result);
+		}
+		return m;
+#else
+		return a * b;
+#endif
+	}
+}
\ No newline at end of file
@@ -0,0 +1,587 @@
+#include "WorkStealingPool.h"
+
+#include <cstdio>
+#include <algorithm>
+#include <exception>
+
+// Number of unsuccessful task searches before worker goes to sleep
+static constexpr uint32_t c_spinCount = 64;
+// Maximum number of free task nodes kept by a thread, half of them is moved to the shared free list when exceeded
+static constexpr size_t c_nodeCacheSize = 64;
+// Free task nodes shared between threads, nodes beyond that are deleted
+static constexpr size_t c_freeNodeCapacity = 4096;
+// Tasks submitted from outside the pool that may wait for a worker at once
+static constexpr size_t c_injectionCapacity = 4096;
+
+/// <summary>
+/// Chase-Lev work-stealing deque of task nodes, following "Correct and Efficient Work-Stealing for Weak Memory Models"
+/// (Le et al., 2013). Owner pushes and pops at the bottom, other threads steal from the top.
+/// Buffer grows when full. Replaced buffers are kept until the deque is destroyed, since a thief may still read from them.
+/// </summary>
+class WorkStealingPool::TaskDeque
+{
+public:
+
+	TaskDeque(int64_t capacity = 256)
+	{
+		buffers.push_back(std::make_unique<Buffer>(capacity));
+		buffer.store(buffers.back().get(), std::memory_order_relaxed);
+	}
+
+	void push(TaskNode* node)
+	{
+		int64_t b = bottom.load(std::memory_order_relaxed);
+		int64_t t = top.load(std::memory_order_acquire);
+		Buffer* a = buffer.load(std::memory_order_relaxed);
+		if (b - t > a->capacity - 1)
+		{
+			a = grow(a, t, b);
+		}
+		a->put(b, node);
+		bottom.store(b + 1, std::memory_order_release);
+	}
+
+	TaskNode* pop()
+	{
+		int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		Buffer* a = buffer.load(std::memory_order_relaxed);
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t t = top.load(std::memory_order_relaxed);
+
+		TaskNode* node = nullptr;
+		if (t <= b)
+		{
+			node = a->get(b);
+			if (t == b)
+			{
+				// Last task, race against thieves for it
+				if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				{
+					node = nullptr;
+				}
+				bottom.store(b + 1, std::memory_order_relaxed);
+			}
+		}
+		else
+		{
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return node;
+	}
+
+	TaskNode* steal()
+	{
+		int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t b = bottom.load(std::memory_order_acquire);
+
+		if (t < b)
+		{
+			Buffer* a = buffer.load(std::memory_order_acquire);
+			TaskNode* node = a->get(t);
+			if (top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				return node;
+			}
+		}
+		return nullptr;
+	}
+
+private:
+
+	struct Buffer
+	{
+		Buffer(int64_t capacity) : capacity(capacity), items(new std::atomic<TaskNode*>[capacity]) {}
+
+		int64_t capacity;
+		std::unique_ptr<std::atomic<TaskNode*>[]> items;
+
+		TaskNode* get(int64_t index) const { return items[index & (capacity - 1)].load(std::memory_order_relaxed); }
+		void put(int64_t index, TaskNode* node) { items[index & (capacity - 1)].store(node, std::memory_order_relaxed); }
+	};
+
+	alignas(64) std::atomic<int64_t> top = 0;
+	alignas(64) std::atomic<int64_t> bottom = 0;
+	std::atomic<Buffer*> buffer;
+
+	// Only touched by the owner
+	std::vector<std::unique_ptr<Buffer>> buffers;
+
+	Buffer* grow(Buffer* old, int64_t t, int64_t b)
+	{
+		buffers.push_back(std::make_unique<Buffer>(old->capacity * 2));
+		Buffer* grown = buffers.back().get();
+		for (int64_t i = t; i < b; i++)
+		{
+			grown->put(i, old->get(i));
+		}
+		buffer.store(grown, std::memory_order_release);
+		return grown;
+	}
+};
+
+/// <summary>
+/// Bounded lock-free queue of task nodes with many producers and many consumers (Vyukov's bounded queue).
+/// Every cell carries a sequence number telling whether it is free or holds a node for the current lap.
+/// </summary>
+class WorkStealingPool::NodeRing
+{
+public:
+
+	// Capacity should be a power of two
+	NodeRing(size_t capacity) : cells(new Cell[capacity]), mask(capacity - 1)
+	{
+		for (size_t i = 0; i < capacity; i++)
+		{
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	// Returns false if the ring is full
+	bool push(TaskNode* node)
+	{
+		size_t position = enqueuePosition.load(std::memory_order_relaxed);
+		Cell* cell;
+		while (true)
+		{
+			cell = &cells[position & mask];
+			size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+			if (difference == 0)
+			{
+				if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (difference < 0)
+			{
+				return false;
+			}
+			else
+			{
+				position = enqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		cell->node = node;
+		cell->sequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Returns nullptr if the ring is empty
+	TaskNode* pop()
+	{
+		size_t position = dequeuePosition.load(std::memory_order_relaxed);
+		Cell* cell;
+		while (true)
+		{
+			cell = &cells[position & mask];
+			size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+			if (difference == 0)
+			{
+				if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (difference < 0)
+			{
+				return nullptr;
+			}
+			else
+			{
+				position = dequeuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		TaskNode* node = cell->node;
+		// Cell becomes available to producers on the next lap
+		cell->sequence.store(position + mask + 1, std::memory_order_release);
+		return node;
+	}
+
+private:
+
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		TaskNode* node;
+	};
+
+	std::unique_ptr<Cell[]> cells;
+	size_t mask;
+
+	alignas(64) std::atomic<size_t> enqueuePosition = 0;
+	alignas(64) std::atomic<size_t> dequeuePosition = 0;
+};
+
+/// <summary>
+/// Metrics counters of a thread. Worker counters have a single writer, while the external ones are shared by any helping threads.
+/// </summary>
+struct WorkStealingPool::Counters
+{
+	std::atomic<uint64_t> taskCount = 0;
+	std::atomic<uint64_t> stealCount = 0;
+	std::atomic<uint64_t> busyNs = 0;
+	std::atomic<uint64_t> waitTime[LatencyHistogram::c_bucketCount] = {};
+	std::atomic<uint64_t> runTime[LatencyHistogram::c_bucketCount] = {};
+
+	void record(uint64_t waitNs, uint64_t runNs, bool stolen)
+	{
+		taskCount.fetch_add(1, std::memory_order_relaxed);
+		if (stolen)
+		{
+			stealCount.fetch_add(1, std::memory_order_relaxed);
+		}
+		busyNs.fetch_add(runNs, std::memory_order_relaxed);
+		waitTime[LatencyHistogram::getBucket(waitNs)].fetch_add(1, std::memory_order_relaxed);
+		runTime[LatencyHistogram::getBucket(runNs)].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void read(WorkerMetrics& metrics) const
+	{
+		metrics.taskCount = taskCount.load(std::memory_order_relaxed);
+		metrics.stealCount = stealCount.load(std::memory_order_relaxed);
+		metrics.busyNs = busyNs.load(std::memory_order_relaxed);
+		for (size_t i = 0; i < LatencyHistogram::c_bucketCount; i++)
+		{
+			metrics.waitTime.buckets[i] = waitTime[i].load(std::memory_order_relaxed);
+			metrics.runTime.buckets[i] = runTime[i].load(std::memory_order_relaxed);
+		}
+	}
+};
+
+struct alignas(64) WorkStealingPool::Worker
+{
+	TaskDeque deque;
+	std::thread thread;
+	Counters counters;
+};
+
+// Pool and index of the worker running on the current thread
+static thread_local const WorkStealingPool* tl_pool = nullptr;
+static thread_local uint32_t tl_workerIndex = 0;
+
+WorkStealingPool::WorkStealingPool(uint32_t threadCount, std::function<void(uint32_t)> onThreadStart) :
+	onThreadStart(std::move(onThreadStart)),
+	externalCounters(std::make_unique<Counters>()),
+	injectionQueue(std::make_unique<NodeRing>(c_injectionCapacity))
+{
+	static_assert(sizeof(TaskNode) <= 64, "Task node is expected to fit into a cache line.");
+
+	threadCount = std::max(threadCount, 1u);
+	workers.reserve(threadCount);
+	for (uint32_t i = 0; i < threadCount; i++)
+	{
+		workers.push_back(std::make_unique<Worker>());
+	}
+	// Threads are started once all deques exist, since any worker may steal from any other
+	for (uint32_t i = 0; i < threadCount; i++)
+	{
+		workers[i]->thread = std::thread(&WorkStealingPool::workerLoop, this, i);
+	}
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stop = true;
+	}
+	sleepCondition.notify_all();
+
+	for (auto& worker : workers)
+	{
+		worker->thread.join();
+	}
+}
+
+uint32_t WorkStealingPool::getThreadCount() const
+{
+	return static_cast<uint32_t>(workers.size());
+}
+
+int32_t WorkStealingPool::getCurrentWorkerIndex() const
+{
+	return tl_pool == this ? static_cast<int32_t>(tl_workerIndex) : -1;
+}
+
+bool WorkStealingPool::tryRunPendingTask()
+{
+	if (pendingTaskCount.load(std::memory_order_relaxed) <= 0)
+	{
+		return false;
+	}
+
+	int32_t workerIndex = getCurrentWorkerIndex();
+	bool stolen = false;
+	TaskNode* node = findTask(workerIndex >= 0 ? workerIndex : 0, stolen);
+	if (node == nullptr)
+	{
+		return false;
+	}
+
+	runTask(node, stolen, workerIndex >= 0 ? workers[workerIndex]->counters : *externalCounters);
+	return true;
+}
+
+PoolMetrics WorkStealingPool::getMetrics() const
+{
+	PoolMetrics metrics;
+	metrics.workers.resize(workers.size());
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i]->counters.read(metrics.workers[i]);
+	}
+	externalCounters->read(metrics.external);
+	metrics.queueDepth = std::max<int64_t>(pendingTaskCount.load(std::memory_order_relaxed), 0);
+	metrics.sampleTime = Clock::now();
+	return metrics;
+}
+
+void WorkStealingPool::submitNode(TaskNode* node)
+{
+	int32_t workerIndex = getCurrentWorkerIndex();
+	if (workerIndex >= 0)
+	{
+		workers[workerIndex]->deque.push(node);
+	}
+	else
+	{
+		// Ring is full only while workers are behind by thousands of tasks. Submitter may be the main thread
+		// in the middle of a frame, so it neither waits for room nor runs pool tasks itself.
+		if (overflowActive.load(std::memory_order_acquire) || !injectionQueue->push(node))
+		{
+			pushToOverflow(node);
+		}
+	}
+
+	// Counter is raised after the task is visible, so a worker that saw it raised is guaranteed to find the task.
+	// Sleeping workers check the counter under sleepMutex, which makes notification below impossible to miss.
+	pendingTaskCount.fetch_add(1, std::memory_order_seq_cst);
+	if (sleepingWorkerCount.load(std::memory_order_seq_cst) > 0)
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		sleepCondition.notify_one();
+	}
+}
+
+void WorkStealingPool::pushToOverflow(TaskNode* node)
+{
+	std::lock_guard<std::mutex> lock(overflowMutex);
+	overflow.push_back(node);
+	overflowActive.store(true, std::memory_order_release);
+}
+
+WorkStealingPool::TaskNode* WorkStealingPool::popFromOverflow()
+{
+	if (!overflowActive.load(std::memory_order_acquire))
+	{
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> lock(overflowMutex);
+	if (overflowHead == overflow.size())
+	{
+		return nullptr;
+	}
+
+	TaskNode* node = overflow[overflowHead++];
+	if (overflowHead == overflow.size())
+	{
+		overflow.clear();
+		overflowHead = 0;
+		overflowActive.store(false, std::memory_order_release);
+	}
+	return node;
+}
+
+/// <summary>
+/// Takes a task from own deque first, then from the injection queue and its overflow and then steals from other workers.
+/// Thread not owned by the pool passes any index and only uses its deque for stealing.
+/// </summary>
+WorkStealingPool::TaskNode* WorkStealingPool::findTask(uint32_t workerIndex, bool& stolen)
+{
+	TaskNode* node = nullptr;
+	bool isOwner = tl_pool == this && tl_workerIndex == workerIndex;
+	if (isOwner)
+	{
+		node = workers[workerIndex]->deque.pop();
+	}
+
+	if (node == nullptr)
+	{
+		node = injectionQueue->pop();
+	}
+	if (node == nullptr)
+	{
+		node = popFromOverflow();
+	}
+
+	uint32_t workerCount = static_cast<uint32_t>(workers.size());
+	for (uint32_t i = isOwner ? 1 : 0; node == nullptr && i < workerCount; i++)
+	{
+		node = workers[(workerIndex + i) % workerCount]->deque.steal();
+		stolen = node != nullptr;
+	}
+
+	if (node != nullptr)
+	{
+		pendingTaskCount.fetch_sub(1, std::memory_order_relaxed);
+	}
+	return node;
+}
+
+void WorkStealingPool::runTask(TaskNode* node, bool stolen, Counters& counters)
+{
+	Clock::time_point startTime = Clock::now();
+	try
+	{
+		node->task();
+	}
+	catch (const std::exception& e)
+	{
+		printf("ERROR: Worker task failed. %s\n", e.what());
+	}
+
+	Clock::time_point endTime = Clock::now();
+	counters.record(std::chrono::duration_cast<std::chrono::nanoseconds>(startTime - node->submitTime).count(),
+		std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count(), stolen);
+
+	node->task.reset();
+	releaseNode(node);
+}
+
+void WorkStealingPool::workerLoop(uint32_t workerIndex)
+{
+	tl_pool = this;
+	tl_workerIndex = workerIndex;
+	if (onThreadStart)
+	{
+		onThreadStart(workerIndex);
+	}
+
+	uint32_t failedSearches = 0;
+	while (true)
+	{
+		bool stolen = false;
+		if (TaskNode* node = findTask(workerIndex, stolen))
+		{
+			runTask(node, stolen, workers[workerIndex]->counters);
+			failedSearches = 0;
+			continue;
+		}
+
+		if (stop.load(std::memory_order_acquire) && pendingTaskCount.load(std::memory_order_acquire) <= 0)
+		{
+			break;
+		}
+
+		if (++failedSearches < c_spinCount)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepingWorkerCount.fetch_add(1, std::memory_order_seq_cst);
+		sleepCondition.wait(lock, [this]() { return stop || pendingTaskCount.load(std::memory_order_seq_cst) > 0; });
+		sleepingWorkerCount.fetch_sub(1, std::memory_order_relaxed);
+		failedSearches = 0;
+	}
+}
+
+/// <summary>
+/// Free task nodes of a thread. Node goes to the cache of the thread that ran its task, which for worker threads
+/// is mostly the one that submits next. Threads outside the pool only submit, so their caches are refilled
+/// from the shared free list, which workers' caches spill into.
+/// </summary>
+struct WorkStealingPool::NodeCache
+{
+	std::vector<TaskNode*> nodes;
+
+	~NodeCache()
+	{
+		NodeRing& freeNodes = getFreeNodes();
+		for (TaskNode* node : nodes)
+		{
+			if (!freeNodes.push(node))
+			{
+				delete node;
+			}
+		}
+	}
+};
+
+/// <summary>
+/// Free list shared by all threads. Holds its nodes until the process exits.
+/// </summary>
+WorkStealingPool::NodeRing& WorkStealingPool::getFreeNodes()
+{
+	struct FreeNodes
+	{
+		NodeRing ring = NodeRing(c_freeNodeCapacity);
+
+		~FreeNodes()
+		{
+			while (TaskNode* node = ring.pop())
+			{
+				delete node;
+			}
+		}
+	};
+	static FreeNodes freeNodes;
+	return freeNodes.ring;
+}
+
+WorkStealingPool::NodeCache& WorkStealingPool::getNodeCache()
+{
+	static thread_local NodeCache cache;
+	return cache;
+}
+
+WorkStealingPool::TaskNode* WorkStealingPool::allocateNode()
+{
+	NodeCache& cache = getNodeCache();
+	if (cache.nodes.empty())
+	{
+		NodeRing& freeNodes = getFreeNodes();
+		while (cache.nodes.size() < c_nodeCacheSize / 2)
+		{
+			TaskNode* node = freeNodes.pop();
+			if (node == nullptr) break;
+			cache.nodes.push_back(node);
+		}
+		if (cache.nodes.empty())
+		{
+			return new TaskNode();
+		}
+	}
+
+	TaskNode* node = cache.nodes.back();
+	cache.nodes.pop_back();
+	return node;
+}
+
+void WorkStealingPool::releaseNode(TaskNode* node)
+{
+	NodeCache& cache = getNodeCache();
+	if (cache.nodes.size() >= c_nodeCacheSize)
+	{
+		// Surplus goes to the threads that submit more than they run, only nodes beyond the shared capacity are deleted
+		NodeRing& freeNodes = getFreeNodes();
+		while (cache.nodes.size() > c_nodeCacheSize / 2)
+		{
+			if (!freeNodes.push(cache.nodes.back()))
+			{
+				delete cache.nodes.back();
+			}
+			cache.nodes.pop_back();
+		}
+	}
+
+	cache.nodes.push_back(node);
+}
\ No newline at end of file
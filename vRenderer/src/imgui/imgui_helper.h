@@ -8,13 +8,17 @@
 #include <filesystem>
 #include <functional>
 #include <numeric>
+#include <algorithm>
 
 #include <glm/glm.hpp>
 
 #include "ModelInstance.h"
 #include "Lighting.h"
 #include "RenderSettings.h"
+#include "ImportSettings.h"
 #include "BaseCamera.h"
+#include "ThreadDispatcher.h"
+#include "SceneGenerator.h"
 
 using namespace VRD::Scene;
 
@@ -23,14 +27,21 @@ namespace imgui_helper
 	extern const char* apiLabels[];
 	extern const char* cameraTypeLabels[];
 	extern const char* lightTypeLabels[];
+	extern const char* sceneDistributionLabels[];
 	enum class LightTabAction { Add, Remove };
 
 	template<typename Enum>
 	void EnumButtonGroup(const char* labels[], int count, Enum& value, bool& changed);
 
 	void ShowRendererSettingsTab(RenderSettings& renderSettings);
+	// Returns true if any of the settings has changed
+	bool ShowImportSettingsTab(ImportSettings& importSettings);
 	void ShowCameraSettingsTab(CameraType& cameraType, int& fov, bool& typeChanged, bool& settingsChanged);
 	void ShowLightSettingsTab(const std::vector<std::shared_ptr<Light>>& lights, std::function<void(LightTabAction, uint32_t)> callback);
+	// Scene file path editor with save and load buttons, disabled while busy
+	void ShowSceneTab(char* scenePath, size_t pathSize, bool busy, bool& save, bool& load);
+	// Returns true if generation is requested. Models are picked from availableModels, none picked means all of them.
+	bool ShowSceneGeneratorSettings(SceneGenerator::Settings& settings, const std::vector<std::string>& availableModels, bool busy);
 
 	/// <summary>
 	/// Editor for a glm::vec3. Allows simultaneous edit of all components at once via sync flag.
@@ -39,10 +50,12 @@ namespace imgui_helper
 		float speed = 0.1f, float min = -100.0f, float max = 100.0f);
 
 	/// <summary>
-	/// Transform editor for a SceneGraphInstance
+	/// Transform editor for a scene instance
 	/// </summary>
-	bool ShowTransformEditor(SceneGraphInstance& sceneInstance);
+	bool ShowTransformEditor(glm::vec3& position, glm::vec3& rotation, glm::vec3& scale);
 
 	// Draws current framerate based on IMGUI data
 	void DrawFPSOverlay(const char* info = "");
+	// Draws worker pool utilization, task latencies and main thread queue state below the FPS overlay
+	void DrawThreadingOverlay(const ThreadingMetrics& metrics);
 }
\ No newline at end of file
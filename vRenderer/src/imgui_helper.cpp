@@ -5,6 +5,7 @@ namespace imgui_helper
 	const char* apiLabels[] = { "Vulkan", "OpenGL" };
 	const char* cameraTypeLabels[] = { "Orbit", "FPV" };
 	const char* lightTypeLabels[] = { "Directional", "Point", "Spot" };
+	const char* sceneDistributionLabels[] = { "Grid", "Random", "Clustered" };
 
 	template<typename Enum>
 	void EnumButtonGroup(const char* labels[], int count, Enum& value, bool& changed)
@@ -39,7 +40,55 @@ namespace imgui_helper
 		ImGui::Checkbox("FPS limit", &renderSettings.fpsLimit);
 		ImGui::SliderInt("FPS target", &renderSettings.targetFps, 1, 165);
 		ImGui::Checkbox("Object outline", &renderSettings.enableOutline);
+		ImGui::Checkbox("Frustum culling", &renderSettings.enableFrustumCulling);
+		ImGui::BeginDisabled(!renderSettings.enableFrustumCulling);
+		ImGui::Checkbox("Occlusion culling", &renderSettings.enableOcclusionCulling);
+		ImGui::EndDisabled();
 		ImGui::DragFloat("Gamma Correction factor", &renderSettings.gammaCorrectionFactor, 0.1f, 5.0f);
+		ImGui::SliderFloat("Main thread task budget (ms)", &renderSettings.mainThreadBudgetMs, 0.0f, 33.0f, "%.1f");
+		ImGui::Checkbox("Threading metrics overlay", &renderSettings.showThreadingMetrics);
+	}
+
+	bool ShowImportSettingsTab(ImportSettings& importSettings)
+	{
+		// 0 stands for no limit
+		static const uint32_t sizes[] = { 0, 256, 512, 1024, 2048, 4096, 8192 };
+		static const char* sizeLabels[] = { "Unlimited", "256", "512", "1024", "2048", "4096", "8192" };
+		const int sizeCount = IM_ARRAYSIZE(sizes);
+
+		auto sizeCombo = [&](const char* label, uint32_t& size) {
+			int current = static_cast<int>(std::find(sizes, sizes + sizeCount, size) - sizes);
+			// Value set outside of UI (e.g. in prefs file) that is not on the list
+			const char* preview = current < sizeCount ? sizeLabels[current] : "Custom";
+
+			bool changed = false;
+			if (ImGui::BeginCombo(label, preview))
+			{
+				for (int i = 0; i < sizeCount; i++)
+				{
+					if (ImGui::Selectable(sizeLabels[i], i == current))
+					{
+						changed = size != sizes[i];
+						size = sizes[i];
+					}
+				}
+				ImGui::EndCombo();
+			}
+			return changed;
+			};
+
+		ImGui::Text("Max texture resolution");
+		ImGui::TextDisabled("Applies to textures imported from now on");
+		bool changed = false;
+		changed |= sizeCombo("Diffuse", importSettings.maxDiffuseSize);
+		changed |= sizeCombo("Specular", importSettings.maxSpecularSize);
+		changed |= sizeCombo("Ambient", importSettings.maxAmbientSize);
+		changed |= sizeCombo("Opacity", importSettings.maxOpacitySize);
+		changed |= sizeCombo("Emission", importSettings.maxEmissionSize);
+		changed |= sizeCombo("Normal", importSettings.maxNormalSize);
+		changed |= sizeCombo("Cubemap face", importSettings.maxCubemapFaceSize);
+		changed |= sizeCombo("Other", importSettings.maxOtherSize);
+		return changed;
 	}
 
 	void ShowCameraSettingsTab(CameraType& cameraType, int& fov, bool& typeChanged, bool& settingsChanged)
@@ -86,6 +135,73 @@ namespace imgui_helper
 		}
 	}
 
+	void ShowSceneTab(char* scenePath, size_t pathSize, bool busy, bool& save, bool& load)
+	{
+		ImGui::InputText("Path", scenePath, pathSize);
+		ImGui::BeginDisabled(busy);
+		save = ImGui::Button("Save");
+		ImGui::SameLine();
+		load = ImGui::Button("Load");
+		ImGui::EndDisabled();
+		if (busy)
+		{
+			ImGui::SameLine();
+			ImGui::TextDisabled("Scene is being saved or loaded...");
+		}
+	}
+
+	bool ShowSceneGeneratorSettings(SceneGenerator::Settings& settings, const std::vector<std::string>& availableModels, bool busy)
+	{
+		bool changed = false;
+		EnumButtonGroup(sceneDistributionLabels, 3, settings.distribution, changed);
+
+		int instanceCount = static_cast<int>(settings.instanceCount);
+		if (ImGui::DragInt("Instances", &instanceCount, 100.0f, 0, SceneGenerator::c_maxInstanceCount))
+		{
+			settings.instanceCount = static_cast<uint32_t>(std::max(instanceCount, 0));
+		}
+		int lightCount = static_cast<int>(settings.lightCount);
+		if (ImGui::SliderInt("Lights", &lightCount, 0, 10))
+		{
+			settings.lightCount = static_cast<uint32_t>(lightCount);
+		}
+		ImGui::DragFloat("Extent", &settings.extent, 1.0f, 1.0f, 1000.0f);
+		if (settings.distribution == SceneGenerator::Distribution::CLUSTERED)
+		{
+			int clusterCount = static_cast<int>(settings.clusterCount);
+			if (ImGui::SliderInt("Clusters", &clusterCount, 1, 256))
+			{
+				settings.clusterCount = static_cast<uint32_t>(clusterCount);
+			}
+			ImGui::DragFloat("Cluster radius", &settings.clusterRadius, 0.1f, 0.1f, 100.0f);
+		}
+		ImGui::Checkbox("Randomize rotation and scale", &settings.randomizeTransforms);
+		int seed = static_cast<int>(settings.seed);
+		if (ImGui::InputInt("Seed", &seed))
+		{
+			settings.seed = static_cast<uint32_t>(seed);
+		}
+
+		ImGui::Text("Models:");
+		ImGui::BeginChild("GeneratorModels", ImVec2(0, 100), true);
+		for (const std::string& model : availableModels)
+		{
+			auto it = std::find(settings.modelNames.begin(), settings.modelNames.end(), model);
+			bool picked = it != settings.modelNames.end();
+			if (ImGui::Checkbox(model.c_str(), &picked))
+			{
+				if (picked) settings.modelNames.push_back(model);
+				else settings.modelNames.erase(it);
+			}
+		}
+		ImGui::EndChild();
+
+		ImGui::BeginDisabled(busy);
+		bool generate = ImGui::Button("Generate");
+		ImGui::EndDisabled();
+		return generate;
+	}
+
 	/// <summary>
 	/// Editor for a glm::vec3. Allows simultaneous edit of all components at once via sync flag.
 	/// </summary>
@@ -138,7 +254,7 @@ namespace imgui_helper
 	/// <summary>
 	/// Editor for tranform values of a mesh/model
 	/// </summary>
-	bool ShowTransformEditor(SceneGraphInstance& sceneInstance)
+	bool ShowTransformEditor(glm::vec3& position, glm::vec3& rotation, glm::vec3& scale)
 	{
 		bool changed = false;
 		static bool syncPosition = false;
@@ -146,13 +262,13 @@ namespace imgui_helper
 		static bool syncScale = false;
 
 		// Position (with wider range and default speed)
-		changed |= ShowAdvancedVec3Editor("Position", sceneInstance.position, syncPosition, 0.01f, -100.0f, 100.0f);
+		changed |= ShowAdvancedVec3Editor("Position", position, syncPosition, 0.01f, -100.0f, 100.0f);
 		ImGui::Spacing();
 		// Rotation (constrained to 0-360 range, faster speed)
-		changed |= ShowAdvancedVec3Editor("Rotation", sceneInstance.rotation, syncRotation, 0.01f, -360.0f, 360.0f);
+		changed |= ShowAdvancedVec3Editor("Rotation", rotation, syncRotation, 0.01f, -360.0f, 360.0f);
 		ImGui::Spacing();
 		// Scale (positive values only, slower speed)
-		changed |= ShowAdvancedVec3Editor("Scale", sceneInstance.scale, syncScale, 0.01f, 0, 20.0f);
+		changed |= ShowAdvancedVec3Editor("Scale", scale, syncScale, 0.01f, 0, 20.0f);
 
 		return changed;
 	}
@@ -184,4 +300,55 @@ namespace imgui_helper
 		}
 		ImGui::End();
 	}
+
+	static void DrawPoolMetrics(const char* name, const PoolMetrics& pool, const ThreadingMetrics& metrics)
+	{
+		WorkerMetrics total = pool.getTotal();
+		float tasksPerSecond = metrics.windowMs > 0.0f ? total.taskCount * 1000.0f / metrics.windowMs : 0.0f;
+
+		ImGui::Text("%s: %zu threads, queue %lld, %.0f tasks/s, %llu stolen", name, pool.workers.size(),
+			static_cast<long long>(pool.queueDepth), tasksPerSecond, static_cast<unsigned long long>(total.stealCount));
+		ImGui::Text("  wait p50 %.3f p95 %.3f ms, run p50 %.3f p95 %.3f ms",
+			total.waitTime.getPercentileMs(0.5f), total.waitTime.getPercentileMs(0.95f),
+			total.runTime.getPercentileMs(0.5f), total.runTime.getPercentileMs(0.95f));
+
+		for (size_t i = 0; i < pool.workers.size(); i++)
+		{
+			float utilization = std::min(metrics.getUtilization(pool.workers[i]), 1.0f);
+			char label[32];
+			snprintf(label, sizeof(label), "%zu: %.0f%%", i, utilization * 100.0f);
+			ImGui::ProgressBar(utilization, ImVec2(160.0f, 0.0f), label);
+			if (i % 4 != 3 && i + 1 < pool.workers.size()) ImGui::SameLine();
+		}
+	}
+
+	void DrawThreadingOverlay(const ThreadingMetrics& metrics)
+	{
+		// Placed under the FPS overlay
+		const float DISTANCE = 10.0f;
+		ImGui::SetNextWindowPos(ImVec2(DISTANCE, 60.0f), ImGuiCond_Always);
+		ImGui::SetNextWindowBgAlpha(0.35f);
+
+		ImGuiWindowFlags flags =
+			ImGuiWindowFlags_NoDecoration |
+			ImGuiWindowFlags_AlwaysAutoResize |
+			ImGuiWindowFlags_NoSavedSettings |
+			ImGuiWindowFlags_NoFocusOnAppearing |
+			ImGuiWindowFlags_NoNav |
+			ImGuiWindowFlags_NoMove;
+
+		if (ImGui::Begin("Threading Overlay", nullptr, flags)) {
+			DrawPoolMetrics("CPU", metrics.cpu, metrics);
+			DrawPoolMetrics("I/O", metrics.io, metrics);
+
+			static const char* priorityLabels[] = { "High", "Normal", "Low" };
+			for (size_t i = 0; i < static_cast<size_t>(DispatchPriority::COUNT); i++)
+			{
+				const MpscTaskQueue::Stats& stats = metrics.main[i];
+				ImGui::Text("Main %s: pending %zu, latency avg %.2f max %.2f ms, starved %llu", priorityLabels[i],
+					stats.pendingCount, stats.averageAgeMs, stats.maxAgeMs, static_cast<unsigned long long>(stats.starvedCallCount));
+			}
+		}
+		ImGui::End();
+	}
 }
\ No newline at end of file
@@ -1,8 +1,23 @@
 
 #include "Application.h"
+#include "AssetBundleBuilder.h"
+#include "ImageDecoderBenchmark.h"
 
-int main()
+int main(int argc, char* argv[])
 {
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--build-bundle")
+		{
+			return AssetBundleBuilder::runFromCommandLine(argc, argv);
+		}
+		if (arg == "--bench-decoders")
+		{
+			return ImageDecoderBenchmark::runFromCommandLine(argc, argv);
+		}
+	}
+
 	Application application;
-	return application.run();
+	return application.run(argc, argv);
 }
\ No newline at end of file
@@ -1,8 +1,17 @@
 #include "GLModel.h"
 
-GLModel::GLModel(uint32_t id, const Model& model) : id(id)
+GLModel::GLModel(uint32_t id, const Model& model) : id(id), transform(1.0f), normalMatrix(1.0f)
 {
+	bounds = model.getBoundingSphere();
+	for (const auto& mesh : model.getMeshes())
+	{
+		meshBounds.push_back(mesh->getBoundingSphere());
+		sourceMeshes.push_back(mesh);
+	}
+	worldMeshBounds.resize(meshBounds.size());
+
 	createFromGenericModel(model);
+	setTransform(transform, normalMatrix);
 }
 
 GLModel::~GLModel()
@@ -10,13 +19,33 @@ GLModel::~GLModel()
 	cleanup();
 }
 
-void GLModel::setTransform(glm::mat4 transform)
+void GLModel::setTransform(const glm::mat4& transform, const glm::mat4& normalMatrix)
 {
 	this->transform = transform;
+	this->normalMatrix = normalMatrix;
 	for (auto* mesh : meshes)
 	{
 		mesh->setTransformMat(transform);
 	}
+
+	worldBounds = bounds.transform(transform).pack();
+	for (size_t i = 0; i < meshBounds.size(); i++)
+	{
+		worldMeshBounds[i] = meshBounds[i].transform(transform).pack();
+	}
+}
+
+const glm::vec4& GLModel::getWorldBounds() const
+{
+	return worldBounds;
+}
+
+void GLModel::addOccluders(OcclusionCuller& culler) const
+{
+	for (size_t i = 0; i < sourceMeshes.size(); i++)
+	{
+		culler.addOccluder(*sourceMeshes[i], transform, worldMeshBounds[i]);
+	}
 }
 
 const glm::mat4 GLModel::getTransform() const
@@ -24,17 +53,21 @@ const glm::mat4 GLModel::getTransform() const
 	return transform;
 }
 
-void GLModel::draw(GLShader& shader, BaseCamera& camera)
+void GLModel::draw(GLShader& shader, BaseCamera& camera, const Frustum* frustum)
 {
-	// Calculate Normal matrix (required for proper normals transformation)
-	glm::mat3 normalMat = glm::transpose(glm::inverse(camera.getViewMatrix() * this->transform));
+	// Normals are lit in view space. View matrix is rigid, so its rotation part is its own inverse transpose
+	glm::mat3 normalMat = glm::mat3(camera.getViewMatrix()) * glm::mat3(this->normalMatrix);
 
 	// Setting uniforms
 	shader.setUniform(MODEL_UNIFORM_NAME, this->transform);
 	shader.setUniform(NORMAL_MATRIX_UNIFORM_NAME, normalMat);
 	
+	// Single mesh models were already tested as a whole
+	bool cullMeshes = frustum != nullptr && meshes.size() > 1;
 	for (int i = 0; i < meshes.size(); i++)
 	{
+		if (cullMeshes && !frustum->intersects(worldMeshBounds[i])) continue;
+
 		if (materials[i] != nullptr)
 		{
 			materials[i]->apply(shader);
@@ -65,9 +65,10 @@ void OpenGLRenderer::drawOutline()
 	outlineShader->enable();
 	outlineShader->setUniform("view", this->camera->getViewMatrix());
 	outlineShader->setUniform("projection", this->camera->getProjectionMatrix());
-	for (int i = 0; i < modelsToRender.size(); i++)
+	const Frustum* frustum = renderSettings->enableFrustumCulling ? &viewFrustum : nullptr;
+	for (uint32_t i : visibleModels)
 	{
-		modelsToRender[i]->draw(*outlineShader, *camera);
+		modelsToRender[i]->draw(*outlineShader, *camera, frustum);
 	}
 
 	glStencilMask(0xFF);
@@ -80,6 +81,44 @@ bool OpenGLRenderer::setSkybox(const std::shared_ptr<Cubemap> cubemap)
 	return false;
 }
 
+/// <summary>
+/// Fills visibleModels with indices of models to draw this frame, all shown ones if culling is disabled.
+/// </summary>
+void OpenGLRenderer::cullModels()
+{
+	if (!renderSettings->enableFrustumCulling)
+	{
+		visibleModels.clear();
+		for (uint32_t i = 0; i < modelsToRender.size(); i++)
+		{
+			if (modelsToRender[i]->isVisible()) visibleModels.push_back(i);
+		}
+		return;
+	}
+
+	modelBounds.resize(modelsToRender.size());
+	for (size_t i = 0; i < modelsToRender.size(); i++)
+	{
+		modelBounds[i] = modelsToRender[i]->getWorldBounds();
+	}
+	viewFrustum = camera->getFrustum();
+	FrustumCuller::cull(modelBounds.data(), modelBounds.size(), viewFrustum, visibleModels);
+	// Hidden models are neither drawn nor used as occluders
+	std::erase_if(visibleModels, [this](uint32_t i) { return !modelsToRender[i]->isVisible(); });
+
+	if (renderSettings->enableOcclusionCulling)
+	{
+		// Visible models are both the occluders and the ones tested against them
+		occlusionCuller.begin(camera->getProjectionMatrix() * camera->getViewMatrix());
+		for (uint32_t i : visibleModels)
+		{
+			modelsToRender[i]->addOccluders(occlusionCuller);
+		}
+		occlusionCuller.rasterize();
+		occlusionCuller.cull(modelBounds.data(), visibleModels);
+	}
+}
+
 void OpenGLRenderer::draw()
 {
 	// IMGUI rendering
@@ -106,9 +145,11 @@ void OpenGLRenderer::draw()
 	shader->setUniform("projection", this->camera->getProjectionMatrix());
 	applyLighting();
 
-	for (auto* model : modelsToRender)
+	cullModels();
+	const Frustum* frustum = renderSettings->enableFrustumCulling ? &viewFrustum : nullptr;
+	for (uint32_t i : visibleModels)
 	{
-		model->draw(*shader, *camera);
+		modelsToRender[i]->draw(*shader, *camera, frustum);
 	}
 
 	if (renderSettings->enableOutline)
@@ -123,60 +164,94 @@ bool OpenGLRenderer::addToRenderer(const Model& model, glm::vec3 color)
 	return false;
 }
 
-bool OpenGLRenderer::addToRendererTextured(const ModelInstance& model)
+size_t OpenGLRenderer::addModelsToRenderer(std::span<const ModelInstance> models)
 {
-	//// If mesh is not in renderer
-	//if (!isModelInRenderer(model.id))
+	size_t addedCount = 0;
+	//modelsToRender.reserve(modelsToRender.size() + models.size());
+	//for (const ModelInstance& model : models)
 	//{
+	//	// If mesh is not in renderer
+	//	if (isModelInRenderer(model.handle)) continue;
+	//
 	//	GLModel* glModel = new GLModel(model.id, *model.modelTemplate);
-	//	modelsToRender.push_back(glModel);
-	//	return true;
+	//	if (auto displaced = modelsToRender.insert(model.handle, glModel))
+	//	{
+	//		delete *displaced;
+	//	}
+	//	addedCount++;
 	//}
 
-	return false;
+	return addedCount;
 }
 
-bool OpenGLRenderer::removeFromRenderer(int modelId)
+size_t OpenGLRenderer::removeModelsFromRenderer(std::span<const InstanceHandle> handles)
 {
-	auto it = std::find_if(modelsToRender.begin(), modelsToRender.end(),
-		[modelId](GLModel* model) {return model->id == modelId;});
-	if (it != modelsToRender.end())
+	size_t removedCount = 0;
+	for (InstanceHandle handle : handles)
 	{
-		GLModel* model = *it;
-		delete model;
-		model = nullptr;
-		modelsToRender.erase(it);
-		return true;
+		if (auto removed = modelsToRender.erase(handle))
+		{
+			delete *removed;
+			removedCount++;
+		}
 	}
 
-	return false;
+	return removedCount;
+}
+
+bool OpenGLRenderer::isModelInRenderer(InstanceHandle handle)
+{
+	return modelsToRender.contains(handle);
 }
 
-bool OpenGLRenderer::isModelInRenderer(uint32_t id)
+/// <summary>
+/// Every group of the journal is applied as one batch, every entry is a constant time handle table operation.
+/// </summary>
+void OpenGLRenderer::applySceneChanges(const SceneChangeJournal& changes)
 {
-	auto it = std::find_if(modelsToRender.begin(), modelsToRender.end(),
-		[id](GLModel* model) {return model->id == id;});
-	return it != modelsToRender.end();;
+	addModelsToRenderer(changes.created);
+	updateModelTransforms(changes.transformed, changes.worldMatrices, changes.normalMatrices);
+
+	for (size_t i = 0; i < changes.visibilityChanged.size(); i++)
+	{
+		GLModel* model = getModel(changes.visibilityChanged[i]);
+		if (model != nullptr)
+		{
+			model->setVisible(changes.visible[i]);
+		}
+	}
+
+	removeModelsFromRenderer(changes.destroyed);
 }
 
-GLModel* OpenGLRenderer::getModel(uint32_t id)
+GLModel* OpenGLRenderer::getModel(InstanceHandle handle)
 {
-	auto it = std::find_if(modelsToRender.begin(), modelsToRender.end(),
-		[id](GLModel* model) {return model->id == id;});
-	return it != modelsToRender.end() ? *it : nullptr;
+	GLModel** model = modelsToRender.find(handle);
+	return model != nullptr ? *model : nullptr;
 }
 
 
 
-bool OpenGLRenderer::updateModelTransform(int modelId, glm::mat4 newTransform)
+size_t OpenGLRenderer::updateModelTransforms(std::span<const InstanceHandle> handles,
+	std::span<const glm::mat4> transforms, std::span<const glm::mat4> normalMatrices)
 {
-	GLModel* model = getModel(modelId);
-	if (model != nullptr)
+	if (transforms.size() != handles.size() || normalMatrices.size() != handles.size())
 	{
-		model->setTransform(newTransform);
+		throw std::runtime_error("Model transforms don't match model handles.");
 	}
 
-	return model != nullptr;
+	size_t updatedCount = 0;
+	for (size_t i = 0; i < handles.size(); i++)
+	{
+		GLModel* model = getModel(handles[i]);
+		if (model != nullptr)
+		{
+			model->setTransform(transforms[i], normalMatrices[i]);
+			updatedCount++;
+		}
+	}
+
+	return updatedCount;
 }
 
 void OpenGLRenderer::setCamera(const std::shared_ptr<BaseCamera> camera)
@@ -199,7 +274,13 @@ bool OpenGLRenderer::addLightSources(const std::shared_ptr<Light> lights[], uint
 
 bool OpenGLRenderer::removeLightSources(uint32_t* ids, uint32_t count)
 {
-	// no implementation
+	for (int i = 0; i < count; ++i)
+	{
+		uint32_t& id = *(ids + i);
+		auto it = std::find_if(lightSources.begin(), lightSources.end(), [&id](std::shared_ptr<Light> light) {return id == light->id;});
+		if (it == lightSources.end()) return false;
+		lightSources.erase(it);
+	}
 	return true;
 }
 
@@ -210,6 +291,7 @@ void OpenGLRenderer::cleanup()
 		delete model;
 		model = nullptr;
 	}
+	modelsToRender.clear();
 }
 
 void OpenGLRenderer::setImguiCallback(std::function<void()> callback)
@@ -250,4 +332,10 @@ void OpenGLRenderer::applyLighting()
 			shader->setUniform((uniformBase + "outerCutOff").c_str(), glm::cos(glm::radians(light.outerCutOff)));
 		}
 	}
+
+	// Slots of removed light sources are reset same as in Vulkan renderer
+	for (int i = lightSources.size(); i < MAX_LIGHT_SOURCES; i++)
+	{
+		shader->setUniform(("lightSources[" + std::to_string(i) + "].type").c_str(), 0);
+	}
 }
@@ -0,0 +1,46 @@
+#include "VkAssetCache.h"
+
+VkAssetCache::VkAssetCache(VkContext context)
+{
+	this->context = context;
+}
+
+/// <summary>
+/// Returns GPU texture for provided generic texture. If a texture with identical content
+/// is already uploaded it is shared instead of being created again.
+/// </summary>
+std::shared_ptr<VkTexture> VkAssetCache::getTexture(const Texture& texture)
+{
+	auto it = textures.find(texture.contentHash);
+	if (it != textures.end())
+	{
+		if (auto vkTexture = it->second.lock())
+		{
+			return vkTexture;
+		}
+	}
+
+	auto vkTexture = std::make_shared<VkTexture>(texture, context);
+	textures[texture.contentHash] = vkTexture;
+	return vkTexture;
+}
+
+/// <summary>
+/// Returns GPU mesh for provided generic mesh. If a mesh with identical geometry
+/// is already uploaded it is shared instead of being created again.
+/// </summary>
+std::shared_ptr<VkMesh> VkAssetCache::getMesh(const Mesh& mesh)
+{
+	auto it = meshes.find(mesh.getContentHash());
+	if (it != meshes.end())
+	{
+		if (auto vkMesh = it->second.lock())
+		{
+			return vkMesh;
+		}
+	}
+
+	auto vkMesh = std::make_shared<VkMesh>(mesh.id, mesh, context);
+	meshes[mesh.getContentHash()] = vkMesh;
+	return vkMesh;
+}
\ No newline at end of file
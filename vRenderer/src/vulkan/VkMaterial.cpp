@@ -1,4 +1,5 @@
 #include "VkMaterial.h"
+#include "VkAssetCache.h"
 
 VkMaterial::VkMaterial(const Material& material, VkContext context, VkSamplerDescriptorSetCreateInfo createInfo)
 {
@@ -75,11 +76,12 @@ void VkMaterial::createFromGenericMaterial(const Material& material, VkSamplerDe
 			context);
 
 		// Lambda for texture creation
-		VkContext& ctx = this->context;
-		auto createTexture = [&](const std::shared_ptr<Texture>& texture, std::unique_ptr<VkTexture>& vkTexture) {
+		// Identical images are uploaded once and shared between materials
+		auto& assetCache = VkAssetCache::instance();
+		auto createTexture = [&](const std::shared_ptr<Texture>& texture, std::shared_ptr<VkTexture>& vkTexture) {
 			if (texture != nullptr)
 			{
-				vkTexture = std::make_unique<VkTexture>(*texture, ctx);
+				vkTexture = assetCache.getTexture(*texture);
 			}
 		};
 
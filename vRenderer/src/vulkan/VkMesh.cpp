@@ -32,16 +32,6 @@ VkBuffer VkMesh::getIndexBuffer()
 	return indexBuffer;
 }
 
-glm::mat4 VkMesh::getTransformMat()
-{
-	return transformMat;
-}
-
-void VkMesh::setTransformMat(glm::mat4 transform)
-{
-	transformMat = transform;
-}
-
 void VkMesh::createFromGenericMesh(const Mesh& mesh)
 {
 	std::vector<Vertex> vertices;
@@ -61,8 +51,6 @@ void VkMesh::createFromGenericMesh(const Mesh& mesh)
 	indexCount = meshIndices.size();
 	vertexCount = vertices.size();
 
-	setTransformMat(glm::identity<glm::mat4>());
-
 	createVertexBuffer(vertices, context);
 	createIndexBuffer(meshIndices, context);
 }
@@ -1,15 +1,48 @@
 #include "VkModel.h"
+#include "VkAssetCache.h"
 
 VkModel::VkModel(uint32_t id, const Model& model, VkContext context, VkSamplerDescriptorSetCreateInfo createInfo) :
 	id(id)
 {
 	this->context = context;
+	this->transform = glm::identity<glm::mat4>();
+	this->normalMatrix = glm::identity<glm::mat4>();
 
 	meshCount = model.getMeshCount();
 	meshes.resize(meshCount);
 	materials.resize(meshCount);
 
+	bounds = model.getBoundingSphere();
+	meshBounds.reserve(meshCount);
+	for (const auto& mesh : model.getMeshes())
+	{
+		meshBounds.push_back(mesh->getBoundingSphere());
+		sourceMeshes.push_back(mesh);
+	}
+	worldMeshBounds.resize(meshCount);
+
 	createFromGenericModel(model, createInfo);
+	setTransform(transform, normalMatrix);
+}
+
+VkModel::VkModel(uint32_t id, const VkModel& prototype) :
+	id(id)
+{
+	context = prototype.context;
+	transform = glm::identity<glm::mat4>();
+	normalMatrix = glm::identity<glm::mat4>();
+
+	meshCount = prototype.meshCount;
+	materialCount = prototype.materialCount;
+	meshes = prototype.meshes;
+	materials = prototype.materials;
+
+	bounds = prototype.bounds;
+	meshBounds = prototype.meshBounds;
+	sourceMeshes = prototype.sourceMeshes;
+	worldMeshBounds.resize(meshCount);
+
+	setTransform(transform, normalMatrix);
 }
 
 VkModel::~VkModel()
@@ -27,21 +60,19 @@ int VkModel::getMaterialCount() const
 	return materialCount;
 }
 
-const VkMesh* VkModel::getMesh(uint32_t id) const
-{
-	auto it = std::find_if(meshes.begin(), meshes.end(), [id](VkMesh* mesh) {return mesh->id == id;});
-	return *it;
-}
-
-const std::vector<VkMesh*>& VkModel::getMeshes() const
+const std::vector<std::shared_ptr<VkMesh>>& VkModel::getMeshes() const
 {
 	return meshes;
 }
 
-void VkModel::draw(uint32_t imageIndex, VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, bool bindMaterials)
+void VkModel::draw(uint32_t imageIndex, VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, bool bindMaterials, const Frustum* frustum)
 {
+	// Single mesh models were already tested as a whole
+	bool cullMeshes = frustum != nullptr && meshCount > 1;
 	for (int i = 0; i < meshCount; i++)
 	{
+		if (cullMeshes && !frustum->intersects(worldMeshBounds[i])) continue;
+
 		auto& mesh = meshes[i];
 
 		VkBuffer vertexBuffers[] = { mesh->getVertexBuffer() };															// buffers to bind
@@ -53,15 +84,15 @@ void VkModel::draw(uint32_t imageIndex, VkCommandBuffer commandBuffer, VkPipelin
 		// PUSH CONSTANTS
 		{
 			PushConstant push = {};
-			push.model = mesh->getTransformMat();
-			push.normalMatrix = glm::transpose(glm::inverse(mesh->getTransformMat()));
+			push.model = transform;
+			push.normalMatrix = normalMatrix;
 			vkCmdPushConstants(commandBuffer, pipelineLayout,
 				VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstant), &push);
 		}
 
 		if (bindMaterials)
 		{
-			auto* material = materials[i];
+			auto& material = materials[i];
 			// Material sampler uniforms
 			material->cmdBind(imageIndex, commandBuffer, pipelineLayout);
 		}
@@ -71,11 +102,28 @@ void VkModel::draw(uint32_t imageIndex, VkCommandBuffer commandBuffer, VkPipelin
 	}
 }
 
-void VkModel::setTransform(glm::mat4 transform)
+void VkModel::setTransform(const glm::mat4& transform, const glm::mat4& normalMatrix)
 {
-	for (auto* mesh : meshes)
+	this->transform = transform;
+	this->normalMatrix = normalMatrix;
+
+	worldBounds = bounds.transform(transform).pack();
+	for (int i = 0; i < meshCount; i++)
 	{
-		mesh->setTransformMat(transform);
+		worldMeshBounds[i] = meshBounds[i].transform(transform).pack();
+	}
+}
+
+const glm::vec4& VkModel::getWorldBounds() const
+{
+	return worldBounds;
+}
+
+void VkModel::addOccluders(OcclusionCuller& culler) const
+{
+	for (int i = 0; i < meshCount; i++)
+	{
+		culler.addOccluder(*sourceMeshes[i], transform, worldMeshBounds[i]);
 	}
 }
 
@@ -85,15 +133,15 @@ void VkModel::createFromGenericModel(const Model& model, VkSamplerDescriptorSetC
 	{
 		const Mesh& mesh = *model.getMeshes()[i];
 		
-		uint32_t newMeshId = i;
-		VkMesh* vkMesh = new VkMesh(newMeshId, mesh, context);
-		
+		// Identical geometry is uploaded once and shared between models
+		std::shared_ptr<VkMesh> vkMesh = VkAssetCache::instance().getMesh(mesh);
+
 		const auto& material = model.getMaterials()[i];
-		VkMaterial* vkMaterial = nullptr;
+		std::shared_ptr<VkMaterial> vkMaterial = nullptr;
 		if (material != nullptr)
 		{
 			materialCount++;
-			vkMaterial = new VkMaterial(*material, context, createInfo);
+			vkMaterial = std::make_shared<VkMaterial>(*material, context, createInfo);
 		}
 
 		meshes[i] = vkMesh;
@@ -103,14 +151,6 @@ void VkModel::createFromGenericModel(const Model& model, VkSamplerDescriptorSetC
 
 void VkModel::cleanup()
 {
-	for (auto& texture : materials)
-	{
-		delete texture;
-		texture = nullptr;
-	}
-	for (auto& mesh : meshes)
-	{
-		delete mesh;
-		mesh = nullptr;
-	}
+	materials.clear();
+	meshes.clear();
 }
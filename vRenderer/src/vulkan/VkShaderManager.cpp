@@ -47,8 +47,12 @@ std::array<VkPipelineShaderStageCreateInfo, 2> VkShaderManager::getShaderStage(R
     }
 
     // build shader modules to link to graphics pipeline
-    VkShaderModule vertexShaderModule = VkUtils::createShaderModule(VkUtils::readFile(shaderModule->vertSpvPath.string()), context);
-    VkShaderModule fragmentShaderModule = VkUtils::createShaderModule(VkUtils::readFile(shaderModule->fragSpvPath.string()), context);
+    // both stages are read at once
+    auto reads = AsyncFileReader::instance().readBatch({ shaderModule->vertSpvPath, shaderModule->fragSpvPath });
+    FileData vertexCode = reads[0].get();
+    FileData fragmentCode = reads[1].get();
+    VkShaderModule vertexShaderModule = VkUtils::createShaderModule(std::vector<char>(vertexCode.begin(), vertexCode.end()), context);
+    VkShaderModule fragmentShaderModule = VkUtils::createShaderModule(std::vector<char>(fragmentCode.begin(), fragmentCode.end()), context);
     vkShaderModules.push_back(vertexShaderModule);
     vkShaderModules.push_back(fragmentShaderModule);
 
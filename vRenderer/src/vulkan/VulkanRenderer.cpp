@@ -730,6 +730,9 @@ void VulkanRenderer::createCommandPool()
 	}
 
 	context.graphicsCommandPool = graphicsCommandPool;
+
+	// Asset uploads require the command pool, so the cache is set up once it's available
+	VkAssetCache::initialize(context);
 }
 
 void VulkanRenderer::createCommandBuffers()
@@ -774,6 +777,44 @@ void VulkanRenderer::createSyncTools()
 	}
 }
 
+/// <summary>
+/// Fills visibleModels with indices of models to draw this frame, all shown ones if culling is disabled.
+/// </summary>
+void VulkanRenderer::cullModels()
+{
+	if (!renderSettings->enableFrustumCulling || sceneCamera == nullptr)
+	{
+		visibleModels.clear();
+		for (uint32_t i = 0; i < modelsToRender.size(); i++)
+		{
+			if (modelsToRender[i]->isVisible()) visibleModels.push_back(i);
+		}
+		return;
+	}
+
+	modelBounds.resize(modelsToRender.size());
+	for (size_t i = 0; i < modelsToRender.size(); i++)
+	{
+		modelBounds[i] = modelsToRender[i]->getWorldBounds();
+	}
+	viewFrustum = sceneCamera->getFrustum();
+	FrustumCuller::cull(modelBounds.data(), modelBounds.size(), viewFrustum, visibleModels);
+	// Hidden models are neither drawn nor used as occluders
+	std::erase_if(visibleModels, [this](uint32_t i) { return !modelsToRender[i]->isVisible(); });
+
+	if (renderSettings->enableOcclusionCulling)
+	{
+		// Visible models are both the occluders and the ones tested against them
+		occlusionCuller.begin(sceneCamera->getProjectionMatrix() * sceneCamera->getViewMatrix());
+		for (uint32_t i : visibleModels)
+		{
+			modelsToRender[i]->addOccluders(occlusionCuller);
+		}
+		occlusionCuller.rasterize();
+		occlusionCuller.cull(modelBounds.data(), visibleModels);
+	}
+}
+
 void VulkanRenderer::recordCommands(uint32_t currentImage, ImDrawData& imguiDrawData)
 {
 	VkCommandBufferBeginInfo bufferBeginInfo = {};
@@ -812,19 +853,20 @@ void VulkanRenderer::recordCommands(uint32_t currentImage, ImDrawData& imguiDraw
 	// bind (static) uniforms
 	vpUniform->cmdBind(0, currentImage, commandBuffers[currentImage], mainPipeline->getLayout());
 	lightUniform->cmdBind(3, currentImage, commandBuffers[currentImage], mainPipeline->getLayout());
-	for (int i = 0; i < modelsToRender.size(); i++)
+	const Frustum* frustum = renderSettings->enableFrustumCulling ? &viewFrustum : nullptr;
+	// Dynamic color uniform holds a single value shared by all models (see MAX_OBJECTS), so it is bound once
+	colorUniformsDynamic->cmdBind(4, currentImage, 0, commandBuffers[currentImage], mainPipeline->getLayout());
+	for (uint32_t i : visibleModels)
 	{
-		// bind dynamic uniforms (unique per object)
-		colorUniformsDynamic->cmdBind(4, currentImage, i, commandBuffers[currentImage], mainPipeline->getLayout());
-		modelsToRender[i]->draw(currentImage, commandBuffers[currentImage], mainPipeline->getLayout(), true);
+		modelsToRender[i]->draw(currentImage, commandBuffers[currentImage], mainPipeline->getLayout(), true, frustum);
 	}
 
 	if (renderSettings->enableOutline)
 	{
 		outlinePipeline->cmdBind(commandBuffers[currentImage]);
-		for (int i = 0; i < modelsToRender.size(); i++)
+		for (uint32_t i : visibleModels)
 		{
-			modelsToRender[i]->draw(currentImage, commandBuffers[currentImage], mainPipeline->getLayout(), true);
+			modelsToRender[i]->draw(currentImage, commandBuffers[currentImage], mainPipeline->getLayout(), true, frustum);
 		}
 	}
 
@@ -890,12 +932,8 @@ void VulkanRenderer::updateUniforms(uint32_t imageIndex)
 	{
 		if (modelsToRender.size() > 0)
 		{
-			// This is bad and should not happen every frame. TODO: remove when I know what to do with dynamic uniforms
-			std::vector<UboDynamicColor> colorUbo(modelsToRender.size(), { glm::vec4(0.33f, 0.55f, 0.77f, 1.0f) });
-			for (int i = 0; i < modelsToRender.size(); i++)
-			{
-				colorUniformsDynamic->update(imageIndex, colorUbo.data(), modelsToRender.size());
-			}
+			UboDynamicColor colorUbo = { glm::vec4(0.33f, 0.55f, 0.77f, 1.0f) };
+			colorUniformsDynamic->update(imageIndex, &colorUbo, 1);
 		}
 	}
 
@@ -933,6 +971,7 @@ void VulkanRenderer::draw()
 	vkAcquireNextImageKHR(logicalDevice, swapchain, std::numeric_limits<InputState>::max(), semImageAvailable[currentFrame], VK_NULL_HANDLE, &imageIndex);
 
 	updateUniforms(imageIndex);
+	cullModels();
 	recordCommands(imageIndex, *imguiDrawData);
 	
 	// -- 2
@@ -974,11 +1013,9 @@ void VulkanRenderer::draw()
 	currentFrame = (currentFrame + 1) % MAX_FRAME_DRAWS;
 }
 
-bool VulkanRenderer::isModelInRenderer(uint32_t id)
+bool VulkanRenderer::isModelInRenderer(InstanceHandle handle)
 {
-	auto it = std::find_if(modelsToRender.begin(), modelsToRender.end(), 
-		[id](VkModel* model) {return model->id == id;});
-	return it != modelsToRender.end();;
+	return modelsToRender.contains(handle);
 }
 
 bool VulkanRenderer::addToRenderer(const Model& model, glm::vec3 color)
@@ -987,29 +1024,60 @@ bool VulkanRenderer::addToRenderer(const Model& model, glm::vec3 color)
 	return false;
 }
 
-bool VulkanRenderer::addToRendererTextured(const ModelInstance& model)
+/// <summary>
+/// Only the first instance of every template in the batch creates materials with their descriptor pools and uniforms,
+/// the rest share them. Instances already in renderer are skipped.
+/// </summary>
+size_t VulkanRenderer::addModelsToRenderer(std::span<const ModelInstance> models)
 {
-	// If mesh is not in renderer
-	if (!isModelInRenderer(model.id))
-	{
-		VkModel* vkModel = new VkModel(model.id, model.getTemplate(), context, samplerDescriptorCreateInfo);
-		modelsToRender.push_back(vkModel);
-
-		return true;
+	modelsToRender.reserve(modelsToRender.size() + models.size());
+	std::unordered_map<const Model*, const VkModel*> prototypes;
+	size_t addedCount = 0;
+	for (const ModelInstance& model : models)
+	{
+		if (isModelInRenderer(model.handle)) continue;
+
+		const Model& modelTemplate = model.getTemplate();
+		auto prototype = prototypes.find(&modelTemplate);
+		VkModel* vkModel = prototype != prototypes.end()
+			? new VkModel(model.id, *prototype->second)
+			: new VkModel(model.id, modelTemplate, context, samplerDescriptorCreateInfo);
+		prototypes.try_emplace(&modelTemplate, vkModel);
+
+		// Model of a deleted instance whose slot is reused before its removal was applied
+		if (auto displaced = modelsToRender.insert(model.handle, vkModel))
+		{
+			modelsToDestroy.push_back(*displaced);
+		}
+		addedCount++;
 	}
 
-	return false;
+	return addedCount;
 }
 
-bool VulkanRenderer::updateModelTransform(int modelId, glm::mat4 newTransform)
+/// <summary>
+/// Transforms are pushed as constants when recording commands, so there is nothing to upload here.
+/// </summary>
+size_t VulkanRenderer::updateModelTransforms(std::span<const InstanceHandle> handles,
+	std::span<const glm::mat4> transforms, std::span<const glm::mat4> normalMatrices)
 {
-	VkModel* model = getModel(modelId);
-	if (model != nullptr)
+	if (transforms.size() != handles.size() || normalMatrices.size() != handles.size())
 	{
-		model->setTransform(newTransform);
+		throw std::runtime_error("Model transforms don't match model handles.");
 	}
 
-	return model != nullptr;
+	size_t updatedCount = 0;
+	for (size_t i = 0; i < handles.size(); i++)
+	{
+		VkModel* model = getModel(handles[i]);
+		if (model != nullptr)
+		{
+			model->setTransform(transforms[i], normalMatrices[i]);
+			updatedCount++;
+		}
+	}
+
+	return updatedCount;
 }
 
 void VulkanRenderer::setCamera(const std::shared_ptr<BaseCamera> camera)
@@ -1047,19 +1115,40 @@ void VulkanRenderer::bindRenderSettings(const std::shared_ptr<RenderSettings> re
 	this->renderSettings = renderSettings;
 }
 
-bool VulkanRenderer::removeFromRenderer(int modelId)
+size_t VulkanRenderer::removeModelsFromRenderer(std::span<const InstanceHandle> handles)
 {
-	auto it = std::find_if(modelsToRender.begin(), modelsToRender.end(),
-		[modelId](VkModel* model) {return model->id == modelId;});
-	if (it != modelsToRender.end())
+	// Removed models are destroyed once the frames that may use them are done
+	size_t removedCount = 0;
+	for (InstanceHandle handle : handles)
 	{
-		VkModel* model = *it;
-		modelsToDestroy.push_back(model);
-		modelsToRender.erase(it);
-		return true;
+		if (auto removed = modelsToRender.erase(handle))
+		{
+			modelsToDestroy.push_back(*removed);
+			removedCount++;
+		}
 	}
 
-	return false;
+	return removedCount;
+}
+
+/// <summary>
+/// Every group of the journal is applied as one batch, every entry is a constant time handle table operation.
+/// </summary>
+void VulkanRenderer::applySceneChanges(const SceneChangeJournal& changes)
+{
+	addModelsToRenderer(changes.created);
+	updateModelTransforms(changes.transformed, changes.worldMatrices, changes.normalMatrices);
+
+	for (size_t i = 0; i < changes.visibilityChanged.size(); i++)
+	{
+		VkModel* model = getModel(changes.visibilityChanged[i]);
+		if (model != nullptr)
+		{
+			model->setVisible(changes.visible[i]);
+		}
+	}
+
+	removeModelsFromRenderer(changes.destroyed);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1348,11 +1437,10 @@ bool VulkanRenderer::checkValidationLayerSupport()
 	return true;
 }
 
-VkModel* VulkanRenderer::getModel(uint32_t id)
+VkModel* VulkanRenderer::getModel(InstanceHandle handle)
 {
-	auto it = std::find_if(modelsToRender.begin(), modelsToRender.end(),
-		[id](VkModel* model) {return model->id == id;});
-	return it != modelsToRender.end() ? *it : nullptr;
+	VkModel** model = modelsToRender.find(handle);
+	return model != nullptr ? *model : nullptr;
 }
 
 void VulkanRenderer::printPhysicalDeviceInfo(VkPhysicalDevice device, bool printPropertiesFull, bool printFeaturesFull)
@@ -0,0 +1,88 @@
+#include "Test.h"
+#include "HandleTable.h"
+#include "SceneGraph.h"
+
+using namespace VRD::Scene;
+
+TEST(HandleTable_FindsValuesByExactHandle)
+{
+	HandleTable<int> table;
+	for (uint32_t i = 0; i < 100; i++)
+	{
+		CHECK(!table.insert({ i, 1 }, static_cast<int>(i)).has_value());
+	}
+
+	CHECK(table.size() == 100);
+	for (uint32_t i = 0; i < 100; i++)
+	{
+		CHECK(table.find({ i, 1 }) != nullptr && *table.find({ i, 1 }) == static_cast<int>(i));
+		CHECK(!table.contains({ i, 0 }) && !table.contains({ i, 2 }));
+	}
+	CHECK(!table.contains({ 100, 1 }));
+	CHECK(!table.contains(InstanceHandle()));
+}
+
+TEST(HandleTable_KeepsLookupsAfterSwapRemoval)
+{
+	HandleTable<int> table;
+	for (uint32_t i = 0; i < 64; i++)
+	{
+		table.insert({ i, 0 }, static_cast<int>(i));
+	}
+	for (uint32_t i = 0; i < 64; i += 3)
+	{
+		std::optional<int> removed = table.erase({ i, 0 });
+		CHECK(removed.has_value() && *removed == static_cast<int>(i));
+		CHECK(!table.erase({ i, 0 }).has_value());
+	}
+
+	for (uint32_t i = 0; i < 64; i++)
+	{
+		const int* value = table.find({ i, 0 });
+		CHECK((i % 3 == 0) == (value == nullptr));
+		CHECK(value == nullptr || *value == static_cast<int>(i));
+	}
+	for (size_t i = 0; i < table.size(); i++)
+	{
+		CHECK(*table.find(table.getHandle(i)) == table[i]);
+	}
+}
+
+TEST(HandleTable_ReusedSlotDisplacesOlderGeneration)
+{
+	HandleTable<int> table;
+	table.insert({ 5, 0 }, 50);
+	table.insert({ 6, 0 }, 60);
+
+	// Instance in slot 5 was deleted and the slot reused before the table heard about the deletion
+	std::optional<int> displaced = table.insert({ 5, 1 }, 51);
+	CHECK(displaced.has_value() && *displaced == 50);
+	CHECK(table.size() == 2);
+	CHECK(table.find({ 5, 0 }) == nullptr);
+	CHECK(*table.find({ 5, 1 }) == 51);
+
+	// Late removal by the stale handle leaves the new value alone
+	CHECK(!table.erase({ 5, 0 }).has_value());
+	CHECK(*table.find({ 5, 1 }) == 51);
+	CHECK(*table.find({ 6, 0 }) == 60);
+}
+
+TEST(HandleTable_MirrorsSceneGraphSlotReuse)
+{
+	auto model = std::make_shared<Model>(0, "model", std::vector<std::shared_ptr<Mesh>>{}, std::vector<std::unique_ptr<Material>>{}, 0);
+	SceneGraph scene;
+	HandleTable<uint32_t> table;
+
+	InstanceHandle first = scene.addInstance(model);
+	uint32_t firstId = scene.getId(first);
+	table.insert(first, firstId);
+	scene.deleteInstance(first);
+
+	InstanceHandle second = scene.addInstance(model);
+	CHECK(second.index == first.index && second.generation != first.generation);
+	CHECK(!scene.isValid(first) && scene.isValid(second));
+
+	std::optional<uint32_t> displaced = table.insert(second, scene.getId(second));
+	CHECK(displaced.has_value() && *displaced == firstId);
+	CHECK(!table.contains(first) && table.contains(second));
+}
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "Test.h"
+#include "Lz4.h"
+
+#include <random>
+
+namespace
+{
+	std::vector<uint8_t> compress(const std::vector<uint8_t>& data)
+	{
+		std::vector<uint8_t> compressed(Lz4::compressBound(data.size()));
+		size_t size = Lz4::compress(data.data(), data.size(), compressed.data(), compressed.size());
+		CHECK(size > 0 && size <= compressed.size());
+		compressed.resize(size);
+		return compressed;
+	}
+
+	bool roundTrips(const std::vector<uint8_t>& data)
+	{
+		std::vector<uint8_t> compressed = compress(data);
+		std::vector<uint8_t> decompressed(data.size());
+		return Lz4::decompress(compressed.data(), compressed.size(), decompressed.data(), decompressed.size()) && decompressed == data;
+	}
+
+	std::vector<uint8_t> randomBytes(std::mt19937& rng, size_t size)
+	{
+		std::vector<uint8_t> data(size);
+		for (uint8_t& b : data)
+		{
+			b = static_cast<uint8_t>(rng());
+		}
+		return data;
+	}
+}
+
+TEST(Lz4_RoundTripsSmallBlocks)
+{
+	std::mt19937 rng(1);
+	for (size_t size = 0; size <= 64; size++)
+	{
+		CHECK(roundTrips(randomBytes(rng, size)));
+		CHECK(roundTrips(std::vector<uint8_t>(size, 'a')));
+	}
+}
+
+TEST(Lz4_RoundTripsIncompressibleData)
+{
+	std::mt19937 rng(2);
+	std::vector<uint8_t> data = randomBytes(rng, 1 << 20);
+	CHECK(roundTrips(data));
+	CHECK(compress(data).size() <= Lz4::compressBound(data.size()));
+}
+
+TEST(Lz4_RoundTripsCompressibleData)
+{
+	std::mt19937 rng(3);
+
+	// long runs exercise the 255-byte length continuation for both literals and matches
+	std::vector<uint8_t> runs;
+	for (int i = 0; i < 200; i++)
+	{
+		runs.insert(runs.end(), rng() % 2000, static_cast<uint8_t>(rng()));
+		std::vector<uint8_t> literals = randomBytes(rng, rng() % 600);
+		runs.insert(runs.end(), literals.begin(), literals.end());
+	}
+	CHECK(roundTrips(runs));
+
+	// repeated phrases with offsets both inside and beyond the 64KB match window
+	std::vector<uint8_t> dictionary = randomBytes(rng, 1 << 17);
+	std::vector<uint8_t> phrases;
+	for (int i = 0; i < 4000; i++)
+	{
+		size_t start = rng() % (dictionary.size() - 256);
+		size_t length = 4 + rng() % 250;
+		phrases.insert(phrases.end(), dictionary.begin() + start, dictionary.begin() + start + length);
+	}
+	std::vector<uint8_t> compressed = compress(phrases);
+	CHECK(compressed.size() < phrases.size());
+	CHECK(roundTrips(phrases));
+
+	// overlapping match (offset smaller than match length)
+	std::vector<uint8_t> pattern;
+	for (int i = 0; i < 10000; i++)
+	{
+		pattern.push_back(static_cast<uint8_t>("abc"[i % 3]));
+	}
+	CHECK(compress(pattern).size() < 100);
+	CHECK(roundTrips(pattern));
+}
+
+TEST(Lz4_RejectsMalformedInput)
+{
+	std::mt19937 rng(4);
+	std::vector<uint8_t> data(4096);
+	for (size_t i = 0; i < data.size(); i++)
+	{
+		data[i] = static_cast<uint8_t>(i % 97 < 50 ? i % 13 : rng());
+	}
+	std::vector<uint8_t> compressed = compress(data);
+	std::vector<uint8_t> out(data.size() + 1);
+
+	// wrong decompressed size
+	CHECK(!Lz4::decompress(compressed.data(), compressed.size(), out.data(), data.size() - 1));
+	CHECK(!Lz4::decompress(compressed.data(), compressed.size(), out.data(), data.size() + 1));
+
+	// every truncation is rejected
+	for (size_t size = 0; size < compressed.size(); size++)
+	{
+		CHECK(!Lz4::decompress(compressed.data(), size, out.data(), data.size()));
+	}
+
+	// corrupted bytes may decode to garbage but never write outside the output buffer
+	for (int i = 0; i < 2000; i++)
+	{
+		std::vector<uint8_t> corrupted = compressed;
+		corrupted[rng() % corrupted.size()] = static_cast<uint8_t>(rng());
+		std::vector<uint8_t> exact(data.size());
+		Lz4::decompress(corrupted.data(), corrupted.size(), exact.data(), exact.size());
+	}
+	for (int i = 0; i < 2000; i++)
+	{
+		std::vector<uint8_t> garbage = randomBytes(rng, rng() % 64);
+		std::vector<uint8_t> exact(rng() % 256);
+		Lz4::decompress(garbage.data(), garbage.size(), exact.data(), exact.size());
+	}
+}
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "Test.h"
+#include "MpscTaskQueue.h"
+
+#include <atomic>
+#include <thread>
+#include <string>
+
+TEST(MpscTaskQueue_KeepsOrderOfEachProducerThroughOverflow)
+{
+	// Small ring, so producers keep switching between ring and overflow
+	MpscTaskQueue queue(64);
+	const int producerCount = 4;
+	const int tasksPerProducer = 20000;
+
+	std::vector<int> lastTask(producerCount, -1);
+	std::atomic<int> outOfOrder = 0;
+	int64_t total = 0;
+	std::atomic<int> finishedProducers = 0;
+	std::vector<std::thread> producers;
+	for (int p = 0; p < producerCount; p++)
+	{
+		producers.emplace_back([&, p]() {
+			for (int i = 0; i < tasksPerProducer; i++)
+			{
+				auto check = [&lastTask, &outOfOrder, p, i]() {
+					outOfOrder += lastTask[p] != i - 1;
+					lastTask[p] = i;
+				};
+				if (i % 3 == 0)
+				{
+					// Capture larger than the inline buffer takes the heap path
+					std::string payload(64, 'x');
+					queue.push([check, payload, &total]() { check(); total += payload.size() == 64; });
+				}
+				else
+				{
+					queue.push([check, &total]() { check(); total++; });
+				}
+			}
+			finishedProducers++;
+		});
+	}
+
+	while (finishedProducers < producerCount || total < producerCount * tasksPerProducer)
+	{
+		queue.process();
+	}
+	for (std::thread& producer : producers)
+	{
+		producer.join();
+	}
+	queue.process();
+
+	CHECK(total == producerCount * tasksPerProducer);
+	CHECK(outOfOrder == 0);
+}
+
+TEST(MpscTaskQueue_TasksPushedWhileProcessingWaitForNextCall)
+{
+	MpscTaskQueue queue(16);
+	int counter = 0;
+	queue.push([&]() {
+		counter++;
+		queue.push([&]() { counter += 10; });
+	});
+
+	CHECK(queue.process() == 1);
+	CHECK(counter == 1);
+	CHECK(queue.process() == 1);
+	CHECK(counter == 11);
+	CHECK(queue.process() == 0);
+}
+
+TEST(MpscTaskQueue_TasksPushedFromRingWhileOverflowIsActiveWaitForNextCall)
+{
+	MpscTaskQueue queue(4);
+	int nested = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		queue.push([&]() { queue.push([&]() { nested++; }); });
+	}
+	// Ring is full, so this one activates overflow
+	queue.push([]() {});
+
+	queue.process();
+	CHECK(nested == 0);
+	for (int i = 0; i < 4; i++)
+	{
+		queue.process();
+	}
+	CHECK(nested == 4);
+}
+
+TEST(MpscTaskQueue_DeadlineLeavesTasksForLaterCalls)
+{
+	MpscTaskQueue queue(8);
+	int counter = 0;
+	for (int i = 0; i < 100; i++)
+	{
+		queue.push([&counter, i]() { counter += counter == i; });
+	}
+	CHECK(queue.process(MpscTaskQueue::Clock::now() - std::chrono::seconds(1)) == 0);
+	CHECK(queue.getStats().pendingCount == 100);
+	CHECK(queue.getStats().starvedCallCount == 1);
+
+	// Ring is run first, overflow is taken by the next call once the ring is empty
+	size_t processed = 0;
+	for (int call = 0; call < 10 && processed < 100; call++)
+	{
+		processed += queue.process();
+	}
+	CHECK(processed == 100);
+	CHECK(counter == 100);
+	CHECK(queue.getStats().overflowPushCount == 92);
+	CHECK(queue.getStats().pendingCount == 0);
+}
+
+TEST(MpscTaskQueue_PassedDeadlineStillRunsMinimumTaskCount)
+{
+	MpscTaskQueue queue(4);
+	int counter = 0;
+	for (int i = 0; i < 10; i++)
+	{
+		queue.push([&counter, i]() { counter += counter == i; });
+	}
+	MpscTaskQueue::Clock::time_point passed = MpscTaskQueue::Clock::now() - std::chrono::seconds(1);
+
+	// Ring, then overflow once the ring is empty, one task per call
+	for (int call = 0; call < 10; call++)
+	{
+		CHECK(queue.process(passed, 1) == 1);
+		CHECK(queue.getStats().pendingCount == static_cast<size_t>(9 - call));
+	}
+	CHECK(counter == 10);
+	CHECK(queue.getStats().starvedCallCount == 10);
+
+	// Empty queue isn't starved, and a call within the deadline isn't either
+	CHECK(queue.process(passed, 1) == 0);
+	queue.push([&counter]() { counter++; });
+	CHECK(queue.process(MpscTaskQueue::Clock::now() + std::chrono::seconds(10), 1) == 1);
+	CHECK(queue.getStats().starvedCallCount == 10);
+	CHECK(counter == 11);
+}
\ No newline at end of file
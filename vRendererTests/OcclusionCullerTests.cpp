@@ -0,0 +1,225 @@
+#include "Test.h"
+#include "OcclusionCuller.h"
+#include "geometry_settings.h"
+
+#include <random>
+#include <memory>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+/*
+	Every sphere reported occluded is checked against ray cast ground truth: rays from the eye to points
+	on the sphere surface must all hit an occluder triangle before reaching the point.
+*/
+class OcclusionScene
+{
+public:
+
+	const glm::vec3 eye = glm::vec3(0.0f, 0.0f, 10.0f);
+	glm::mat4 viewProjection;
+	OcclusionCuller culler;
+	std::mt19937 random{ 7 };
+	std::uniform_real_distribution<float> unit{ -1.0f, 1.0f };
+
+	OcclusionScene()
+	{
+		glm::mat4 projection = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+		viewProjection = projection * glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	}
+
+	// Mesh takes indices shifted by VERTEX_INDEX_OFFSET, as imported
+	std::shared_ptr<Mesh> addMesh(const std::vector<glm::vec3>& vertices, std::vector<uint32_t> indices, const glm::mat4& transform = glm::mat4(1.0f))
+	{
+		for (uint32_t& index : indices)
+		{
+			worldTriangles.push_back(glm::vec3(transform * glm::vec4(vertices[index], 1.0f)));
+			index += VERTEX_INDEX_OFFSET;
+		}
+		auto mesh = std::make_shared<Mesh>(static_cast<int>(meshes.size()), "occluder", vertices, indices, std::vector<glm::vec2>{}, std::vector<glm::vec3>{});
+		meshes.push_back(mesh);
+		transforms.push_back(transform);
+		return mesh;
+	}
+
+	void rasterize()
+	{
+		culler.begin(viewProjection);
+		for (size_t i = 0; i < meshes.size(); i++)
+		{
+			const BoundingSphere& sphere = meshes[i]->getBoundingSphere();
+			float scale = std::max({ glm::length(glm::vec3(transforms[i][0])), glm::length(glm::vec3(transforms[i][1])), glm::length(glm::vec3(transforms[i][2])) });
+			culler.addOccluder(*meshes[i], transforms[i], glm::vec4(glm::vec3(transforms[i] * glm::vec4(sphere.center, 1.0f)), sphere.radius * scale));
+		}
+		culler.rasterize();
+	}
+
+	void clear()
+	{
+		meshes.clear();
+		transforms.clear();
+		worldTriangles.clear();
+	}
+
+	// True if some point on the sphere within the view is seen from the eye
+	bool isVisible(const glm::vec4& sphere)
+	{
+		for (int i = 0; i < 256; i++)
+		{
+			glm::vec3 point = glm::vec3(sphere) + glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(1e-4f)) * sphere.w;
+			glm::vec4 clip = viewProjection * glm::vec4(point, 1.0f);
+			if (clip.w <= 0.0f || std::abs(clip.x) > clip.w || std::abs(clip.y) > clip.w) continue;
+
+			float distance = glm::length(point - eye);
+			if (!isBlocked((point - eye) / distance, distance)) return true;
+		}
+		return false;
+	}
+
+	// Spheres the culler reports occluded although they are seen
+	size_t countFalselyOccluded(const std::vector<glm::vec4>& spheres, size_t& occluded)
+	{
+		size_t falselyOccluded = 0;
+		for (const glm::vec4& sphere : spheres)
+		{
+			if (!culler.isOccluded(sphere)) continue;
+			occluded++;
+			falselyOccluded += isVisible(sphere);
+		}
+		return falselyOccluded;
+	}
+
+private:
+
+	std::vector<std::shared_ptr<Mesh>> meshes;
+	std::vector<glm::mat4> transforms;
+	std::vector<glm::vec3> worldTriangles;
+
+	bool isBlocked(const glm::vec3& direction, float distance) const
+	{
+		for (size_t t = 0; t + 2 < worldTriangles.size(); t += 3)
+		{
+			// Moller-Trumbore
+			glm::vec3 edge1 = worldTriangles[t + 1] - worldTriangles[t];
+			glm::vec3 edge2 = worldTriangles[t + 2] - worldTriangles[t];
+			glm::vec3 p = glm::cross(direction, edge2);
+			float determinant = glm::dot(edge1, p);
+			if (std::abs(determinant) < 1e-12f) continue;
+
+			glm::vec3 s = eye - worldTriangles[t];
+			float u = glm::dot(s, p) / determinant;
+			if (u < 0.0f || u > 1.0f) continue;
+			glm::vec3 q = glm::cross(s, edge1);
+			float v = glm::dot(direction, q) / determinant;
+			if (v < 0.0f || u + v > 1.0f) continue;
+			float hit = glm::dot(edge2, q) / determinant;
+			if (hit > 0.0f && hit < distance) return true;
+		}
+		return false;
+	}
+};
+
+static const std::vector<uint32_t> c_quadIndices = { 0, 1, 2, 0, 2, 3 };
+
+TEST(OcclusionCuller_WallHidesWhatIsBehindIt)
+{
+	OcclusionScene scene;
+	scene.addMesh({ { -5, -5, 0 }, { 5, -5, 0 }, { 5, 5, 0 }, { -5, 5, 0 } }, c_quadIndices);
+	scene.rasterize();
+
+	CHECK(scene.culler.getOccluderCount() == 1);
+	CHECK(scene.culler.isOccluded(glm::vec4(0, 0, -5, 1)));
+	CHECK(!scene.culler.isOccluded(glm::vec4(0, 0, 5, 1)));
+	CHECK(!scene.culler.isOccluded(glm::vec4(30, 0, -5, 1)));
+	CHECK(!scene.culler.isOccluded(glm::vec4(0, 0, -5, 20)));
+	CHECK(!scene.culler.isOccluded(glm::vec4(0, 0, 11, 2)));
+}
+
+TEST(OcclusionCuller_SubpixelGapKeepsObjectVisible)
+{
+	// Gap is about a quarter of a pixel of the depth buffer, centered on a pixel boundary
+	OcclusionScene scene;
+	scene.addMesh({ { -5, -5, 0 }, { -0.015f, -5, 0 }, { -0.015f, 5, 0 }, { -5, 5, 0 } }, c_quadIndices);
+	scene.addMesh({ { 0.015f, -5, 0 }, { 5, -5, 0 }, { 5, 5, 0 }, { 0.015f, 5, 0 } }, c_quadIndices);
+	scene.rasterize();
+
+	glm::vec4 behindGap(0, 0, -5, 0.005f);
+	CHECK(scene.isVisible(behindGap));
+	CHECK(!scene.culler.isOccluded(behindGap));
+	CHECK(scene.culler.isOccluded(glm::vec4(-2.5f, 0, -5, 0.5f)));
+}
+
+TEST(OcclusionCuller_BoxSilhouettesAreConservative)
+{
+	// Vertices are split per face like imported meshes with texture seams
+	std::vector<glm::vec3> vertices;
+	std::vector<uint32_t> indices;
+	for (int face = 0; face < 6; face++)
+	{
+		int axis = face / 2;
+		glm::vec3 normal(0.0f), tangent(0.0f);
+		normal[axis] = face % 2 ? 1.0f : -1.0f;
+		tangent[(axis + 1) % 3] = 1.0f;
+		glm::vec3 bitangent = glm::cross(normal, tangent);
+		uint32_t base = static_cast<uint32_t>(vertices.size());
+		vertices.insert(vertices.end(), { normal - tangent - bitangent, normal + tangent - bitangent, normal + tangent + bitangent, normal - tangent + bitangent });
+		indices.insert(indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+	}
+
+	OcclusionScene scene;
+	size_t occluded = 0;
+	size_t falselyOccluded = 0;
+	for (int i = 0; i < 20; i++)
+	{
+		glm::vec3 axis = glm::normalize(glm::vec3(scene.unit(scene.random), scene.unit(scene.random), scene.unit(scene.random)) + glm::vec3(0.01f));
+		glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(scene.unit(scene.random) * 3, scene.unit(scene.random) * 2, scene.unit(scene.random) * 3)) *
+			glm::rotate(glm::mat4(1.0f), scene.unit(scene.random) * 3.0f, axis) * glm::scale(glm::mat4(1.0f), glm::vec3(2.0f + scene.unit(scene.random)));
+		scene.clear();
+		scene.addMesh(vertices, indices, transform);
+		scene.rasterize();
+
+		std::vector<glm::vec4> spheres;
+		for (int s = 0; s < 500; s++)
+		{
+			spheres.emplace_back(scene.unit(scene.random) * 6, scene.unit(scene.random) * 4, scene.unit(scene.random) * 6 - 6, 0.003f + std::abs(scene.unit(scene.random)) * 0.05f);
+		}
+		falselyOccluded += scene.countFalselyOccluded(spheres, occluded);
+	}
+	CHECK(occluded > 0);
+	CHECK(falselyOccluded == 0);
+}
+
+TEST(OcclusionCuller_RandomTrianglesAreConservative)
+{
+	OcclusionScene scene;
+	size_t occluded = 0;
+	size_t falselyOccluded = 0;
+	for (int i = 0; i < 10; i++)
+	{
+		scene.clear();
+		for (int m = 0; m < 6; m++)
+		{
+			std::vector<glm::vec3> vertices;
+			std::vector<uint32_t> indices;
+			for (int t = 0; t < 20; t++)
+			{
+				glm::vec3 center(scene.unit(scene.random) * 8, scene.unit(scene.random) * 5, scene.unit(scene.random) * 8);
+				for (int v = 0; v < 3; v++)
+				{
+					indices.push_back(static_cast<uint32_t>(vertices.size()));
+					vertices.push_back(center + glm::vec3(scene.unit(scene.random), scene.unit(scene.random), scene.unit(scene.random)) * 4.0f);
+				}
+			}
+			scene.addMesh(vertices, indices);
+		}
+		scene.rasterize();
+
+		std::vector<glm::vec4> spheres;
+		for (int s = 0; s < 300; s++)
+		{
+			spheres.emplace_back(scene.unit(scene.random) * 10, scene.unit(scene.random) * 6, scene.unit(scene.random) * 10 - 5, 0.05f + std::abs(scene.unit(scene.random)));
+		}
+		falselyOccluded += scene.countFalselyOccluded(spheres, occluded);
+	}
+	CHECK(occluded > 0);
+	CHECK(falselyOccluded == 0);
+}
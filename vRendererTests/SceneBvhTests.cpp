@@ -0,0 +1,178 @@
+#include "Test.h"
+#include "SceneBvh.h"
+
+#include <random>
+#include <algorithm>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+using namespace VRD::Scene;
+
+/*
+	Scene of unit cubes with random transforms, every query is compared against a brute force loop
+	over the world boxes of all instances. Models without meshes have empty boxes and are never found.
+*/
+class BvhScene
+{
+public:
+
+	SceneGraph scene;
+	std::vector<InstanceHandle> handles;
+	std::mt19937 random{ 5 };
+	std::uniform_real_distribution<float> coordinate{ -500.0f, 500.0f };
+
+	explicit BvhScene(size_t count)
+	{
+		std::vector<std::shared_ptr<Mesh>> meshes{ std::make_shared<Mesh>(0, "cube",
+			std::vector<glm::vec3>{ glm::vec3(-0.5f), glm::vec3(0.5f) }, std::vector<uint32_t>{}, std::vector<glm::vec2>{}, std::vector<glm::vec3>{}) };
+		cube = std::make_shared<Model>(0, "cube", std::move(meshes), std::vector<std::unique_ptr<Material>>{}, 0);
+		empty = std::make_shared<Model>(1, "empty", std::vector<std::shared_ptr<Mesh>>{}, std::vector<std::unique_ptr<Material>>{}, 0);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			handles.push_back(scene.addInstance(i % 97 == 5 ? empty : cube));
+			moveRandomly(handles.back());
+		}
+		scene.updateTransforms();
+	}
+
+	void moveRandomly(InstanceHandle handle)
+	{
+		std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+		std::uniform_real_distribution<float> scale(0.5f, 4.0f);
+		scene.setTransform(handle, randomPoint(), glm::vec3(angle(random), angle(random), angle(random)), glm::vec3(scale(random)));
+	}
+
+	glm::vec3 randomPoint()
+	{
+		return glm::vec3(coordinate(random), coordinate(random), coordinate(random));
+	}
+
+	std::vector<BoundingBox> getWorldBoxes() const
+	{
+		std::vector<BoundingBox> boxes;
+		for (InstanceHandle handle : handles)
+		{
+			boxes.push_back(SceneBvh::transformBox(scene.getModel(handle)->getBoundingBox(), scene.getWorldMatrix(handle)));
+		}
+		return boxes;
+	}
+
+private:
+
+	std::shared_ptr<Model> cube;
+	std::shared_ptr<Model> empty;
+};
+
+static bool overlaps(const BoundingBox& a, const BoundingBox& b)
+{
+	return !a.isEmpty() && glm::all(glm::lessThanEqual(a.min, b.max)) && glm::all(glm::greaterThanEqual(a.max, b.min));
+}
+
+static float squaredDistance(const BoundingBox& box, const glm::vec3& point)
+{
+	glm::vec3 outside = glm::max(glm::max(box.min - point, point - box.max), glm::vec3(0.0f));
+	return glm::dot(outside, outside);
+}
+
+// Entry distance of the ray into the box, FLT_MAX if it misses
+static float rayDistance(const BoundingBox& box, const Ray& ray)
+{
+	if (box.isEmpty()) return FLT_MAX;
+	glm::vec3 inverse = 1.0f / ray.direction;
+	glm::vec3 t1 = (box.min - ray.origin) * inverse;
+	glm::vec3 t2 = (box.max - ray.origin) * inverse;
+	float entry = std::max({ std::min(t1.x, t2.x), std::min(t1.y, t2.y), std::min(t1.z, t2.z), 0.0f });
+	float exit = std::min({ std::max(t1.x, t2.x), std::max(t1.y, t2.y), std::max(t1.z, t2.z) });
+	return entry <= exit ? entry : FLT_MAX;
+}
+
+static void checkQueries(BvhScene& scene, const SceneBvh& bvh)
+{
+	std::vector<BoundingBox> boxes = scene.getWorldBoxes();
+	CHECK(bvh.getInstanceCount() == boxes.size());
+
+	for (int i = 0; i < 100; i++)
+	{
+		Ray ray{ scene.randomPoint(), glm::normalize(scene.randomPoint()) };
+		float expected = FLT_MAX;
+		for (const BoundingBox& box : boxes)
+		{
+			expected = std::min(expected, rayDistance(box, ray));
+		}
+
+		SceneBvh::RayHit hit;
+		CHECK(bvh.raycast(ray, hit) == (expected != FLT_MAX));
+		CHECK(expected == FLT_MAX || std::abs(hit.distance - expected) < 1e-3f);
+	}
+
+	for (int i = 0; i < 50; i++)
+	{
+		glm::vec3 center = scene.randomPoint();
+		BoundingBox query;
+		query.expand(center - glm::vec3(40.0f));
+		query.expand(center + glm::vec3(40.0f));
+		std::vector<InstanceHandle> found;
+		bvh.queryBox(query, found);
+		CHECK(found.size() == static_cast<size_t>(std::count_if(boxes.begin(), boxes.end(), [&](const BoundingBox& box) { return overlaps(box, query); })));
+		for (InstanceHandle handle : found)
+		{
+			CHECK(overlaps(boxes[scene.scene.getDenseIndex(handle)], query));
+		}
+
+		float nearest = FLT_MAX;
+		for (const BoundingBox& box : boxes)
+		{
+			if (!box.isEmpty()) nearest = std::min(nearest, squaredDistance(box, center));
+		}
+		InstanceHandle nearestHandle = bvh.findNearest(center);
+		CHECK(nearestHandle.isValid() == (nearest != FLT_MAX));
+		CHECK(!nearestHandle.isValid() || std::abs(squaredDistance(boxes[scene.scene.getDenseIndex(nearestHandle)], center) - nearest) < 1e-2f);
+	}
+
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.5f, 0.1f, 300.0f);
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(1.0f, 0.2f, 0.3f), glm::vec3(0.0f, 1.0f, 0.0f));
+	Frustum frustum = Frustum::fromViewProjection(projection * view);
+	size_t expected = 0;
+	for (const BoundingBox& box : boxes)
+	{
+		bool inside = !box.isEmpty();
+		for (int p = 0; p < 6 && inside; p++)
+		{
+			const glm::vec4& plane = frustum.planes[p];
+			glm::vec3 corner(plane.x >= 0.0f ? box.max.x : box.min.x, plane.y >= 0.0f ? box.max.y : box.min.y, plane.z >= 0.0f ? box.max.z : box.min.z);
+			inside = glm::dot(glm::vec3(plane), corner) + plane.w >= 0.0f;
+		}
+		expected += inside;
+	}
+	std::vector<InstanceHandle> visible;
+	bvh.queryFrustum(frustum, visible);
+	CHECK(visible.size() == expected);
+}
+
+TEST(SceneBvh_QueriesMatchBruteForce)
+{
+	for (size_t count : { 0, 1, 3, 7, 100, 5000 })
+	{
+		BvhScene scene(count);
+		SceneBvh bvh;
+		bvh.build(scene.scene);
+		checkQueries(scene, bvh);
+	}
+}
+
+TEST(SceneBvh_RefitMatchesBruteForce)
+{
+	BvhScene scene(5000);
+	SceneBvh bvh;
+	bvh.build(scene.scene);
+
+	for (size_t i = 0; i < scene.handles.size(); i += 3)
+	{
+		scene.moveRandomly(scene.handles[i]);
+	}
+	std::vector<InstanceHandle> updated;
+	scene.scene.updateTransforms(&updated);
+	bvh.refit(scene.scene, updated);
+	checkQueries(scene, bvh);
+}
\ No newline at end of file
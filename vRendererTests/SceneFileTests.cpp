@@ -0,0 +1,183 @@
+#include "Test.h"
+#include "SceneFile.h"
+
+#include <random>
+#include <fstream>
+#include <filesystem>
+
+using namespace VRD::Scene;
+
+// Hierarchy with deleted, hidden and parented instances, lights and camera
+static SceneData createScene(std::vector<std::shared_ptr<Model>>& models)
+{
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		models.push_back(std::make_shared<Model>(i, "model" + std::to_string(i), std::vector<std::shared_ptr<Mesh>>{}, std::vector<std::unique_ptr<Material>>{}, 0));
+	}
+
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> value(-100.0f, 100.0f);
+	SceneGraph scene;
+	std::vector<InstanceHandle> handles;
+	for (int i = 0; i < 2000; i++)
+	{
+		handles.push_back(scene.addInstance(models[i % models.size()], glm::vec3(value(random), value(random), value(random)),
+			glm::vec3(value(random)), glm::vec3(1.0f + i % 3)));
+	}
+	for (size_t i = 0; i < handles.size(); i += 7)
+	{
+		scene.deleteInstance(handles[i]);
+	}
+	for (size_t i = 1; i + 1 < handles.size(); i += 5)
+	{
+		if (scene.isValid(handles[i]) && scene.isValid(handles[i + 1])) scene.setParent(handles[i + 1], handles[i]);
+	}
+	for (size_t i = 2; i < handles.size(); i += 11)
+	{
+		if (scene.isValid(handles[i])) scene.setVisible(handles[i], false);
+	}
+
+	SceneData data;
+	data.captureInstances(scene);
+	Light light(3, Light::SPOT);
+	light.color = glm::vec3(0.5f, 0.2f, 0.1f);
+	data.lights.push_back(SceneLight::fromLight(light));
+	data.camera.type = CameraType::FPV;
+	data.camera.fov = 55;
+	data.camera.position = glm::vec3(1.0f, 2.0f, 3.0f);
+	data.skyboxName = "skybox";
+	return data;
+}
+
+static void checkEqual(const SceneData& loaded, const SceneData& saved)
+{
+	CHECK(loaded.modelNames == saved.modelNames);
+	CHECK(loaded.skyboxName == saved.skyboxName);
+	CHECK(loaded.instanceModels == saved.instanceModels);
+	CHECK(loaded.instanceParents == saved.instanceParents);
+	CHECK(loaded.positions == saved.positions);
+	CHECK(loaded.rotations == saved.rotations);
+	CHECK(loaded.scales == saved.scales);
+	CHECK(loaded.instanceFlags == saved.instanceFlags);
+
+	CHECK(loaded.lights.size() == saved.lights.size());
+	CHECK(loaded.lights[0].type == Light::SPOT && loaded.lights[0].color == saved.lights[0].color);
+	CHECK(loaded.camera.type == saved.camera.type && loaded.camera.fov == saved.camera.fov);
+	CHECK(loaded.camera.position == saved.camera.position && loaded.camera.target == saved.camera.target);
+}
+
+TEST(SceneFile_RoundTripsInMemory)
+{
+	std::vector<std::shared_ptr<Model>> models;
+	SceneData scene = createScene(models);
+	CHECK(scene.getInstanceCount() > 0);
+
+	std::vector<uint8_t> bytes = SceneFile::serialize(scene);
+	checkEqual(SceneFile::deserialize(bytes.data(), bytes.size()), scene);
+}
+
+TEST(SceneFile_RoundTripsThroughFile)
+{
+	std::vector<std::shared_ptr<Model>> models;
+	SceneData scene = createScene(models);
+
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "vRendererTests.vrds";
+	for (AssetBundle::Compression compression : { AssetBundle::Compression::NONE, AssetBundle::Compression::LZ4 })
+	{
+		SceneFile::save(path, scene, compression);
+		checkEqual(SceneFile::load(path), scene);
+	}
+	std::filesystem::remove(path);
+}
+
+TEST(SceneFile_RejectsMalformedData)
+{
+	std::vector<std::shared_ptr<Model>> models;
+	SceneData scene = createScene(models);
+
+	std::vector<uint8_t> bytes = SceneFile::serialize(scene);
+	bool threw = false;
+	try
+	{
+		SceneFile::deserialize(bytes.data(), bytes.size() - 3);
+	}
+	catch (const std::runtime_error&)
+	{
+		threw = true;
+	}
+	CHECK(threw);
+
+	scene.instanceParents[0] = static_cast<uint32_t>(scene.getInstanceCount());
+	bytes = SceneFile::serialize(scene);
+	threw = false;
+	try
+	{
+		SceneFile::deserialize(bytes.data(), bytes.size());
+	}
+	catch (const std::runtime_error&)
+	{
+		threw = true;
+	}
+	CHECK(threw);
+}
+
+TEST(SceneFile_RejectsUnknownLightAndCameraTypes)
+{
+	std::vector<std::shared_ptr<Model>> models;
+	SceneData scene = createScene(models);
+
+	auto rejects = [](const SceneData& scene) {
+		std::vector<uint8_t> bytes = SceneFile::serialize(scene);
+		try
+		{
+			SceneFile::deserialize(bytes.data(), bytes.size());
+		}
+		catch (const std::runtime_error&)
+		{
+			return true;
+		}
+		return false;
+	};
+
+	SceneData badLight = scene;
+	badLight.lights[0].type = Light::SPOT + 1;
+	CHECK(rejects(badLight));
+
+	SceneData badCamera = scene;
+	badCamera.camera.type = CameraType::FPV + 1;
+	CHECK(rejects(badCamera));
+}
+
+TEST(SceneFile_RejectsPayloadSizeBeyondCompressionRatio)
+{
+	std::vector<std::shared_ptr<Model>> models;
+	SceneData scene = createScene(models);
+
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "vRendererTests.vrds";
+	for (AssetBundle::Compression compression : { AssetBundle::Compression::NONE, AssetBundle::Compression::LZ4 })
+	{
+		SceneFile::save(path, scene, compression);
+
+		// Size no payload of this length can decompress to, which would otherwise be allocated up front
+		SceneFile::Header header;
+		{
+			std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+			file.read(reinterpret_cast<char*>(&header), sizeof(header));
+			header.size = UINT64_MAX / 2;
+			file.seekp(0);
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		}
+
+		bool threw = false;
+		try
+		{
+			SceneFile::load(path);
+		}
+		catch (const std::runtime_error&)
+		{
+			threw = true;
+		}
+		CHECK(threw);
+	}
+	std::filesystem::remove(path);
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+
+/*
+	Minimal test registry for the CPU side of the renderer.
+	TEST(name) defines and registers a test function, CHECK(condition) fails the running test with the condition text.
+	Tests run in the order of registration within a file, files in the order of linking.
+*/
+
+namespace VRD::Test
+{
+	struct TestFailure : std::runtime_error
+	{
+		TestFailure(const char* condition, const char* file, int line)
+			: std::runtime_error(std::string(file) + "(" + std::to_string(line) + "): CHECK(" + condition + ") failed") {}
+	};
+
+	struct TestCase
+	{
+		const char* name;
+		void (*function)();
+	};
+
+	inline std::vector<TestCase>& getTests()
+	{
+		static std::vector<TestCase> tests;
+		return tests;
+	}
+
+	struct TestRegistration
+	{
+		TestRegistration(const char* name, void (*function)()) { getTests().push_back({ name, function }); }
+	};
+}
+
+#define TEST(name) \
+	static void name(); \
+	static VRD::Test::TestRegistration name##_registration(#name, name); \
+	static void name()
+
+#define CHECK(condition) \
+	do { if (!(condition)) throw VRD::Test::TestFailure(#condition, __FILE__, __LINE__); } while (false)
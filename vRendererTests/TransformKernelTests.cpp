@@ -0,0 +1,111 @@
+#include "Test.h"
+#include "TransformKernel.h"
+
+#include <random>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+using namespace VRD::Scene;
+
+static bool nearlyEqual(const glm::mat4& a, const glm::mat4& b, float tolerance)
+{
+	for (int column = 0; column < 4; column++)
+	{
+		for (int row = 0; row < 4; row++)
+		{
+			if (std::abs(a[column][row] - b[column][row]) > tolerance * std::max(1.0f, std::abs(b[column][row]))) return false;
+		}
+	}
+	return true;
+}
+
+// Reference composition with glm, rotation applied as Z * Y * X
+static glm::mat4 composeReference(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale)
+{
+	glm::mat4 m = glm::translate(glm::mat4(1.0f), position);
+	m = glm::rotate(m, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+	m = glm::rotate(m, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+	m = glm::rotate(m, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+	return glm::scale(m, scale);
+}
+
+struct TransformInputs
+{
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> rotations;
+	std::vector<glm::vec3> scales;
+	// Every other instance, in reverse, so batches have a tail and indices aren't contiguous
+	std::vector<uint32_t> indices;
+
+	explicit TransformInputs(size_t count)
+	{
+		std::mt19937 random(3);
+		std::uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+		std::uniform_real_distribution<float> angle(-720.0f, 720.0f);
+		std::uniform_real_distribution<float> scale(0.05f, 20.0f);
+		for (size_t i = 0; i < count; i++)
+		{
+			positions.emplace_back(position(random), position(random), position(random));
+			rotations.emplace_back(angle(random), angle(random), angle(random));
+			scales.emplace_back(scale(random), scale(random), scale(random));
+		}
+		for (size_t i = count; i-- > 0;)
+		{
+			if (i % 2 == 0) indices.push_back(static_cast<uint32_t>(i));
+		}
+	}
+};
+
+TEST(TransformKernel_ComposeMatchesGlm)
+{
+	TransformInputs inputs(1003);
+	std::vector<glm::mat4> locals(inputs.positions.size(), glm::mat4(0.0f));
+	TransformKernel::composeLocal(inputs.positions.data(), inputs.rotations.data(), inputs.scales.data(),
+		inputs.indices.data(), inputs.indices.size(), locals.data());
+
+	for (size_t i = 0; i < locals.size(); i++)
+	{
+		glm::mat4 expected = composeReference(inputs.positions[i], inputs.rotations[i], inputs.scales[i]);
+		if (i % 2 == 0)
+		{
+			CHECK(nearlyEqual(locals[i], expected, 1e-4f));
+			CHECK(nearlyEqual(TransformKernel::compose(inputs.positions[i], inputs.rotations[i], inputs.scales[i]), expected, 1e-4f));
+		}
+		else
+		{
+			// Instances not in the batch are left untouched
+			CHECK(locals[i] == glm::mat4(0.0f));
+		}
+	}
+}
+
+TEST(TransformKernel_NormalsMatchInverseTranspose)
+{
+	TransformInputs inputs(1003);
+	std::vector<glm::mat4> worlds(inputs.positions.size());
+	for (size_t i = 0; i < worlds.size(); i++)
+	{
+		worlds[i] = composeReference(inputs.positions[i], inputs.rotations[i], inputs.scales[i]);
+	}
+	std::vector<glm::mat4> normals(worlds.size(), glm::mat4(0.0f));
+	TransformKernel::computeNormals(worlds.data(), inputs.indices.data(), inputs.indices.size(), normals.data());
+
+	for (uint32_t i : inputs.indices)
+	{
+		glm::mat4 expected = glm::mat4(glm::transpose(glm::inverse(glm::mat3(worlds[i]))));
+		CHECK(nearlyEqual(normals[i], expected, 1e-3f));
+		CHECK(nearlyEqual(TransformKernel::normalMatrix(worlds[i]), expected, 1e-3f));
+	}
+}
+
+TEST(TransformKernel_MultiplyMatchesGlm)
+{
+	TransformInputs inputs(64);
+	for (size_t i = 0; i + 1 < inputs.positions.size(); i++)
+	{
+		glm::mat4 a = composeReference(inputs.positions[i], inputs.rotations[i], inputs.scales[i]);
+		glm::mat4 b = composeReference(inputs.positions[i + 1], inputs.rotations[i + 1], inputs.scales[i + 1]);
+		CHECK(nearlyEqual(TransformKernel::multiply(a, b), a * b, 1e-4f));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "Test.h"
+#include "WorkStealingPool.h"
+
+#include <atomic>
+#include <thread>
+#include <string>
+
+static void spawnTree(WorkStealingPool& pool, std::atomic<int64_t>& counter, int depth)
+{
+	counter++;
+	if (depth == 0) return;
+	pool.submit([&pool, &counter, depth]() { spawnTree(pool, counter, depth - 1); });
+	pool.submit([&pool, &counter, depth]() { spawnTree(pool, counter, depth - 1); });
+}
+
+TEST(WorkStealingPool_RunsNestedTasksExactlyOnce)
+{
+	for (int round = 0; round < 10; round++)
+	{
+		std::atomic<int64_t> counter = 0;
+		{
+			WorkStealingPool pool(4);
+			for (int i = 0; i < 1000; i++)
+			{
+				// Capture larger than the inline buffer takes the heap path
+				std::string payload(100, 'x');
+				pool.submit([&counter, payload]() { counter += payload.size() == 100; });
+			}
+			pool.submit([&pool, &counter]() { spawnTree(pool, counter, 12); });
+		}
+		// Destructor runs all remaining tasks
+		CHECK(counter == 1000 + (1 << 13) - 1);
+	}
+}
+
+TEST(WorkStealingPool_ExternalSubmittersOverflowWithoutRunningTasks)
+{
+	const uint32_t threadCount = 2;
+	const int producerCount = 4;
+	// Far more than the injection ring holds while all workers are blocked
+	const int tasksPerProducer = 5000;
+
+	std::atomic<bool> release = false;
+	std::atomic<int64_t> counter = 0;
+	std::atomic<int64_t> ranOutsidePool = 0;
+	{
+		WorkStealingPool pool(threadCount);
+		for (uint32_t i = 0; i < threadCount; i++)
+		{
+			pool.submit([&release]() { while (!release.load()) std::this_thread::yield(); });
+		}
+
+		std::vector<std::thread> producers;
+		for (int p = 0; p < producerCount; p++)
+		{
+			producers.emplace_back([&]() {
+				for (int i = 0; i < tasksPerProducer; i++)
+				{
+					pool.submit([&]() {
+						counter++;
+						ranOutsidePool += pool.getCurrentWorkerIndex() < 0;
+					});
+				}
+			});
+		}
+		// Producers have to finish while workers are still blocked, submitting never waits for them
+		for (std::thread& producer : producers)
+		{
+			producer.join();
+		}
+		CHECK(counter == 0);
+		release = true;
+	}
+	CHECK(counter == producerCount * tasksPerProducer);
+	CHECK(ranOutsidePool == 0);
+}
+
+TEST(WorkStealingPool_HelpingThreadRunsPendingTasks)
+{
+	std::atomic<bool> started = false;
+	std::atomic<bool> release = false;
+	std::atomic<int> counter = 0;
+	WorkStealingPool pool(1);
+	pool.submit([&started, &release]() {
+		started = true;
+		while (!release.load()) std::this_thread::yield();
+	});
+	while (!started.load())
+	{
+		std::this_thread::yield();
+	}
+	for (int i = 0; i < 100; i++)
+	{
+		pool.submit([&counter]() { counter++; });
+	}
+
+	// Only worker is blocked, so everything but the blocking task is run here
+	while (counter < 100)
+	{
+		pool.tryRunPendingTask();
+	}
+	CHECK(!pool.tryRunPendingTask());
+	release = true;
+}
+
+TEST(WorkStealingPool_SurvivesThrowingTasks)
+{
+	std::atomic<int> counter = 0;
+	{
+		WorkStealingPool pool(2);
+		for (int i = 0; i < 100; i++)
+		{
+			pool.submit([]() { throw std::runtime_error("task failure expected by the test"); });
+			pool.submit([&counter]() { counter++; });
+		}
+	}
+	CHECK(counter == 100);
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#include <cstdio>
+#include <exception>
+
+#include "Test.h"
+#include "ThreadDispatcher.h"
+
+// Runs every registered test, exit code is the number of failed tests
+int main()
+{
+	ThreadDispatcher::initialize();
+
+	int failed = 0;
+	for (const VRD::Test::TestCase& test : VRD::Test::getTests())
+	{
+		try
+		{
+			test.function();
+			printf("[ OK ] %s\n", test.name);
+		}
+		catch (const std::exception& e)
+		{
+			printf("[FAIL] %s\n       %s\n", test.name, e.what());
+			failed++;
+		}
+	}
+	printf("%zu tests, %d failed\n", VRD::Test::getTests().size(), failed);
+
+	ThreadDispatcher::destroy();
+	return failed;
+}
\ No newline at end of file